@@ -29,6 +29,70 @@
  *  image retrieval from a file, conversion and saving with desired file format is
  *  covered as well.
  *
+ *  Images are grabbed through an image event handler on every camera rather
+ *  than by polling the cameras in turn. Each handler copies its camera's
+ *  frame into a slot of the camera's bounded writer queue and posts a
+ *  completion to one queue shared by all cameras, which the acquisition loop
+ *  waits on; a late or slower camera never holds up the others, whatever
+ *  their frame rates. Each camera has its own writer thread, so a slow write
+ *  only ever stalls its own camera. The queue high-water mark, the time a
+ *  camera waited on a full queue and the time spent writing are reported for
+ *  every camera.
+ *
+ *  Each camera's frames are written to a recording (see FrameRecording.h)
+ *  in which every frame has a header with its FrameID, timestamp, size, pixel
+ *  format and image status, followed by an index of all frames. Frames are
+ *  retrieved through the index, and the recording can be searched by
+ *  timestamp without reading any image data.
+ *
+ *  With --direct, recordings bypass the page cache: they are written with
+ *  O_DIRECT from 4 KiB aligned staging buffers into files preallocated with
+ *  fallocate (see DirectFileWriter.h), which keeps write latency steady at
+ *  sustained multi-camera data rates. --benchmark-writes compares both ways of
+ *  writing without any cameras; run with --help for its options.
+ *
+ *  Recordings can be spread over several directories, one per drive, given
+ *  with --dest. Either each camera records to one of the directories, or the
+ *  frames of every camera are striped in blocks over all of them, so the
+ *  write bandwidth adds up across drives. Directories are picked round-robin
+ *  or by measured bandwidth, and a manifest (recording.manifest, in the first
+ *  directory) lists the pieces so they are read back as one recording.
+ *
+ *  For continuous recording, --rotate-mb and --rotate-seconds cut every piece
+ *  into rolling segments. A background thread opens each writer's next
+ *  segment ahead of time and closes finished ones, so a rotation is just a
+ *  pointer swap on the writer thread, and image events never touch a file.
+ *  With --retain-mb the same thread deletes the oldest closed segments to
+ *  keep the recording within a disk budget.
+ *
+ *  With --compress, 8-bit Mono and Bayer frames are compressed losslessly on
+ *  the writer threads before they reach the disk (see FrameCodec.h), which
+ *  cuts the disk bandwidth for cameras without on-board compression. The
+ *  compression ratio and time are reported per camera, and
+ *  --benchmark-codec PATH measures the codec on the frames of a recording.
+ *
+ *  Recordings can be read while they are written: the frame count in each
+ *  file header is published as frames are written, and --follow PATH, run
+ *  in another process, prints the frames of a recording as they arrive,
+ *  reading them in place through a mapping of the file (see
+ *  RecordingTailReader.h).
+ *
+ *  Cameras are initialized and configured all at once, one thread per camera,
+ *  since each setting is a round trip to the camera and with many cameras
+ *  these add up to most of the startup time. How long each step took on
+ *  each camera is printed, along with when each camera delivered its first
+ *  image; --serial-config configures them one at a time for comparison.
+ *
+ *  Retrieval exports the frames of all cameras in parallel: the recordings
+ *  are cut into blocks of consecutive frames, and every worker thread reads
+ *  a whole block with one read into a buffer it keeps reusing, then saves
+ *  its frames. Output names depend only on the camera and the frame's
+ *  position in the recording, however the work is spread.
+ *
+ *  What the acquisition, writer and export threads print goes through an
+ *  asynchronous log (see AsyncLog.h), so no thread ever waits on another
+ *  one or on the console to print a message about a frame.
+ *
  *  Please leave us feedback at: https://www.surveymonkey.com/r/TDYMVAPI
  *  More source code examples at: https://github.com/Teledyne-MV/Spinnaker-Examples
  *  Need help? Check out our forum at: https://teledynevisionsolutions.zendesk.com/hc/en-us/community/topics
@@ -36,12 +100,30 @@
 
 #include "Spinnaker.h"
 #include "SpinGenApi/SpinnakerGenApi.h"
+#include "AsyncLog.h"
+#include "FrameRecording.h"
+#include "RecordingTailReader.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <map>
 #include <assert.h>
 
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace Spinnaker;
 using namespace Spinnaker::GenApi;
 using namespace Spinnaker::GenICam;
@@ -54,18 +136,263 @@ const string kDestinationDirectory = "";
 // Number of images to grab
 const unsigned int k_numImages = 30;
 
+// Number of images to grab from each camera; set with --images
+unsigned int numImages = k_numImages;
+
+// Number of frames that can wait in each camera's writer queue
+const unsigned int k_writerQueueFrames = 16;
+
+// How long an idle writer thread sleeps before checking its queue again
+const unsigned int k_writerIdleSleepUs = 200;
+
+// How long a camera may go without delivering an image before acquisition
+// gives up on it
+const unsigned int k_grabTimeoutMs = 1000;
+
+// Compress frames on the writer threads before recording them; set with
+// --compress
+bool compressFrames = false;
+
+// Passes over the frames in each measurement of --benchmark-codec
+const unsigned int k_codecBenchmarkPasses = 5;
+
+// Most frames of a recording loaded by --benchmark-codec
+const size_t k_codecBenchmarkFrames = 100;
+
+// How long --follow waits for the recording to be created
+const unsigned int k_followOpenSeconds = 30;
+
+// How long --follow sleeps when no new frame has been published
+const unsigned int k_followPollMs = 5;
+
+// Configure the cameras one at a time rather than all at once; set with
+// --serial-config
+bool serialConfiguration = false;
+
+// How the recordings are written; set with --direct
+RecordingBackend recordingBackend = RECORDING_BACKEND_STREAM;
+
+// What is spread over the destination directories
+enum StripeMode
+{
+    STRIPE_CAMERAS, // each camera records to one directory
+    STRIPE_FRAMES   // blocks of frames of each camera go to all directories
+};
+
+// How the destination directory of a camera or a block is picked
+enum StripePolicy
+{
+    STRIPE_ROUND_ROBIN,
+    STRIPE_BANDWIDTH // the directory with the most measured bandwidth to spare
+};
+
+// Number of consecutive frames of a camera that go to the same directory
+const unsigned int k_stripeFrames = 8;
+
+// Data written to each directory to measure its bandwidth before recording
+// with --stripe cameras --stripe-policy bandwidth
+const unsigned int k_bandwidthProbeFrames = 16;
+const size_t k_bandwidthProbeFrameSize = 4 * 1024 * 1024;
+
+// Directories the recordings go to (--dest); kDestinationDirectory if none
+vector<string> destinationDirectories;
+StripeMode stripeMode = STRIPE_CAMERAS;
+StripePolicy stripePolicy = STRIPE_ROUND_ROBIN;
+unsigned int stripeFrames = k_stripeFrames;
+
+// Pieces of the recording of every camera, planned before the files are created
+RecordingManifest recordingManifest;
+
+// Segment rotation and retention (--rotate-mb, --rotate-seconds, --retain-mb);
+// zero turns each of them off
+uint64_t rotateBytes = 0;
+double rotateSeconds = 0.0;
+uint64_t retainBytes = 0;
+
+// Number of threads exporting images; set with --export-threads, 0 uses one
+// per processor
+unsigned int exportThreads = 0;
+
+// Largest run of consecutive frame records read with one read when exporting
+const uint64_t k_exportBlockBytes = 32 * 1024 * 1024;
+
+bool RotationEnabled()
+{
+    return rotateBytes > 0 || rotateSeconds > 0.0;
+}
+
+// Defaults of the recording backend benchmark: one writer per simulated
+// camera, each writing 5 MB frames
+const unsigned int k_benchmarkWriters = 4;
+const unsigned int k_benchmarkFrames = 100;
+const size_t k_benchmarkWidth = 2448;
+const size_t k_benchmarkHeight = 2048;
+
+//
+// Bounded lock-free queue of frame buffers between one camera's image event
+// handler and its writer thread
+//
+// *** NOTES ***
+// There is exactly one producer (the event handler) and one consumer (the writer
+// thread), so the queue needs no locks: the producer only advances the tail
+// and the consumer only advances the head. The slot buffers are allocated
+// once and reused, so queueing a frame costs a single copy.
+//
+class FrameQueue
+{
+  public:
+    struct Slot
+    {
+        vector<char> data;
+        RecordedFrame frame;
+    };
+
+    explicit FrameQueue(size_t capacity) : m_slots(capacity), m_head(0), m_tail(0), m_highWaterMark(0)
+    {
+    }
+
+    // Allocate every slot up front so the event handler never allocates
+    void reserve(size_t frameSize)
+    {
+        for (size_t i = 0; i < m_slots.size(); i++)
+        {
+            m_slots[i].data.reserve(frameSize);
+        }
+    }
+
+    // Producer: the next free slot, or NULL if the queue is full
+    Slot* beginPush()
+    {
+        const size_t tail = m_tail.load(memory_order_relaxed);
+        if (tail - m_head.load(memory_order_acquire) == m_slots.size())
+        {
+            return NULL;
+        }
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    // Producer: hand the slot returned by beginPush() to the consumer
+    void endPush()
+    {
+        const size_t tail = m_tail.load(memory_order_relaxed) + 1;
+        m_tail.store(tail, memory_order_release);
+        m_highWaterMark = max(m_highWaterMark, tail - m_head.load(memory_order_acquire));
+    }
+
+    // Consumer: the oldest queued slot, or NULL if the queue is empty
+    Slot* front()
+    {
+        const size_t head = m_head.load(memory_order_relaxed);
+        if (head == m_tail.load(memory_order_acquire))
+        {
+            return NULL;
+        }
+        return &m_slots[head % m_slots.size()];
+    }
+
+    // Consumer: give the slot returned by front() back to the producer
+    void pop()
+    {
+        m_head.store(m_head.load(memory_order_relaxed) + 1, memory_order_release);
+    }
+
+    size_t capacity() const
+    {
+        return m_slots.size();
+    }
+
+    // Most frames ever queued at once; only valid once the producer is done
+    size_t highWaterMark() const
+    {
+        return m_highWaterMark;
+    }
+
+  private:
+    vector<Slot> m_slots;
+    atomic<size_t> m_head;
+    atomic<size_t> m_tail;
+    size_t m_highWaterMark;
+};
+
+// Writer thread of one piece of a camera's recording, its queue and its
+// counters; a camera has one writer per piece
+struct FrameWriter
+{
+    unsigned int cameraCnt;
+    string path;
+    std::shared_ptr<RecordingWriter> recording;
+    FrameQueue queue;
+    std::thread thread;
+
+    // Set when no more frames will be queued
+    atomic<bool> done;
+
+    // Set by the writer thread when a write fails
+    atomic<bool> failed;
+
+    // Updated by the camera's event handler
+    uint64_t framesQueued;
+    uint64_t bytesQueued;
+    double grabStallSeconds;
+
+    // Updated by the writer thread; read once it has been joined
+    uint64_t framesWritten;
+    double writeSeconds;
+    double maxWriteSeconds;
+
+    // Compression done by the writer thread; read once it has been joined
+    vector<uint8_t> encoded;
+    uint64_t imageBytes;
+    uint64_t storedBytes;
+    double compressSeconds;
+
+    // Updated by the writer thread and read by the event handler to measure the
+    // bandwidth of the piece's directory
+    atomic<uint64_t> bytesWritten;
+    atomic<uint64_t> busyNanoseconds;
+
+    // Segment being written, owned by the writer thread; path is the name of
+    // the piece without a segment number
+    unsigned int segmentIndex;
+    string segmentPath;
+    uint64_t segmentBytes;
+    chrono::steady_clock::time_point segmentStart;
+    unsigned int rotations;
+    double rotationWaitSeconds;
+
+    // Next segment, opened ahead by the segment manager
+    std::mutex segmentMutex;
+    std::condition_variable segmentReady;
+    std::shared_ptr<RecordingWriter> nextRecording;
+    string nextPath;
+    bool nextFailed;
+
+    FrameWriter(unsigned int camera, const string& piecePath)
+        : cameraCnt(camera), path(piecePath), recording(std::make_shared<RecordingWriter>()),
+          queue(k_writerQueueFrames), done(false), failed(false), framesQueued(0), bytesQueued(0),
+          grabStallSeconds(0.0), framesWritten(0), writeSeconds(0.0), maxWriteSeconds(0.0), imageBytes(0),
+          storedBytes(0), compressSeconds(0.0), bytesWritten(0),
+          busyNanoseconds(0), segmentIndex(0), segmentPath(piecePath), segmentBytes(0), rotations(0),
+          rotationWaitSeconds(0.0), nextFailed(false)
+    {
+    }
+};
+
 // This struct defines image information for each unique device
 // An ImageInfo struct is created for each device detected
 struct ImageInfo
 {
-    size_t imageWidth;
-    size_t imageHeight;
     PixelFormatEnums pixelFormat;
-    string imageFileName;
-    std::shared_ptr<fstream> imageFile;
+    bool chunkTimestamp;
+    vector<std::shared_ptr<FrameWriter>> writers;
 
-    ImageInfo(string filename)
-        : imageWidth(0), imageHeight(0), pixelFormat(UNKNOWN_PIXELFORMAT), imageFileName(filename)
+    // Piece the current block of frames goes to, and how far into the block
+    // the camera is
+    size_t currentPiece;
+    unsigned int framesInBlock;
+    uint64_t blocks;
+
+    ImageInfo() : pixelFormat(UNKNOWN_PIXELFORMAT), chunkTimestamp(false), currentPiece(0), framesInBlock(0), blocks(0)
     {
     }
 };
@@ -73,32 +400,286 @@ struct ImageInfo
 // This vector stores all the ImageInfo for all cameras
 vector<ImageInfo> imageInfos;
 
-// Create files to save each of the camera images
+// Path of the manifest; it lives in the first destination directory
+string ManifestPath()
+{
+    return (destinationDirectories.empty() ? kDestinationDirectory : destinationDirectories[0]) +
+           RECORDING_MANIFEST_NAME;
+}
+
+// Name of a segment of a piece: camera0.tmp becomes camera0.seg000003.tmp
+string SegmentPath(const string& piecePath, unsigned int segmentIndex)
+{
+    string stem = piecePath;
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".tmp") == 0)
+    {
+        stem.erase(stem.size() - 4);
+    }
+
+    stringstream sstream;
+    sstream << stem << ".seg" << setw(6) << setfill('0') << segmentIndex << ".tmp";
+    return sstream.str();
+}
+
+//
+// Background thread that opens, closes and deletes segments
+//
+// *** NOTES ***
+// Writer threads only hand work to the manager: when a writer rotates it
+// takes the segment the manager opened for it ahead of time and passes the
+// finished one back. The manager then closes it (which writes its index),
+// opens the writer's next segment, rewrites the manifest and, with a disk
+// budget, deletes the oldest closed segments until the closed ones fit in
+// the budget. Segments still being written come on top of the budget.
+//
+class SegmentManager
+{
+  public:
+    SegmentManager() : m_stop(false), m_manifestDirty(false), m_failed(false), m_closedBytes(0), m_deleted(0)
+    {
+    }
+
+    void start()
+    {
+        m_stop = false;
+        m_thread = std::thread(&SegmentManager::run, this);
+    }
+
+    // Open the given segment of a writer in the background
+    void prepare(FrameWriter* writer, unsigned int segmentIndex)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_toOpen.push_back(make_pair(writer, segmentIndex));
+            if (find(m_writers.begin(), m_writers.end(), writer) == m_writers.end())
+            {
+                m_writers.push_back(writer);
+            }
+        }
+        m_wake.notify_one();
+    }
+
+    // A writer moved on to its next segment: close the previous one, add the
+    // new one to the manifest and open the one after
+    void rotated(FrameWriter* writer, std::shared_ptr<RecordingWriter> previous, const string& previousPath)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_toClose.push_back(Segment(writer->cameraCnt, previousPath, previous));
+            recordingManifest.pieces.at(writer->cameraCnt).push_back(writer->segmentPath);
+            m_manifestDirty = true;
+            m_toOpen.push_back(make_pair(writer, writer->segmentIndex + 1));
+        }
+        m_wake.notify_one();
+    }
+
+    // Finish the pending work once the writer threads are done, then delete
+    // the segments that were opened ahead but never used
+    bool stop()
+    {
+        if (!m_thread.joinable())
+        {
+            return true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_toOpen.clear();
+        }
+        m_wake.notify_one();
+        m_thread.join();
+
+        for (size_t i = 0; i < m_writers.size(); i++)
+        {
+            std::lock_guard<std::mutex> lock(m_writers[i]->segmentMutex);
+            if (m_writers[i]->nextRecording)
+            {
+                m_writers[i]->nextRecording->close();
+                m_writers[i]->nextRecording.reset();
+                remove(m_writers[i]->nextPath.c_str());
+            }
+        }
+        m_writers.clear();
+
+        return !m_failed;
+    }
+
+    uint64_t deletedSegments() const
+    {
+        return m_deleted;
+    }
+
+  private:
+    struct Segment
+    {
+        unsigned int cameraCnt;
+        string path;
+        std::shared_ptr<RecordingWriter> recording;
+        uint64_t bytes;
+
+        Segment(unsigned int camera, const string& segmentPath, std::shared_ptr<RecordingWriter> segment)
+            : cameraCnt(camera), path(segmentPath), recording(segment), bytes(0)
+        {
+        }
+    };
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            if (!m_toClose.empty())
+            {
+                Segment segment = m_toClose.front();
+                m_toClose.pop_front();
+
+                lock.unlock();
+                if (!segment.recording->close())
+                {
+                    ASYNC_LOG(ASYNC_LOG_ERROR, "Error closing segment " << segment.path);
+                    m_failed = true;
+                }
+                segment.bytes = segment.recording->fileSize();
+                segment.recording.reset();
+                lock.lock();
+
+                m_closed.push_back(segment);
+                m_closedBytes += segment.bytes;
+                enforceBudget(lock);
+            }
+            else if (!m_toOpen.empty())
+            {
+                FrameWriter* writer = m_toOpen.front().first;
+                const string path = SegmentPath(writer->path, m_toOpen.front().second);
+                m_toOpen.pop_front();
+
+                lock.unlock();
+                std::shared_ptr<RecordingWriter> next = std::make_shared<RecordingWriter>();
+                const bool opened = next->open(path, recordingBackend);
+                {
+                    std::lock_guard<std::mutex> segmentLock(writer->segmentMutex);
+                    writer->nextRecording = opened ? next : std::shared_ptr<RecordingWriter>();
+                    writer->nextPath = path;
+                    writer->nextFailed = !opened;
+                }
+                writer->segmentReady.notify_one();
+                lock.lock();
+            }
+            else if (m_manifestDirty)
+            {
+                m_manifestDirty = false;
+                if (!recordingManifest.write(ManifestPath()))
+                {
+                    ASYNC_LOG(ASYNC_LOG_ERROR, "Failed to write " << ManifestPath());
+                }
+            }
+            else if (m_stop)
+            {
+                break;
+            }
+            else
+            {
+                m_wake.wait(lock);
+            }
+        }
+    }
+
+    // Delete the oldest closed segments until the closed ones fit in the
+    // budget. Called with the lock held; files are removed without it.
+    void enforceBudget(std::unique_lock<std::mutex>& lock)
+    {
+        vector<string> victims;
+        while (retainBytes > 0 && m_closedBytes > retainBytes && !m_closed.empty())
+        {
+            const Segment& oldest = m_closed.front();
+
+            vector<string>& pieces = recordingManifest.pieces.at(oldest.cameraCnt);
+            pieces.erase(std::remove(pieces.begin(), pieces.end(), oldest.path), pieces.end());
+
+            victims.push_back(oldest.path);
+            m_closedBytes -= oldest.bytes;
+            m_closed.pop_front();
+            m_deleted++;
+        }
+
+        if (victims.empty())
+        {
+            return;
+        }
+
+        // Drop the segments from the manifest before their files go away
+        recordingManifest.write(ManifestPath());
+
+        lock.unlock();
+        for (size_t i = 0; i < victims.size(); i++)
+        {
+            remove(victims[i].c_str());
+        }
+        lock.lock();
+    }
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    deque<pair<FrameWriter*, unsigned int>> m_toOpen;
+    deque<Segment> m_toClose;
+    deque<Segment> m_closed;
+    vector<FrameWriter*> m_writers;
+    bool m_stop;
+    bool m_manifestDirty;
+    atomic<bool> m_failed;
+    uint64_t m_closedBytes;
+    uint64_t m_deleted;
+};
+
+SegmentManager segmentManager;
+
+// Create files to save each of the camera images, as planned in the manifest.
+// With rotation, each file is the first segment of its piece.
 bool CreateFiles(unsigned int numCameras)
 {
     bool result = true;
     for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
     {
-        stringstream sstream;
-        string tmpFilename;
+        imageInfos.push_back(ImageInfo());
 
-        sstream << kDestinationDirectory << "camera" << cameraCnt << ".tmp";
-        sstream >> tmpFilename;
+        vector<string>& pieces = recordingManifest.pieces.at(cameraCnt);
+        for (size_t piece = 0; piece < pieces.size(); piece++)
+        {
+            // Create temporary files
+            std::shared_ptr<FrameWriter> writer = std::make_shared<FrameWriter>(cameraCnt, pieces[piece]);
+            imageInfos.at(cameraCnt).writers.push_back(writer);
 
-        imageInfos.push_back(ImageInfo(tmpFilename));
+            if (RotationEnabled())
+            {
+                writer->segmentPath = SegmentPath(pieces[piece], 0);
+                pieces[piece] = writer->segmentPath;
+            }
 
-        cout << "Creating " << tmpFilename << "..." << endl;
+            const string& tmpFilename = writer->segmentPath;
 
-        // Create temporary files
-        imageInfos.at(cameraCnt).imageFile = std::make_shared<fstream>(
-            tmpFilename.c_str(), fstream::trunc | fstream::in | fstream::out | fstream::binary);
+            cout << "Creating " << tmpFilename << "..." << endl;
 
-        if (!imageInfos.at(cameraCnt).imageFile)
-        {
-            assert(false);
-            result = false;
+            if (!writer->recording->open(tmpFilename, recordingBackend))
+            {
+                assert(false);
+                result = false;
+            }
+            else if (recordingBackend == RECORDING_BACKEND_DIRECT && !writer->recording->isDirect())
+            {
+                cout << "O_DIRECT is not supported for " << tmpFilename << ", writing through the page cache" << endl;
+            }
         }
     }
+
+    // The manifest ties the pieces of each camera back together
+    if (result && !recordingManifest.write(ManifestPath()))
+    {
+        cout << "Failed to write " << ManifestPath() << endl;
+        result = false;
+    }
     return result;
 }
 
@@ -149,277 +730,1954 @@ int PrintDeviceInfo(INodeMap& nodeMap)
     return result;
 }
 
-// This function configure each of the cameras including the acquisition mode
-bool ConfigureCameras(CameraList& camList, unsigned int numCameras)
+// This function enables the timestamp chunk so that each frame header carries
+// the timestamp latched by the camera; please see ChunkData example for more
+// in-depth comments on chunk data. Returns false if the camera does not
+// support it, in which case the image timestamp is recorded instead.
+bool EnableChunkTimestamp(INodeMap& nodeMap)
 {
-    bool result = true;
+    CBooleanPtr ptrChunkModeActive = nodeMap.GetNode("ChunkModeActive");
+    CEnumerationPtr ptrChunkSelector = nodeMap.GetNode("ChunkSelector");
+    if (!IsWritable(ptrChunkModeActive) || !IsWritable(ptrChunkSelector))
+    {
+        return false;
+    }
 
-    cout << endl << endl << "*** CONFIGURING CAMERAS... ***" << endl << endl;
+    ptrChunkModeActive->SetValue(true);
+
+    CEnumEntryPtr ptrChunkSelectorTimestamp = ptrChunkSelector->GetEntryByName("Timestamp");
+    if (!IsReadable(ptrChunkSelectorTimestamp))
+    {
+        return false;
+    }
+
+    ptrChunkSelector->SetIntValue(ptrChunkSelectorTimestamp->GetValue());
+
+    CBooleanPtr ptrChunkEnable = nodeMap.GetNode("ChunkEnable");
+    if (!IsReadable(ptrChunkEnable))
+    {
+        return false;
+    }
+
+    if (!ptrChunkEnable->GetValue())
+    {
+        if (!IsWritable(ptrChunkEnable))
+        {
+            return false;
+        }
+        ptrChunkEnable->SetValue(true);
+    }
+
+    return true;
+}
+
+// How long each step of bringing up one camera took, and what it reported
+struct CameraStartup
+{
+    double initSeconds;
+    double acquisitionModeSeconds;
+    double pixelFormatSeconds;
+    double chunkSeconds;
+    double totalSeconds;
+    bool result;
+
+    // Printed once all cameras are configured, so messages do not interleave
+    string messages;
+
+    CameraStartup()
+        : initSeconds(0.0), acquisitionModeSeconds(0.0), pixelFormatSeconds(0.0), chunkSeconds(0.0),
+          totalSeconds(0.0), result(false)
+    {
+    }
+};
+
+// Seconds since start; restarts start for the next step
+double StepSeconds(chrono::steady_clock::time_point& start)
+{
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    const double seconds = chrono::duration<double>(now - start).count();
+    start = now;
+    return seconds;
+}
+
+// This function initializes one camera and configures it, including the
+// acquisition mode. It runs on its own thread for each camera, so it only
+// touches that camera and its own ImageInfo.
+void ConfigureCamera(CameraPtr pCam, unsigned int cameraCnt, CameraStartup& startup)
+{
+    ostringstream messages;
+
+    const chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    chrono::steady_clock::time_point start = begin;
+
+    try
+    {
+        pCam->Init();
+        startup.initSeconds = StepSeconds(start);
+
+        // Get the camera node Map
+        INodeMap& nodeMap = pCam->GetNodeMap();
+
+        // Set acquisition mode to continuous
+        CEnumerationPtr ptrAcquisitionMode = nodeMap.GetNode("AcquisitionMode");
+        if (!IsReadable(ptrAcquisitionMode))
+        {
+            messages << "Unable to get acquisition mode to continuous (node retrieval). Aborting..." << endl << endl;
+            startup.messages = messages.str();
+            return;
+        }
+
+        CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
+        if (!IsReadable(ptrAcquisitionModeContinuous))
+        {
+            messages << "Unable to set acquisition mode to continuous (entry 'continuous' retrieval). Aborting..."
+                     << endl
+                     << endl;
+            startup.messages = messages.str();
+            return;
+        }
+
+        int64_t acquisitionModeContinuous = ptrAcquisitionModeContinuous->GetValue();
+
+        if (!IsWritable(ptrAcquisitionMode))
+        {
+            messages << "Unable to set acquisition mode to continuous (node retrieval). Aborting..." << endl << endl;
+            startup.messages = messages.str();
+            return;
+        }
+
+        ptrAcquisitionMode->SetIntValue(acquisitionModeContinuous);
+        startup.acquisitionModeSeconds = StepSeconds(start);
+
+        messages << "Camera[" << cameraCnt << "]: Acquisition mode set to continuous..." << endl;
+
+        CEnumerationPtr ptrPixelFormat = nodeMap.GetNode("PixelFormat");
+
+        if (!IsWritable(ptrPixelFormat))
+        {
+            messages << "Unable to set Pixel Format mode (node retrieval). Aborting..." << endl << endl;
+            startup.messages = messages.str();
+            return;
+        }
+
+        CEnumEntryPtr ptrPixelFormatBayerRG8 = ptrPixelFormat->GetEntryByName("BayerRG8");
+        CEnumEntryPtr ptrMono8 = ptrPixelFormat->GetEntryByName("Mono8");
+
+        if (IsReadable(ptrPixelFormatBayerRG8))
+        {
+            ptrPixelFormat->SetIntValue(ptrPixelFormatBayerRG8->GetValue());
+
+            // Keep the track of the pixel Format
+            imageInfos.at(cameraCnt).pixelFormat = PixelFormatEnums::PixelFormat_BayerRG8;
+            messages << "Camera[" << cameraCnt
+                     << "]: Pixel format set to: " << ptrPixelFormat->GetCurrentEntry()->GetName() << endl;
+        }
+        else if (IsReadable(ptrMono8))
+        {
+            ptrPixelFormat->SetIntValue(ptrMono8->GetValue());
+
+            // Keep the track of the pixel Format
+            imageInfos.at(cameraCnt).pixelFormat = PixelFormatEnums::PixelFormat_Mono8;
+
+            messages << "Camera[" << cameraCnt << "]: Pixel format set to "
+                     << ptrPixelFormat->GetCurrentEntry()->GetName() << endl;
+        }
+        else
+        {
+            messages << "Unable to set pixel format (enum entry retrieval). Aborting..." << endl << endl;
+            startup.messages = messages.str();
+            return;
+        }
+        startup.pixelFormatSeconds = StepSeconds(start);
+
+        // Record the camera's own timestamp for each frame when possible
+        imageInfos.at(cameraCnt).chunkTimestamp = EnableChunkTimestamp(nodeMap);
+        startup.chunkSeconds = StepSeconds(start);
+
+        messages << "Camera[" << cameraCnt << "]: Recording "
+                 << (imageInfos.at(cameraCnt).chunkTimestamp ? "chunk" : "image") << " timestamps" << endl;
+
+        startup.result = true;
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        messages << "Error: " << e.what() << endl;
+    }
+
+    startup.totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    startup.messages = messages.str();
+}
+
+//
+// This function initializes and configures all of the cameras
+//
+// *** NOTES ***
+// Every setting is a round trip to the camera, and with many cameras, GigE
+// ones especially, doing them camera after camera adds up to most of the
+// startup time. Each camera is brought up on its own thread instead, so
+// startup takes about as long as the slowest camera. The time each step took
+// is printed per camera to show which step and which camera to look at.
+//
+bool ConfigureCameras(CameraList& camList, unsigned int numCameras)
+{
+    bool result = true;
+
+    cout << endl << endl << "*** CONFIGURING CAMERAS... ***" << endl << endl;
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    vector<CameraStartup> startups(numCameras);
+    if (serialConfiguration)
+    {
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            ConfigureCamera(camList.GetByIndex(cameraCnt), cameraCnt, startups[cameraCnt]);
+        }
+    }
+    else
+    {
+        vector<std::thread> threads;
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            threads.push_back(
+                std::thread(ConfigureCamera, camList.GetByIndex(cameraCnt), cameraCnt, std::ref(startups[cameraCnt])));
+        }
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            threads[cameraCnt].join();
+        }
+    }
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double cameraSeconds = 0.0;
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        cout << startups[cameraCnt].messages;
+        cameraSeconds += startups[cameraCnt].totalSeconds;
+        result = result && startups[cameraCnt].result;
+    }
+
+    cout << endl << "*** CAMERA STARTUP TIMES (ms) ***" << endl << endl;
+    cout << fixed << setprecision(1);
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        const CameraStartup& startup = startups[cameraCnt];
+        cout << "Camera[" << cameraCnt << "]: init " << startup.initSeconds * 1000.0 << ", acquisition mode "
+             << startup.acquisitionModeSeconds * 1000.0 << ", pixel format " << startup.pixelFormatSeconds * 1000.0
+             << ", chunk data " << startup.chunkSeconds * 1000.0 << ", total " << startup.totalSeconds * 1000.0
+             << endl;
+    }
+    cout << "Configured " << numCameras << " cameras " << (serialConfiguration ? "one at a time" : "in parallel")
+         << " in " << seconds * 1000.0 << " ms (" << cameraSeconds * 1000.0 << " ms camera after camera)" << endl;
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+
+    return result;
+}
+
+// Switch a writer to the segment the manager opened for it. This only waits
+// if the manager has fallen behind; the camera keeps queueing meanwhile.
+bool RotateSegment(FrameWriter& writer)
+{
+    std::shared_ptr<RecordingWriter> next;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(writer.segmentMutex);
+        writer.segmentReady.wait(lock, [&writer] { return writer.nextRecording || writer.nextFailed; });
+        if (writer.nextFailed)
+        {
+            ASYNC_LOG(ASYNC_LOG_ERROR, "Error opening segment " << writer.nextPath);
+            return false;
+        }
+        next.swap(writer.nextRecording);
+        writer.nextPath.swap(writer.segmentPath);
+    }
+    writer.rotationWaitSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    std::shared_ptr<RecordingWriter> previous = writer.recording;
+    writer.recording = next;
+    writer.segmentIndex++;
+    writer.segmentBytes = 0;
+    writer.segmentStart = chrono::steady_clock::now();
+    writer.rotations++;
+
+    // nextPath now holds the name of the previous segment
+    segmentManager.rotated(&writer, previous, writer.nextPath);
+    return true;
+}
+
+// True if the next frame should start a new segment. A segment always gets
+// at least one frame, so a frame larger than the limit still gets written.
+bool RotationDue(const FrameWriter& writer, uint64_t frameSize)
+{
+    if (!RotationEnabled() || writer.recording->frameCount() == 0)
+    {
+        return false;
+    }
+
+    if (rotateBytes > 0 && writer.segmentBytes + frameSize > rotateBytes)
+    {
+        return true;
+    }
+
+    return rotateSeconds > 0.0 &&
+           chrono::duration<double>(chrono::steady_clock::now() - writer.segmentStart).count() >= rotateSeconds;
+}
+
+// Distance to the previous pixel of the same color for FrameCodec, or 0 if
+// the pixel format is not one it compresses
+unsigned int CodecDistance(uint32_t pixelFormat)
+{
+    switch (static_cast<PixelFormatEnums>(pixelFormat))
+    {
+    case PixelFormat_Mono8:
+        return 1;
+    case PixelFormat_BayerRG8:
+    case PixelFormat_BayerGR8:
+    case PixelFormat_BayerGB8:
+    case PixelFormat_BayerBG8:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+// Compress a frame into the writer's buffer if that makes it smaller; frame
+// and data are updated to what should be written
+void CompressFrame(FrameWriter& writer, RecordedFrame& frame, const void*& data)
+{
+    const unsigned int distance = CodecDistance(frame.pixelFormat);
+    if (distance == 0)
+    {
+        return;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    const size_t size = static_cast<size_t>(frame.dataSize);
+    if (writer.encoded.size() < FrameCodec::maxEncodedSize(size))
+    {
+        writer.encoded.resize(FrameCodec::maxEncodedSize(size));
+    }
+
+    const size_t encodedSize =
+        FrameCodec::encode(static_cast<const uint8_t*>(data), size, distance, &writer.encoded[0]);
+    if (encodedSize < size)
+    {
+        frame.codec = FRAME_CODEC_DELTA_PACK;
+        frame.imageSize = frame.dataSize;
+        frame.dataSize = encodedSize;
+        data = &writer.encoded[0];
+    }
+
+    writer.compressSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Body of each writer thread: writes queued frames to its piece of the
+// camera's recording until acquisition is done and the queue is empty
+void WriteFramesToFile(FrameWriter* pWriter)
+{
+    FrameWriter& writer = *pWriter;
+
+    while (true)
+    {
+        FrameQueue::Slot* slot = writer.queue.front();
+        if (slot == NULL)
+        {
+            // Check the queue again after seeing done, as a frame may have been
+            // queued just before it was set
+            if (writer.done.load(memory_order_acquire) && writer.queue.front() == NULL)
+            {
+                break;
+            }
+            this_thread::sleep_for(chrono::microseconds(k_writerIdleSleepUs));
+            continue;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        RecordedFrame frame = slot->frame;
+        const void* data = &slot->data[0];
+        if (compressFrames)
+        {
+            CompressFrame(writer, frame, data);
+        }
+
+        const uint64_t recordSize = RECORDING_FRAME_HEADER_SIZE + frame.dataSize;
+
+        if (!writer.failed.load(memory_order_relaxed) && RotationDue(writer, recordSize) && !RotateSegment(writer))
+        {
+            writer.failed.store(true, memory_order_release);
+        }
+
+        if (!writer.failed.load(memory_order_relaxed))
+        {
+            // Check if the writing is successful
+            if (!writer.recording->writeFrame(frame, data))
+            {
+                writer.failed.store(true, memory_order_release);
+            }
+            else
+            {
+                writer.framesWritten++;
+                writer.segmentBytes += recordSize;
+                writer.imageBytes += slot->frame.dataSize;
+                writer.storedBytes += frame.dataSize;
+            }
+        }
+
+        const chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+        const double seconds = chrono::duration<double>(elapsed).count();
+        writer.writeSeconds += seconds;
+        writer.maxWriteSeconds = max(writer.maxWriteSeconds, seconds);
+
+        writer.busyNanoseconds.fetch_add(
+            static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()), memory_order_relaxed);
+        writer.bytesWritten.fetch_add(slot->frame.dataSize, memory_order_release);
+
+        writer.queue.pop();
+    }
+}
+
+// Start a writer thread for each piece of each camera's recording, with queue
+// slots sized for the camera's payload
+void StartWriters(CameraList& camList, unsigned int numCameras)
+{
+    if (RotationEnabled())
+    {
+        segmentManager.start();
+    }
+
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        CIntegerPtr ptrPayloadSize = camList.GetByIndex(cameraCnt)->GetNodeMap().GetNode("PayloadSize");
+
+        vector<std::shared_ptr<FrameWriter>>& writers = imageInfos.at(cameraCnt).writers;
+        for (size_t piece = 0; piece < writers.size(); piece++)
+        {
+            if (IsReadable(ptrPayloadSize))
+            {
+                writers[piece]->queue.reserve(static_cast<size_t>(ptrPayloadSize->GetValue()));
+            }
+
+            if (RotationEnabled())
+            {
+                // The second segment is ready before the first one fills up
+                writers[piece]->segmentStart = chrono::steady_clock::now();
+                segmentManager.prepare(writers[piece].get(), 1);
+            }
+
+            writers[piece]->thread = std::thread(WriteFramesToFile, writers[piece].get());
+        }
+    }
+}
+
+// Let the writer threads drain their queues, wait for them to finish and
+// close the recordings. Returns false if any write failed.
+bool StopWriters(unsigned int numCameras)
+{
+    bool result = true;
+
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        vector<std::shared_ptr<FrameWriter>>& writers = imageInfos.at(cameraCnt).writers;
+        for (size_t piece = 0; piece < writers.size(); piece++)
+        {
+            writers[piece]->done.store(true, memory_order_release);
+        }
+    }
+
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        vector<std::shared_ptr<FrameWriter>>& writers = imageInfos.at(cameraCnt).writers;
+        for (size_t piece = 0; piece < writers.size(); piece++)
+        {
+            FrameWriter& writer = *writers[piece];
+
+            if (writer.thread.joinable())
+            {
+                writer.thread.join();
+            }
+
+            // Writes the index of the recording
+            if (!writer.recording->close())
+            {
+                writer.failed = true;
+            }
+
+            if (writer.failed)
+            {
+                ASYNC_LOG(ASYNC_LOG_ERROR,
+                          "Error writing to file " << writer.segmentPath << " for camera " << cameraCnt << " !");
+                result = false;
+            }
+        }
+    }
+
+    // Closes the segments still queued and writes the final manifest
+    if (!segmentManager.stop())
+    {
+        result = false;
+    }
+
+    // Print what the writer threads reported before anything else
+    AsyncLog::flush();
+
+    return result;
+}
+
+// Pick the piece that the next frame of a camera goes to. Blocks of
+// stripeFrames frames go to the same piece, so every write stays large.
+FrameWriter& SelectPiece(ImageInfo& imageInfo, uint64_t frameSize)
+{
+    const vector<std::shared_ptr<FrameWriter>>& writers = imageInfo.writers;
+
+    if (imageInfo.framesInBlock == 0 && writers.size() > 1)
+    {
+        // Round-robin, also until every piece has written something to measure
+        imageInfo.currentPiece = static_cast<size_t>(imageInfo.blocks % writers.size());
+
+        if (stripePolicy == STRIPE_BANDWIDTH)
+        {
+            // Estimate when each piece would have written this block, from its
+            // backlog and the bandwidth it has achieved so far
+            const double blockBytes = static_cast<double>(frameSize) * stripeFrames;
+            double bestFinish = 0.0;
+
+            for (size_t piece = 0; piece < writers.size(); piece++)
+            {
+                const uint64_t written = writers[piece]->bytesWritten.load(memory_order_acquire);
+                const uint64_t busy = writers[piece]->busyNanoseconds.load(memory_order_relaxed);
+                if (written == 0 || busy == 0)
+                {
+                    bestFinish = 0.0;
+                    imageInfo.currentPiece = static_cast<size_t>(imageInfo.blocks % writers.size());
+                    break;
+                }
+
+                const double bytesPerNanosecond = static_cast<double>(written) / busy;
+                const double finish = (writers[piece]->bytesQueued - written + blockBytes) / bytesPerNanosecond;
+                if (piece == 0 || finish < bestFinish)
+                {
+                    bestFinish = finish;
+                    imageInfo.currentPiece = piece;
+                }
+            }
+        }
+
+        imageInfo.blocks++;
+    }
+
+    imageInfo.framesInBlock = (imageInfo.framesInBlock + 1) % stripeFrames;
+    return *writers[imageInfo.currentPiece];
+}
+
+// Copy a frame and its frame header into the camera's writer queue. If the
+// queue is full, wait for the writer to free a slot and count the wait as grab
+// stall time.
+bool QueueFrame(ImageInfo& imageInfo, const ImagePtr& pImage)
+{
+    FrameWriter& writer = SelectPiece(imageInfo, pImage->GetImageSize());
+    FrameQueue::Slot* slot = writer.queue.beginPush();
+
+    if (slot == NULL)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while ((slot = writer.queue.beginPush()) == NULL)
+        {
+            if (writer.failed.load(memory_order_acquire))
+            {
+                return false;
+            }
+            this_thread::yield();
+        }
+        writer.grabStallSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    RecordedFrame& frame = slot->frame;
+    frame.frameId = pImage->GetFrameID();
+    frame.timestamp = imageInfo.chunkTimestamp ? static_cast<uint64_t>(pImage->GetChunkData().GetTimestamp())
+                                               : pImage->GetTimeStamp();
+    frame.width = static_cast<uint32_t>(pImage->GetWidth());
+    frame.height = static_cast<uint32_t>(pImage->GetHeight());
+    frame.pixelFormat = static_cast<uint32_t>(pImage->GetPixelFormat());
+    frame.status = RECORDING_STATUS_COMPLETE;
+    if (pImage->IsIncomplete())
+    {
+        // Incomplete frames are recorded too, so FrameIDs stay contiguous
+        frame.status = max(1u, static_cast<uint32_t>(pImage->GetImageStatus()));
+    }
+    frame.dataSize = pImage->GetImageSize();
+
+    slot->data.resize(static_cast<size_t>(frame.dataSize));
+    memcpy(&slot->data[0], pImage->GetData(), slot->data.size());
+
+    writer.queue.endPush();
+    writer.framesQueued++;
+    writer.bytesQueued += frame.dataSize;
+    return true;
+}
+
+// Print the writer queue and stall statistics of each camera and piece
+void PrintWriterStatistics(unsigned int numCameras)
+{
+    cout << endl << "*** WRITER STATISTICS ***" << endl << endl;
+
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        const vector<std::shared_ptr<FrameWriter>>& writers = imageInfos.at(cameraCnt).writers;
+        for (size_t piece = 0; piece < writers.size(); piece++)
+        {
+            const FrameWriter& writer = *writers[piece];
+
+            cout << "Camera[" << cameraCnt << "]";
+            if (writers.size() > 1)
+            {
+                cout << " " << writer.path;
+            }
+            cout << ": " << writer.framesWritten << "/" << writer.framesQueued
+                 << " frames written, queue high-water mark " << writer.queue.highWaterMark() << "/"
+                 << writer.queue.capacity() << ", camera stalled " << writer.grabStallSeconds * 1000.0
+                 << " ms on a full queue, writing took " << writer.writeSeconds * 1000.0 << " ms (longest write "
+                 << writer.maxWriteSeconds * 1000.0 << " ms)";
+            if (compressFrames && writer.storedBytes > 0)
+            {
+                cout << ", compressed " << static_cast<double>(writer.imageBytes) / writer.storedBytes
+                     << ":1 in " << writer.compressSeconds * 1000.0 << " ms";
+            }
+            if (RotationEnabled())
+            {
+                cout << ", " << writer.rotations << " rotations waited " << writer.rotationWaitSeconds * 1000.0
+                     << " ms for the next segment";
+            }
+            cout << endl;
+        }
+    }
+
+    if (retainBytes > 0)
+    {
+        cout << segmentManager.deletedSegments() << " segments deleted to stay within " << retainBytes / 1000000
+             << " MB" << endl;
+    }
+    cout << endl;
+}
+
+// What a camera's image event handler reports about each image it queued
+struct GrabCompletion
+{
+    unsigned int cameraCnt;
+    uint64_t frameId;
+    bool incomplete;
+    int imageStatus;
+
+    // Set if the image could not be queued; the acquisition is aborted
+    bool failed;
+    string error;
+};
+
+// Completions of all cameras, in the order the images arrived
+class GrabCompletionQueue
+{
+  public:
+    void push(const GrabCompletion& completion)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completions.push_back(completion);
+        }
+        m_ready.notify_one();
+    }
+
+    // Take the oldest completion, waiting up to timeout for one to arrive
+    bool pop(GrabCompletion& completion, chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_ready.wait_for(lock, timeout, [this] { return !m_completions.empty(); }))
+        {
+            return false;
+        }
+        completion = m_completions.front();
+        m_completions.pop_front();
+        return true;
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    deque<GrabCompletion> m_completions;
+};
+
+// Image event handler of one camera. Images belong to the SDK only until
+// OnImageEvent returns, so the handler copies each one into the camera's
+// writer queue right away and only reports it to the acquisition loop.
+class GrabEventHandler : public ImageEventHandler
+{
+  public:
+    GrabEventHandler(unsigned int cameraCnt, GrabCompletionQueue& completions)
+        : m_cameraCnt(cameraCnt), m_completions(completions), m_imageCnt(0), m_failed(false)
+    {
+    }
+
+    void OnImageEvent(ImagePtr image)
+    {
+        // Images that arrive after the last one wanted, or after a failure,
+        // are left to the SDK
+        if (m_imageCnt >= numImages || m_failed)
+        {
+            return;
+        }
+
+        GrabCompletion completion;
+        completion.cameraCnt = m_cameraCnt;
+        completion.frameId = 0;
+        completion.incomplete = false;
+        completion.imageStatus = 0;
+        completion.failed = false;
+
+        try
+        {
+            completion.frameId = image->GetFrameID();
+            completion.incomplete = image->IsIncomplete();
+            completion.imageStatus = static_cast<int>(image->GetImageStatus());
+
+            // Hand a copy of the image to the camera's writer thread; its
+            // status is kept in the frame header
+            if (!QueueFrame(imageInfos.at(m_cameraCnt), image))
+            {
+                completion.failed = true;
+                completion.error = "Error writing to file";
+            }
+        }
+        catch (Spinnaker::Exception& e)
+        {
+            completion.failed = true;
+            completion.error = e.what();
+        }
+
+        m_imageCnt++;
+        m_failed = completion.failed;
+        m_completions.push(completion);
+    }
+
+  private:
+    const unsigned int m_cameraCnt;
+    GrabCompletionQueue& m_completions;
+
+    // Only touched on the camera's event thread
+    unsigned int m_imageCnt;
+    bool m_failed;
+};
+
+// Progress of one camera as seen by the acquisition loop
+struct GrabProgress
+{
+    unsigned int imageCnt;
+    unsigned int incompleteCnt;
+    bool timedOut;
+    chrono::steady_clock::time_point firstImage;
+    chrono::steady_clock::time_point lastImage;
+};
+
+//
+// Take images from whichever camera delivers first until every camera has
+// delivered numImages images, failed or gone quiet
+//
+// *** NOTES ***
+// A camera times out when it delivers nothing for k_grabTimeoutMs, counted
+// from its own last image, so cameras at a low frame rate are not affected
+// by how fast the others run.
+//
+bool WaitForImages(unsigned int numCameras, GrabCompletionQueue& completions, vector<GrabProgress>& progress)
+{
+    bool result = true;
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        GrabProgress cameraProgress = {0, 0, false, start, start};
+        progress.push_back(cameraProgress);
+    }
+
+    unsigned int pendingCameras = numImages > 0 ? numCameras : 0;
+    while (pendingCameras > 0)
+    {
+        GrabCompletion completion;
+        if (completions.pop(completion, chrono::milliseconds(k_grabTimeoutMs / 10 + 1)))
+        {
+            GrabProgress& cameraProgress = progress[completion.cameraCnt];
+
+            if (completion.failed)
+            {
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << completion.error << " for camera " << completion.cameraCnt
+                                                     << " !");
+                return false;
+            }
+
+            if (completion.incomplete)
+            {
+                ASYNC_LOG(ASYNC_LOG_WARNING, "Camera[" << completion.cameraCnt
+                                                       << "]: Image incomplete with image status "
+                                                       << completion.imageStatus << "...");
+                ASYNC_LOG(ASYNC_LOG_WARNING, "");
+                cameraProgress.incompleteCnt++;
+            }
+
+            cameraProgress.lastImage = chrono::steady_clock::now();
+            if (cameraProgress.imageCnt == 0)
+            {
+                cameraProgress.firstImage = cameraProgress.lastImage;
+            }
+            // A camera that timed out is no longer pending, even if its
+            // remaining images arrive late
+            if (++cameraProgress.imageCnt == numImages && !cameraProgress.timedOut)
+            {
+                pendingCameras--;
+            }
+        }
+
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            GrabProgress& cameraProgress = progress[cameraCnt];
+
+            if (cameraProgress.imageCnt < numImages && !cameraProgress.timedOut &&
+                now - cameraProgress.lastImage > chrono::milliseconds(k_grabTimeoutMs))
+            {
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Error: Camera[" << cameraCnt << "] delivered no image for "
+                                                            << k_grabTimeoutMs << " ms after "
+                                                            << cameraProgress.imageCnt << " images");
+                cameraProgress.timedOut = true;
+                pendingCameras--;
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+// This function acquires and saves numImages images from a device; please see
+// Acquisition example for more in-depth comments on acquiring images.
+bool AcquireImagesAndSaveToFile(CameraList& camList, unsigned int numCameras)
+{
+    bool result = true;
+
+    uint64_t missedImageCnts = 0;
+
+    cout << endl << endl << "*** ACQUIRING AND SAVING IMAGES TO A FILE ***" << endl << endl;
+
+    // Frames are written by one thread per camera
+    StartWriters(camList, numCameras);
+
+    // Every camera's image event handler reports to the same queue
+    GrabCompletionQueue completions;
+    vector<std::shared_ptr<GrabEventHandler>> eventHandlers;
+
+    try
+    {
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            eventHandlers.push_back(std::make_shared<GrabEventHandler>(cameraCnt, completions));
+            camList.GetByIndex(cameraCnt)->RegisterEventHandler(*eventHandlers.back());
+        }
+
+        // Begin acquiring images in all cameras
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            camList.GetByIndex(cameraCnt)->BeginAcquisition();
+            cout << "Camera[" << cameraCnt << "]: Started acquiring images" << endl;
+        }
+
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        vector<GrabProgress> progress;
+        if (!WaitForImages(numCameras, completions, progress))
+        {
+            result = false;
+        }
+        AsyncLog::flush();
+
+        // End acquisition for all cameras
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            // Check for any dropped images
+            CIntegerPtr pDroppedImages =
+                camList.GetByIndex(cameraCnt)->GetTLStreamNodeMap().GetNode("StreamDroppedFrameCount");
+            if (IsReadable(pDroppedImages))
+            {
+                if (pDroppedImages->GetValue() > 0)
+                {
+                    missedImageCnts += pDroppedImages->GetValue();
+                    cout << pDroppedImages->GetValue() << " images "
+                         << " missed at camera " << cameraCnt << endl;
+                }
+            }
+            else
+            {
+                cout << "Unable to determine the dropped frame count from the nodemap at camera " << cameraCnt << endl
+                     << endl;
+            }
+            camList.GetByIndex(cameraCnt)->EndAcquisition();
+            camList.GetByIndex(cameraCnt)->UnregisterEventHandler(*eventHandlers[cameraCnt]);
+            cout << "Camera[" << cameraCnt << "]: Stop acquiring images " << endl;
+        }
+        cout << endl;
+
+        // Wait for the queued frames to reach the files
+        if (!StopWriters(numCameras))
+        {
+            result = false;
+        }
+
+        cout << "We missed a total of " << missedImageCnts << " images!" << endl << endl;
+
+        for (unsigned int cameraCnt = 0; cameraCnt < progress.size(); cameraCnt++)
+        {
+            const double seconds = chrono::duration<double>(progress[cameraCnt].lastImage - start).count();
+            const double firstSeconds = chrono::duration<double>(progress[cameraCnt].firstImage - start).count();
+            cout << "Camera[" << cameraCnt << "]: " << progress[cameraCnt].imageCnt << " images ("
+                 << progress[cameraCnt].incompleteCnt << " incomplete) in " << seconds * 1000.0
+                 << " ms, first image after " << firstSeconds * 1000.0 << " ms";
+            if (seconds > 0.0)
+            {
+                cout << ", " << progress[cameraCnt].imageCnt / seconds << " images/s";
+            }
+            cout << endl;
+        }
+
+        PrintWriterStatistics(numCameras);
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        cout << "Error: " << e.what() << endl;
+        for (unsigned int cameraCnt = 0; cameraCnt < eventHandlers.size(); cameraCnt++)
+        {
+            CameraPtr pCam = camList.GetByIndex(cameraCnt);
+            if (pCam->IsStreaming())
+            {
+                pCam->EndAcquisition();
+            }
+            pCam->UnregisterEventHandler(*eventHandlers[cameraCnt]);
+        }
+        StopWriters(numCameras);
+        result = false;
+    }
+
+    return result;
+}
+
+// Print the span of a recording and look up the frame halfway through it by
+// timestamp, using only the index
+void PrintRecordingIndex(const RecordingSet& reader, unsigned int cameraCnt)
+{
+    if (reader.frameCount() == 0)
+    {
+        return;
+    }
+
+    const RecordedFrame& first = reader.indexEntry(0);
+    const RecordedFrame& last = reader.indexEntry(reader.frameCount() - 1);
+
+    cout << "Camera[" << cameraCnt << "]: " << reader.frameCount() << " frames, FrameID " << first.frameId << " to "
+         << last.frameId << ", timestamps " << first.timestamp << " to " << last.timestamp << endl;
+
+    const uint64_t middle = first.timestamp + (last.timestamp - first.timestamp) / 2;
+    const size_t n = reader.findTimestamp(middle);
+    if (n < reader.frameCount())
+    {
+        cout << "Camera[" << cameraCnt << "]: First frame at or after timestamp " << middle << " is frame " << n
+             << " (FrameID " << reader.indexEntry(n).frameId << ")" << endl;
+    }
+}
+
+// Consecutive frames of one piece of a camera's recording, exported together
+struct ExportBlock
+{
+    unsigned int cameraCnt;
+    const RecordingReader* piece;
+
+    // Bytes of the piece holding the frame records
+    uint64_t begin;
+    uint64_t end;
+
+    // Position of each frame in the camera's recording, used in the file names
+    vector<size_t> imageNumbers;
+};
+
+// Counters of one export worker
+struct ExportStats
+{
+    uint64_t exported;
+    uint64_t skipped;
+    uint64_t bytes;
+    bool failed;
+
+    ExportStats() : exported(0), skipped(0), bytes(0), failed(false)
+    {
+    }
+};
+
+// Cut a camera's recording into blocks of at most k_exportBlockBytes
+void SplitIntoExportBlocks(const RecordingSet& reader, unsigned int cameraCnt, vector<ExportBlock>& blocks)
+{
+    // Position in the recording of every frame of every piece
+    vector<vector<size_t>> imageNumbers(reader.pieceCount());
+    for (size_t piece = 0; piece < reader.pieceCount(); piece++)
+    {
+        imageNumbers[piece].resize(reader.piece(piece).frameCount());
+    }
+    for (size_t imageCnt = 0; imageCnt < reader.frameCount(); imageCnt++)
+    {
+        imageNumbers[reader.pieceOf(imageCnt)][reader.frameInPiece(imageCnt)] = imageCnt;
+    }
+
+    for (size_t piece = 0; piece < reader.pieceCount(); piece++)
+    {
+        const RecordingReader& pieceReader = reader.piece(piece);
+
+        size_t frame = 0;
+        while (frame < pieceReader.frameCount())
+        {
+            ExportBlock block;
+            block.cameraCnt = cameraCnt;
+            block.piece = &pieceReader;
+            block.begin = pieceReader.indexEntry(frame).offset;
+
+            // A block always holds at least one frame
+            do
+            {
+                block.imageNumbers.push_back(imageNumbers[piece][frame]);
+                block.end = pieceReader.recordEnd(frame);
+                frame++;
+            } while (frame < pieceReader.frameCount() &&
+                     pieceReader.recordEnd(frame) - block.begin <= k_exportBlockBytes);
+
+            blocks.push_back(block);
+        }
+    }
+}
+
+// Body of each export worker: takes the next block, reads it with one read
+// and saves its frames. The read buffer, the image and the open files are
+// kept for the next block.
+void ExportBlocks(
+    const vector<ExportBlock>& blocks,
+    atomic<size_t>& nextBlock,
+    const string& fileFormat,
+    ExportStats& stats)
+{
+    vector<char> buffer;
+    vector<char> image;
+    vector<RecordedFrame> frames;
+    vector<size_t> dataOffsets;
+    map<string, std::shared_ptr<ifstream>> files;
+
+    try
+    {
+        ImagePtr pImage = Image::Create();
+
+        for (size_t blockCnt = nextBlock++; blockCnt < blocks.size(); blockCnt = nextBlock++)
+        {
+            const ExportBlock& block = blocks[blockCnt];
+
+            std::shared_ptr<ifstream>& file = files[block.piece->path()];
+            if (!file)
+            {
+                file = std::make_shared<ifstream>(block.piece->path().c_str(), ios::in | ios::binary);
+            }
+
+            // Read image into buffer; each frame brings its own size and format
+            const size_t size = static_cast<size_t>(block.end - block.begin);
+            if (buffer.size() < size)
+            {
+                buffer.resize(size);
+            }
+
+            file->clear();
+            file->seekg(static_cast<streamoff>(block.begin));
+            if (!file->read(&buffer[0], static_cast<streamsize>(size)) ||
+                !RecordingReader::parseBlock(&buffer[0], size, block.begin, frames, dataOffsets) ||
+                frames.size() != block.imageNumbers.size())
+            {
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Error reading from image " << block.imageNumbers[0] << " for camera "
+                                                                       << block.cameraCnt << ". Aborting...");
+                stats.failed = true;
+                nextBlock = blocks.size();
+                return;
+            }
+
+            for (size_t i = 0; i < frames.size(); i++)
+            {
+                const RecordedFrame& frame = frames[i];
+
+                if (!frame.isComplete())
+                {
+                    ASYNC_LOG(ASYNC_LOG_WARNING, "Camera[" << block.cameraCnt << "]: Skipping image "
+                                                           << block.imageNumbers[i] << " (FrameID " << frame.frameId
+                                                           << ") with image status " << frame.status);
+                    stats.skipped++;
+                    continue;
+                }
+
+                // Point the image at the frame in the buffer; nothing is copied
+                // unless the frame was compressed
+                char* data = &buffer[dataOffsets[i]];
+                if (frame.codec != FRAME_CODEC_NONE)
+                {
+                    if (image.size() < frame.imageSize)
+                    {
+                        image.resize(static_cast<size_t>(frame.imageSize));
+                    }
+                    if (!RecordingFormat::decodeImage(frame, data, &image[0]))
+                    {
+                        ASYNC_LOG(ASYNC_LOG_ERROR, "Error decoding image " << block.imageNumbers[i] << " for camera "
+                                                                           << block.cameraCnt << ". Aborting...");
+                        stats.failed = true;
+                        nextBlock = blocks.size();
+                        return;
+                    }
+                    data = &image[0];
+                }
+
+                pImage->ResetImage(
+                    frame.width, frame.height, 0, 0, static_cast<PixelFormatEnums>(frame.pixelFormat), data);
+
+                // Create file location and file name
+                stringstream sstream;
+                sstream << kDestinationDirectory << "camera" << block.cameraCnt << "_" << block.imageNumbers[i] << "."
+                        << fileFormat;
+
+                //  Save image to disk
+                pImage->Save(sstream.str().c_str());
+
+                stats.exported++;
+                stats.bytes += frame.imageSize;
+            }
+        }
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << e.what());
+        stats.failed = true;
+        nextBlock = blocks.size();
+    }
+}
+
+//
+// Export every frame of every camera to an image file
+//
+// *** NOTES ***
+// The blocks of all cameras are interleaved, so all recordings, and all the
+// drives they are striped over, are read at the same time. Workers take the
+// next block as they finish one, so a slow camera or format does not leave
+// the others idle. An image's file name is fixed by its camera and its
+// position in the camera's recording, whichever worker saves it.
+//
+bool RetrieveImagesFromFiles(unsigned int numCameras, string fileFormat = "bmp")
+{
+    // The manifest lists the files holding each camera's recording
+    RecordingManifest manifest;
+
+    if (!manifest.read(ManifestPath()) || manifest.pieces.size() < numCameras)
+    {
+        cout << "Error reading manifest: " << ManifestPath() << " Aborting..." << endl;
+
+        return false;
+    }
+
+    vector<std::shared_ptr<RecordingSet>> readers;
+    vector<vector<ExportBlock>> cameraBlocks(numCameras);
+    uint64_t numFrames = 0;
+
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        const vector<string>& pieces = manifest.pieces[cameraCnt];
+
+        for (size_t piece = 0; piece < pieces.size(); piece++)
+        {
+            cout << "Opening " << pieces[piece] << "..." << endl;
+        }
+
+        // Only the file headers and the indexes are read here
+        std::shared_ptr<RecordingSet> reader = std::make_shared<RecordingSet>();
+
+        if (!reader->open(pieces))
+        {
+            cout << "Error opening the files of camera " << cameraCnt << ". Aborting..." << endl;
+
+            return false;
+        }
+        readers.push_back(reader);
+
+        if (reader->recovered())
+        {
+            cout << "Recording was not closed; recovered " << reader->frameCount() << " frames" << endl;
+        }
+
+        PrintRecordingIndex(*reader, cameraCnt);
+
+        SplitIntoExportBlocks(*reader, cameraCnt, cameraBlocks[cameraCnt]);
+        numFrames += reader->frameCount();
+    }
+
+    // Take one block of every camera in turn
+    vector<ExportBlock> blocks;
+    for (size_t round = 0;; round++)
+    {
+        bool added = false;
+        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        {
+            if (round < cameraBlocks[cameraCnt].size())
+            {
+                blocks.push_back(cameraBlocks[cameraCnt][round]);
+                added = true;
+            }
+        }
+        if (!added)
+        {
+            break;
+        }
+    }
+
+    unsigned int numWorkers = exportThreads > 0 ? exportThreads : std::thread::hardware_concurrency();
+    numWorkers = max(1u, min(numWorkers, static_cast<unsigned int>(blocks.size())));
+
+    cout << endl
+         << "Exporting " << numFrames << " images in " << blocks.size() << " blocks with " << numWorkers
+         << " threads..." << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    atomic<size_t> nextBlock(0);
+    vector<ExportStats> stats(numWorkers);
+    vector<std::thread> workers;
+    for (unsigned int workerCnt = 0; workerCnt < numWorkers; workerCnt++)
+    {
+        workers.push_back(std::thread(
+            ExportBlocks, std::cref(blocks), std::ref(nextBlock), std::cref(fileFormat), std::ref(stats[workerCnt])));
+    }
+
+    ExportStats total;
+    for (unsigned int workerCnt = 0; workerCnt < numWorkers; workerCnt++)
+    {
+        workers[workerCnt].join();
+        total.exported += stats[workerCnt].exported;
+        total.skipped += stats[workerCnt].skipped;
+        total.bytes += stats[workerCnt].bytes;
+        total.failed = total.failed || stats[workerCnt].failed;
+    }
+    AsyncLog::flush();
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Exported " << total.exported << " images (" << total.bytes / 1000000.0 << " MB) in " << seconds
+         << " s, " << (seconds > 0.0 ? total.exported / seconds : 0.0) << " images/s";
+    if (total.skipped > 0)
+    {
+        cout << ", skipped " << total.skipped << " incomplete images";
+    }
+    cout << endl << endl;
+
+    return !total.failed;
+}
+
+// Path of the segment after the given one, or an empty string if the path
+// is not that of a segment (see SegmentPath())
+string NextSegmentPath(const string& segmentPath)
+{
+    // ".seg" + 6 digits + ".tmp"
+    const size_t suffixSize = 14;
+    if (segmentPath.size() < suffixSize ||
+        segmentPath.compare(segmentPath.size() - suffixSize, 4, ".seg") != 0 ||
+        segmentPath.compare(segmentPath.size() - 4, 4, ".tmp") != 0)
+    {
+        return "";
+    }
+
+    const unsigned int segmentIndex =
+        static_cast<unsigned int>(atoi(segmentPath.substr(segmentPath.size() - 10, 6).c_str()));
+    return SegmentPath(segmentPath.substr(0, segmentPath.size() - suffixSize), segmentIndex + 1);
+}
+
+//
+// Print the frames of a recording as they are written, typically while
+// another process records
+//
+// *** NOTES ***
+// Only frames the writer has published are read, and their image data is
+// read in place, through the reader's mapping of the file, to compute the
+// mean pixel value. When following a segment, the next segment is followed
+// once it is finished; the writer opens it before closing the current one.
+//
+int FollowRecording(const string& path)
+{
+    RecordingTailReader reader;
+    string currentPath = path;
+
+    // Wait for the writer to create the file and write its header
+    const chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::seconds(k_followOpenSeconds);
+    while (!reader.open(currentPath))
+    {
+        if (chrono::steady_clock::now() > deadline)
+        {
+            cout << "Unable to open " << currentPath << ". Aborting..." << endl;
+            return -1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(k_followPollMs));
+    }
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "Following " << currentPath << "...");
+
+    uint64_t frameCnt = 0;
+    vector<uint8_t> image;
+    while (true)
+    {
+        const size_t newFrames = reader.poll();
+
+        for (size_t n = reader.frameCount() - newFrames; n < reader.frameCount(); n++, frameCnt++)
+        {
+            const RecordedFrame& frame = reader.frame(n);
+            const uint8_t* data = static_cast<const uint8_t*>(reader.frameData(n));
+
+            // Compressed frames have to be decoded first
+            if (frame.codec != FRAME_CODEC_NONE)
+            {
+                image.resize(static_cast<size_t>(frame.imageSize));
+                if (image.empty() || !RecordingFormat::decodeImage(frame, data, &image[0]))
+                {
+                    ASYNC_LOG(ASYNC_LOG_ERROR, "Error decoding frame " << frameCnt << " of " << currentPath
+                                                                       << ". Aborting...");
+                    return -1;
+                }
+                data = &image[0];
+            }
+
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < frame.imageSize; i++)
+            {
+                sum += data[i];
+            }
+
+            const double mean = frame.imageSize > 0 ? static_cast<double>(sum) / frame.imageSize : 0.0;
+            if (frame.isComplete())
+            {
+                ASYNC_LOG(ASYNC_LOG_INFO, "Frame " << frameCnt << ": FrameID " << frame.frameId << ", timestamp "
+                                                   << frame.timestamp << ", " << frame.width << "x" << frame.height
+                                                   << ", mean " << mean);
+            }
+            else
+            {
+                ASYNC_LOG(ASYNC_LOG_INFO, "Frame " << frameCnt << ": FrameID " << frame.frameId << ", timestamp "
+                                                   << frame.timestamp << ", " << frame.width << "x" << frame.height
+                                                   << ", mean " << mean << ", image status " << frame.status);
+            }
+        }
+
+        if (reader.failed())
+        {
+            ASYNC_LOG(ASYNC_LOG_ERROR, "Error reading " << currentPath << ". Aborting...");
+            return -1;
+        }
+
+        if (reader.finished())
+        {
+            const string nextPath = NextSegmentPath(currentPath);
+            if (nextPath.empty() || !reader.open(nextPath))
+            {
+                break;
+            }
+
+            currentPath = nextPath;
+            ASYNC_LOG(ASYNC_LOG_INFO, "Following " << currentPath << "...");
+        }
+        else if (newFrames == 0)
+        {
+            // A segment prepared but never used is deleted when recording stops
+            if (reader.removed())
+            {
+                break;
+            }
+            this_thread::sleep_for(chrono::milliseconds(k_followPollMs));
+        }
+    }
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "Followed " << frameCnt << " frames");
+    return 0;
+}
+
+// Settings of the recording backend benchmark
+struct BackendBenchmarkOptions
+{
+    string directory;
+    unsigned int writers;
+    unsigned int frames;
+    size_t width;
+    size_t height;
+
+    BackendBenchmarkOptions()
+        : directory(kDestinationDirectory), writers(k_benchmarkWriters), frames(k_benchmarkFrames),
+          width(k_benchmarkWidth), height(k_benchmarkHeight)
+    {
+    }
+};
+
+// Measurements of one backend
+struct BackendBenchmarkResult
+{
+    uint64_t bytes;
+    double writeSeconds;
+    double syncSeconds;
+    vector<double> latencies;
+    bool direct;
+    bool failed;
+
+    BackendBenchmarkResult() : bytes(0), writeSeconds(0.0), syncSeconds(0.0), direct(false), failed(false)
+    {
+    }
+};
+
+// Flush whatever the kernel still holds of a file to the disk
+bool SyncFile(const string& path)
+{
+#if defined(__linux__)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    const bool result = fsync(fd) == 0;
+    close(fd);
+    return result;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+// Random bytes, so nothing along the way can compress or deduplicate them
+void FillRandom(vector<char>& data)
+{
+    uint32_t state = 2463534242u;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[i] = static_cast<char>(state);
+    }
+}
+
+// Nearest-rank percentile of sorted values
+double LatencyPercentile(const vector<double>& sorted, double percentile)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(percentile / 100.0 * sorted.size() + 0.999999);
+    rank = min(max(rank, static_cast<size_t>(1)), sorted.size());
+    return sorted[rank - 1];
+}
+
+// Write options.frames frames to one recording, timing every write
+void RunBenchmarkWriter(
+    const string& path,
+    RecordingBackend backend,
+    const BackendBenchmarkOptions& options,
+    const vector<char>& frameData,
+    vector<double>& latencies,
+    atomic<bool>& failed,
+    atomic<bool>& direct)
+{
+    RecordingWriter recording;
+    if (!recording.open(path, backend))
+    {
+        failed = true;
+        return;
+    }
+    direct = recording.isDirect();
+
+    RecordedFrame frame;
+    frame.width = static_cast<uint32_t>(options.width);
+    frame.height = static_cast<uint32_t>(options.height);
+    frame.pixelFormat = static_cast<uint32_t>(PixelFormat_BayerRG8);
+    frame.dataSize = frameData.size();
+
+    latencies.reserve(options.frames);
+    for (unsigned int frameCnt = 0; frameCnt < options.frames; frameCnt++)
+    {
+        frame.frameId = frameCnt;
+        frame.timestamp = frameCnt;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!recording.writeFrame(frame, &frameData[0]))
+        {
+            failed = true;
+            return;
+        }
+        latencies.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+
+    if (!recording.close())
+    {
+        failed = true;
+    }
+}
+
+// Run one writer thread per simulated camera on one backend
+BackendBenchmarkResult RunBackendBenchmark(
+    const BackendBenchmarkOptions& options,
+    RecordingBackend backend,
+    const vector<char>& frameData)
+{
+    BackendBenchmarkResult result;
+    vector<string> paths;
+    vector<vector<double>> latencies(options.writers);
+    vector<std::thread> writers;
+    atomic<bool> failed(false);
+    atomic<bool> direct(false);
+
+    for (unsigned int writerCnt = 0; writerCnt < options.writers; writerCnt++)
+    {
+        stringstream sstream;
+        sstream << options.directory << "benchmark" << writerCnt << ".tmp";
+        paths.push_back(sstream.str());
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for (unsigned int writerCnt = 0; writerCnt < options.writers; writerCnt++)
+    {
+        writers.push_back(std::thread(
+            RunBenchmarkWriter,
+            paths[writerCnt],
+            backend,
+            std::cref(options),
+            std::cref(frameData),
+            std::ref(latencies[writerCnt]),
+            std::ref(failed),
+            std::ref(direct)));
+    }
+    for (size_t writerCnt = 0; writerCnt < writers.size(); writerCnt++)
+    {
+        writers[writerCnt].join();
+    }
+
+    chrono::steady_clock::time_point written = chrono::steady_clock::now();
+
+    // Data still in the page cache has not reached the disk yet
+    for (size_t writerCnt = 0; writerCnt < paths.size(); writerCnt++)
+    {
+        if (!SyncFile(paths[writerCnt]))
+        {
+            failed = true;
+        }
+    }
+
+    result.writeSeconds = chrono::duration<double>(written - start).count();
+    result.syncSeconds = chrono::duration<double>(chrono::steady_clock::now() - written).count();
+    result.bytes = static_cast<uint64_t>(options.writers) * options.frames *
+                   (frameData.size() + RECORDING_FRAME_HEADER_SIZE);
+    result.direct = direct;
+    result.failed = failed;
+
+    for (size_t writerCnt = 0; writerCnt < latencies.size(); writerCnt++)
+    {
+        result.latencies.insert(result.latencies.end(), latencies[writerCnt].begin(), latencies[writerCnt].end());
+    }
+    sort(result.latencies.begin(), result.latencies.end());
 
-    try
+    for (size_t writerCnt = 0; writerCnt < paths.size(); writerCnt++)
     {
-        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
-        {
-            // Get the camera node Map
-            INodeMap& nodeMap = camList.GetByIndex(cameraCnt)->GetNodeMap();
+        remove(paths[writerCnt].c_str());
+    }
 
-            // Set acquisition mode to continuous
-            CEnumerationPtr ptrAcquisitionMode = nodeMap.GetNode("AcquisitionMode");
-            if (!IsReadable(ptrAcquisitionMode))
-            {
-                cout << "Unable to get acquisition mode to continuous (node retrieval). Aborting..." << endl << endl;
-                return false;
-            }
+    return result;
+}
 
-            CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
-            if (!IsReadable(ptrAcquisitionModeContinuous))
-            {
-                cout << "Unable to set acquisition mode to continuous (entry 'continuous' retrieval). Aborting..."
-                     << endl
-                     << endl;
-                return false;
-            }
+//
+// Compare the sustained throughput and the write latency of both recording
+// backends on the disk holding options.directory
+//
+// *** NOTES ***
+// Every writer thread stands in for one camera's writer and writes frames of
+// random bytes to its own recording as fast as it can. The first rate counts
+// the time until every recording is closed; the second also waits for the
+// data to reach the disk, which is what a long recording sustains once the
+// page cache is full. Latencies are those of the single frame writes, the
+// calls a camera's writer thread makes between two queued frames.
+//
+int BenchmarkRecordingBackends(const BackendBenchmarkOptions& options)
+{
+    const size_t frameSize = options.width * options.height;
 
-            int64_t acquisitionModeContinuous = ptrAcquisitionModeContinuous->GetValue();
+    cout << endl << "*** RECORDING BACKEND BENCHMARK ***" << endl << endl;
+    cout << options.writers << " writers x " << options.frames << " frames of " << options.width << "x"
+         << options.height << " (" << frameSize / 1000000.0 << " MB) in '"
+         << (options.directory.empty() ? "." : options.directory) << "'" << endl
+         << endl;
 
-            if (!IsWritable(ptrAcquisitionMode))
-            {
-                cout << "Unable to set acquisition mode to continuous (node retrieval). Aborting..." << endl << endl;
-                return false;
-            }
+    vector<char> frameData(frameSize);
+    FillRandom(frameData);
 
-            ptrAcquisitionMode->SetIntValue(acquisitionModeContinuous);
+    const RecordingBackend backends[] = {RECORDING_BACKEND_STREAM, RECORDING_BACKEND_DIRECT};
+    const char* names[] = {"fstream", "O_DIRECT"};
 
-            cout << "Camera[" << cameraCnt << "]: Acquisition mode set to continuous..." << endl;
+    cout << "backend   written MB/s   on disk MB/s   p50 ms   p99 ms   p99.9 ms   max ms" << endl;
 
-            CEnumerationPtr ptrPixelFormat = nodeMap.GetNode("PixelFormat");
+    int result = 0;
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+    {
+        BackendBenchmarkResult measured = RunBackendBenchmark(options, backends[i], frameData);
+        if (measured.failed)
+        {
+            cout << names[i] << ": writing failed" << endl;
+            result = -1;
+            continue;
+        }
 
-            if (!IsWritable(ptrPixelFormat))
-            {
-                cout << "Unable to set Pixel Format mode (node retrieval). Aborting..." << endl << endl;
-                return false;
-            }
+        const double megabytes = measured.bytes / 1000000.0;
+        const vector<double>& latencies = measured.latencies;
+
+        cout.setf(ios::fixed);
+        cout.precision(1);
+        cout.width(8);
+        cout << left << names[i] << right;
+        cout.width(15);
+        cout << megabytes / measured.writeSeconds;
+        cout.width(15);
+        cout << megabytes / (measured.writeSeconds + measured.syncSeconds);
+        cout.precision(2);
+        cout.width(9);
+        cout << LatencyPercentile(latencies, 50.0) * 1000.0;
+        cout.width(9);
+        cout << LatencyPercentile(latencies, 99.0) * 1000.0;
+        cout.width(11);
+        cout << LatencyPercentile(latencies, 99.9) * 1000.0;
+        cout.width(9);
+        cout << latencies.back() * 1000.0;
+        if (backends[i] == RECORDING_BACKEND_DIRECT && !measured.direct)
+        {
+            cout << "   (O_DIRECT not supported here, page cache used)";
+        }
+        cout << endl;
+        cout.unsetf(ios::fixed);
+        cout.precision(6);
+    }
+    cout << endl;
 
-            CEnumEntryPtr ptrPixelFormatBayerRG8 = ptrPixelFormat->GetEntryByName("BayerRG8");
-            CEnumEntryPtr ptrMono8 = ptrPixelFormat->GetEntryByName("Mono8");
+    return result;
+}
 
-            if (IsReadable(ptrPixelFormatBayerRG8))
-            {
-                ptrPixelFormat->SetIntValue(ptrPixelFormatBayerRG8->GetValue());
+// Compress and decompress the frames k_codecBenchmarkPasses times with the
+// plain or the vector code; returns the compression ratio and MB/s of image
+// data each way, or false if a frame did not come back unchanged
+bool MeasureCodec(
+    const vector<vector<uint8_t>>& images,
+    const vector<unsigned int>& distances,
+    bool simd,
+    double& ratio,
+    double& compressMBps,
+    double& decompressMBps)
+{
+    vector<vector<uint8_t>> encoded(images.size());
+    vector<uint8_t> decoded;
+    uint64_t imageBytes = 0;
+    uint64_t encodedBytes = 0;
 
-                // Keep the track of the pixel Format
-                imageInfos.at(cameraCnt).pixelFormat = PixelFormatEnums::PixelFormat_BayerRG8;
-                cout << "Camera[" << cameraCnt
-                     << "]: Pixel format set to: " << ptrPixelFormat->GetCurrentEntry()->GetName() << endl;
-            }
-            else if (IsReadable(ptrMono8))
-            {
-                ptrPixelFormat->SetIntValue(ptrMono8->GetValue());
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned int pass = 0; pass < k_codecBenchmarkPasses; pass++)
+    {
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            encoded[i].resize(FrameCodec::maxEncodedSize(images[i].size()));
+            encoded[i].resize(
+                FrameCodec::encode(&images[i][0], images[i].size(), distances[i], &encoded[i][0], simd));
+        }
+    }
+    const double compressSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-                // Keep the track of the pixel Format
-                imageInfos.at(cameraCnt).pixelFormat = PixelFormatEnums::PixelFormat_Mono8;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        imageBytes += images[i].size();
+        encodedBytes += encoded[i].size();
+    }
 
-                cout << "Camera[" << cameraCnt << "]: Pixel format set to "
-                     << ptrPixelFormat->GetCurrentEntry()->GetName() << endl;
-            }
-            else
+    start = chrono::steady_clock::now();
+    for (unsigned int pass = 0; pass < k_codecBenchmarkPasses; pass++)
+    {
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            decoded.resize(images[i].size());
+            if (!FrameCodec::decode(&encoded[i][0], encoded[i].size(), &decoded[0], decoded.size(), simd) ||
+                (pass == 0 && decoded != images[i]))
             {
-                cout << "Unable to set pixel format (enum entry retrieval). Aborting..." << endl << endl;
                 return false;
             }
         }
     }
-    catch (Spinnaker::Exception& e)
-    {
-        cout << "Error: " << e.what() << endl;
-        result = false;
-    }
+    const double decompressSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    return result;
+    const double totalMB = static_cast<double>(imageBytes) * k_codecBenchmarkPasses / 1000000.0;
+    ratio = encodedBytes > 0 ? static_cast<double>(imageBytes) / encodedBytes : 0.0;
+    compressMBps = compressSeconds > 0.0 ? totalMB / compressSeconds : 0.0;
+    decompressMBps = decompressSeconds > 0.0 ? totalMB / decompressSeconds : 0.0;
+    return true;
 }
 
-// This function acquires and saves k_numImages images from a device; please see
-// Acquisition example for more in-depth comments on acquiring images.
-bool AcquireImagesAndSaveToFile(CameraList& camList, unsigned int numCameras)
+//
+// Measure the lossless codec on the frames of a recording
+//
+// *** NOTES ***
+// Real frames matter here: the ratio, and the speed with it, depends on the
+// noise and detail of the scene. Record a few frames of the cameras first,
+// then point --benchmark-codec at one of the files. Both the plain and the
+// vector code are measured, and every frame is checked to decode to exactly
+// what was compressed.
+//
+int BenchmarkCodec(const string& path)
 {
-    bool result = true;
+    cout << endl << "*** CODEC BENCHMARK ***" << endl << endl;
 
-    uint64_t missedImageCnts = 0;
-
-    cout << endl << endl << "*** ACQUIRING AND SAVING IMAGES TO A FILE ***" << endl << endl;
-
-    try
+    RecordingReader reader;
+    if (!reader.open(path))
     {
+        cout << "Unable to open " << path << ". Aborting..." << endl;
+        return -1;
+    }
 
-        // Begin acquiring images in all cameras
-        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    vector<vector<uint8_t>> images;
+    vector<unsigned int> distances;
+    vector<char> data;
+    size_t skipped = 0;
+    for (size_t n = 0; n < reader.frameCount() && images.size() < k_codecBenchmarkFrames; n++)
+    {
+        RecordedFrame frame;
+        if (!reader.readFrame(n, frame, data))
         {
-            camList.GetByIndex(cameraCnt)->BeginAcquisition();
-            cout << "Camera[" << cameraCnt << "]: Started acquiring images" << endl;
+            cout << "Unable to read frame " << n << " of " << path << ". Aborting..." << endl;
+            return -1;
         }
 
-        for (unsigned int imageCnt = 0; imageCnt < k_numImages; imageCnt++)
-        {
-            // Loop through each of the cameras
-            for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
-            {
-                try
-                {
-                    // Retrieve the next received image
-                    ImagePtr pResultImage = camList.GetByIndex(cameraCnt)->GetNextImage(1000);
-
-                    if (pResultImage->IsIncomplete())
-                    {
-                        cout << "Image incomplete with image status " << pResultImage->GetImageStatus() << "..." << endl
-                             << endl;
-                    }
-                    else
-                    {
-                        char* imageData = static_cast<char*>(pResultImage->GetData());
-
-                        // Do the writing
-                        imageInfos.at(cameraCnt).imageFile->write(imageData, pResultImage->GetImageSize());
-
-                        // Check if the writing is successful
-                        if (!imageInfos.at(cameraCnt).imageFile->good())
-                        {
-                            cout << "Error writing to file for camera " << cameraCnt << " !" << endl;
-                            return false;
-                        }
-
-                        if (imageCnt == 0)
-                        {
-                            // This is the first image, save image size
-                            imageInfos.at(cameraCnt).imageHeight = pResultImage->GetHeight();
-                            imageInfos.at(cameraCnt).imageWidth = pResultImage->GetWidth();
-                        }
-                    }
-
-                    // Release image
-                    pResultImage->Release();
-                }
-                catch (Spinnaker::Exception& e)
-                {
-                    cout << "Error: " << e.what() << endl;
-                    result = false;
-                }
-            }
-        }
-        // End acquisition for all cameras
-        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        const unsigned int distance = CodecDistance(frame.pixelFormat);
+        if (distance == 0 || frame.imageSize == 0)
         {
-            // Check for any dropped images
-            CIntegerPtr pDroppedImages =
-                camList.GetByIndex(cameraCnt)->GetTLStreamNodeMap().GetNode("StreamDroppedFrameCount");
-            if (IsReadable(pDroppedImages))
-            {
-                if (pDroppedImages->GetValue() > 0)
-                {
-                    missedImageCnts += pDroppedImages->GetValue();
-                    cout << pDroppedImages->GetValue() << " images "
-                         << " missed at camera " << cameraCnt << endl;
-                }
-            }
-            else
-            {
-                cout << "Unable to determine the dropped frame count from the nodemap at camera " << cameraCnt << endl
-                     << endl;
-            }
-            camList.GetByIndex(cameraCnt)->EndAcquisition();
-            cout << "Camera[" << cameraCnt << "]: Stop acquiring images " << endl;
+            skipped++;
+            continue;
         }
-        cout << endl;
 
-        cout << "We missed a total of " << missedImageCnts << " images!" << endl << endl;
+        images.push_back(vector<uint8_t>(data.begin(), data.begin() + static_cast<size_t>(frame.imageSize)));
+        distances.push_back(distance);
     }
-    catch (Spinnaker::Exception& e)
+
+    if (images.empty())
     {
-        cout << "Error: " << e.what() << endl;
-        result = false;
+        cout << "No 8-bit Mono or Bayer frames in " << path << endl;
+        return -1;
     }
 
-    return result;
-}
-
-bool RetrieveImagesFromFiles(unsigned int numCameras, string fileFormat = "bmp")
-{
-    bool result = true;
+    cout << images.size() << " frames of " << path;
+    if (skipped > 0)
+    {
+        cout << " (" << skipped << " frames in other pixel formats skipped)";
+    }
+    cout << ", " << k_codecBenchmarkPasses << " passes" << endl << endl;
 
-    try
+    for (int simd = 0; simd < 2; simd++)
     {
-        // Loop through the saved files for each camera and retrieve the images
-        for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+        if (simd && !FrameCodec::simdAvailable())
         {
-            string tempFilename = imageInfos.at(cameraCnt).imageFileName;
+            cout << "SIMD    : not supported on this processor" << endl;
+            continue;
+        }
 
-            size_t imageSize = imageInfos.at(cameraCnt).imageHeight * imageInfos.at(cameraCnt).imageWidth;
+        double ratio = 0.0;
+        double compressMBps = 0.0;
+        double decompressMBps = 0.0;
+        if (!MeasureCodec(images, distances, simd != 0, ratio, compressMBps, decompressMBps))
+        {
+            cout << "Error: a frame did not decode to the original image" << endl;
+            return -1;
+        }
 
-            cout << "Opening " << tempFilename.c_str() << "..." << endl;
+        cout << (simd ? "SIMD    " : "Scalar  ") << ": ratio " << ratio << ":1, compress " << compressMBps
+             << " MB/s, decompress " << decompressMBps << " MB/s" << endl;
+    }
+    cout << endl;
 
-            std::shared_ptr<fstream> rawFile = imageInfos.at(cameraCnt).imageFile;
+    return 0;
+}
 
-            if (!rawFile->good())
-            {
-                cout << "Error opening file: " << imageInfos.at(cameraCnt).imageFileName.c_str() << " Aborting..."
-                     << endl;
+// Measure the sustained write bandwidth of each directory in MB/s by
+// recording a few frames to it with the selected backend
+vector<double> MeasureDirectoryBandwidth(const vector<string>& directories)
+{
+    vector<double> bandwidth;
 
-                return false;
-            }
+    vector<char> frameData(k_bandwidthProbeFrameSize);
+    FillRandom(frameData);
 
-            cout << "Splitting images" << endl;
-            rawFile->seekg(0);
+    for (size_t dirCnt = 0; dirCnt < directories.size(); dirCnt++)
+    {
+        BackendBenchmarkOptions options;
+        options.directory = directories[dirCnt];
+        options.writers = 1;
+        options.frames = k_bandwidthProbeFrames;
 
-            // Read image into buffer
-            for (int imageCnt = 0; imageCnt < k_numImages; imageCnt++)
-            {
-                string readImageFilename;
+        BackendBenchmarkResult measured = RunBackendBenchmark(options, recordingBackend, frameData);
+        const double seconds = measured.writeSeconds + measured.syncSeconds;
 
-                stringstream sstream;
+        bandwidth.push_back(measured.failed || seconds <= 0.0 ? 0.0 : measured.bytes / 1000000.0 / seconds);
 
-                std::shared_ptr<char> pBuffer(new char[imageSize], std::default_delete<char[]>());
+        cout << "Measured " << bandwidth.back() << " MB/s to '"
+             << (directories[dirCnt].empty() ? "." : directories[dirCnt]) << "'" << endl;
+    }
 
-                rawFile->read(pBuffer.get(), imageSize);
+    return bandwidth;
+}
 
-                // Import image into Image structure
-                ImagePtr pImage = Image::Create(
-                    imageInfos.at(cameraCnt).imageWidth,
-                    imageInfos.at(cameraCnt).imageHeight,
-                    0,
-                    0,
-                    imageInfos.at(cameraCnt).pixelFormat,
-                    pBuffer.get());
+//
+// Decide which files each camera records to
+//
+// *** NOTES ***
+// With --stripe cameras, every camera gets one file in one of the
+// directories: either the next directory in turn, or the one that leaves the
+// most measured bandwidth per camera. With --stripe frames, every camera gets
+// one file in each directory, and each camera spreads blocks of frames over
+// them as it goes (see SelectPiece()).
+//
+bool PlanRecording(unsigned int numCameras)
+{
+    vector<string> directories = destinationDirectories;
+    if (directories.empty())
+    {
+        directories.push_back(kDestinationDirectory);
+    }
 
-                // Create file location and file name
-                sstream << kDestinationDirectory << "camera" << cameraCnt << "_" << imageCnt << "." << fileFormat;
+    // Fail right away if any destination cannot be written to
+    for (size_t dirCnt = 0; dirCnt < directories.size(); dirCnt++)
+    {
+        const string testFile = directories[dirCnt] + "test.txt";
+        FILE* tempFile = fopen(testFile.c_str(), "w+");
+        if (tempFile == nullptr)
+        {
+            cout << "Failed to create file in '" << directories[dirCnt] << "'. Please check permissions." << endl;
+            return false;
+        }
+        fclose(tempFile);
+        remove(testFile.c_str());
+    }
 
-                sstream >> readImageFilename;
+    recordingManifest = RecordingManifest();
+    recordingManifest.stripe = stripeMode == STRIPE_FRAMES ? "frames" : "cameras";
+    recordingManifest.stripeFrames = stripeMode == STRIPE_FRAMES ? stripeFrames : 0;
+    recordingManifest.pieces.resize(numCameras);
 
-                //  Save image to disk
-                pImage->Save(readImageFilename.c_str());
+    vector<double> bandwidth;
+    vector<unsigned int> camerasPerDirectory(directories.size(), 0);
+    if (stripeMode == STRIPE_CAMERAS && stripePolicy == STRIPE_BANDWIDTH && directories.size() > 1)
+    {
+        cout << endl << "*** MEASURING DESTINATION BANDWIDTH ***" << endl << endl;
+        bandwidth = MeasureDirectoryBandwidth(directories);
+    }
 
-                // Check if reading is successful
-                if (!rawFile->good())
-                {
-                    cout << "Error reading from image " << imageCnt << " for camera " << cameraCnt << ". Aborting..."
-                         << endl;
+    for (unsigned int cameraCnt = 0; cameraCnt < numCameras; cameraCnt++)
+    {
+        if (stripeMode == STRIPE_FRAMES && directories.size() > 1)
+        {
+            for (size_t dirCnt = 0; dirCnt < directories.size(); dirCnt++)
+            {
+                stringstream sstream;
+                sstream << directories[dirCnt] << "camera" << cameraCnt << ".piece" << dirCnt << ".tmp";
+                recordingManifest.pieces[cameraCnt].push_back(sstream.str());
+            }
+            continue;
+        }
 
-                    return false;
+        size_t dirCnt = cameraCnt % directories.size();
+        if (!bandwidth.empty())
+        {
+            // The directory whose bandwidth is shared by the fewest cameras
+            double best = -1.0;
+            for (size_t i = 0; i < directories.size(); i++)
+            {
+                const double share = bandwidth[i] / (camerasPerDirectory[i] + 1);
+                if (share > best)
+                {
+                    best = share;
+                    dirCnt = i;
                 }
-
-                cout << "Camera[" << cameraCnt << "]: Retrieved image " << imageCnt << endl;
             }
-
-            cout << endl << endl;
         }
+        camerasPerDirectory[dirCnt]++;
+
+        stringstream sstream;
+        sstream << directories[dirCnt] << "camera" << cameraCnt << ".tmp";
+        recordingManifest.pieces[cameraCnt].push_back(sstream.str());
     }
 
-    catch (Spinnaker::Exception& e)
+    return true;
+}
+
+// Turn a directory given on the command line into a prefix for file names
+string DirectoryPrefix(const string& directory)
+{
+    if (directory.empty() || directory[directory.size() - 1] == '/' || directory[directory.size() - 1] == '\\')
+    {
+        return directory;
+    }
+    return directory + "/";
+}
+
+// Parse "WxH"
+bool ParseFrameSize(const string& text, size_t& width, size_t& height)
+{
+    const size_t separator = text.find('x');
+    if (separator == string::npos)
     {
-        cout << "Error: " << e.what() << endl;
         return false;
     }
-    return result;
+    width = static_cast<size_t>(atol(text.substr(0, separator).c_str()));
+    height = static_cast<size_t>(atol(text.substr(separator + 1).c_str()));
+    return width > 0 && height > 0;
+}
+
+// Print out usage of the application
+void PrintUsage()
+{
+    cout << "Usage: AcquisitionMultipleCamerasWriteToFile [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "--direct              : Write recordings with O_DIRECT into preallocated files (Linux)" << endl;
+    cout << "--dest DIR            : Record to DIR; repeat to spread recordings over several directories" << endl;
+    cout << "--stripe MODE         : 'cameras' puts each camera in one directory (default), 'frames'" << endl;
+    cout << "                        spreads blocks of frames of every camera over all directories" << endl;
+    cout << "--stripe-frames N     : Frames per block with --stripe frames (default: " << k_stripeFrames << ")"
+         << endl;
+    cout << "--stripe-policy P     : 'round-robin' (default) or 'bandwidth' to favor the directories with" << endl;
+    cout << "                        the most measured write bandwidth" << endl;
+    cout << "--images N            : Number of images to grab from each camera (default: " << k_numImages << ")"
+         << endl;
+    cout << "--rotate-mb N         : Start a new segment of each file every N MB" << endl;
+    cout << "--rotate-seconds N    : Start a new segment of each file every N seconds" << endl;
+    cout << "--retain-mb N         : Delete the oldest segments to keep at most N MB of finished segments" << endl;
+    cout << "--compress            : Compress 8-bit Mono and Bayer frames losslessly before recording them" << endl;
+    cout << "--serial-config       : Configure the cameras one at a time instead of all at once" << endl;
+    cout << "--export-threads N    : Threads exporting the recorded images (default: one per processor)" << endl;
+    cout << "--follow PATH         : Print the frames of a recording as another process writes them" << endl;
+    cout << "--benchmark-writes    : Compare fstream and O_DIRECT recording without cameras" << endl;
+    cout << "--benchmark-codec PATH: Measure the frame compression on the frames of a recording" << endl;
+    cout << "--bench-dir DIR       : Directory for the benchmark files (default: current folder)" << endl;
+    cout << "--bench-writers N     : Number of writer threads (default: " << k_benchmarkWriters << ")" << endl;
+    cout << "--bench-frames N      : Frames per writer (default: " << k_benchmarkFrames << ")" << endl;
+    cout << "--bench-size WxH      : Frame size in 8-bit pixels (default: " << k_benchmarkWidth << "x"
+         << k_benchmarkHeight << ")" << endl;
+    cout << "--help                : Print usage information" << endl;
+    cout << endl;
 }
+
 // This function acts as the body of the example; please see NodeMapInfo example
 // for more in-depth comments on setting up cameras.
 int RunCameras(CameraList& camList, unsigned int numCameras)
@@ -428,7 +2686,7 @@ int RunCameras(CameraList& camList, unsigned int numCameras)
 
     try
     {
-        // Retrieve TL device nodemap, print device information, and initialize camera
+        // Retrieve TL device nodemap and print device information
         for (unsigned int i = 0; i < numCameras; i++)
         {
             cout << endl << "Printing device info for camera " << i << "..." << endl;
@@ -436,10 +2694,12 @@ int RunCameras(CameraList& camList, unsigned int numCameras)
             INodeMap& nodeMapTLDevice = camList.GetByIndex(i)->GetTLDeviceNodeMap();
 
             result = PrintDeviceInfo(nodeMapTLDevice);
+        }
 
-            cout << endl << "Initializing camera " << i << "..." << endl;
-
-            camList.GetByIndex(i)->Init();
+        // Decide where each camera records to
+        if (!PlanRecording(numCameras))
+        {
+            return -1;
         }
 
         // Create files to write
@@ -449,7 +2709,7 @@ int RunCameras(CameraList& camList, unsigned int numCameras)
             return -1;
         }
 
-        // Configure each of the cameras before starting the acquisition
+        // Initialize and configure all of the cameras before starting the acquisition
         if (!ConfigureCameras(camList, numCameras))
         {
             return -1;
@@ -487,8 +2747,131 @@ int RunCameras(CameraList& camList, unsigned int numCameras)
 
 // Example entry point; please see Enumeration example for more in-depth
 // comments on preparing and cleaning up the system.
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
+    bool benchmarkWrites = false;
+    BackendBenchmarkOptions benchmarkOptions;
+    string followPath;
+    string codecBenchmarkPath;
+
+    // Change arguments to string for easy read
+    vector<string> args(argv, argv + argc);
+
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        const bool hasValue = i + 1 < args.size();
+
+        if (args[i] == "--direct")
+        {
+            recordingBackend = RECORDING_BACKEND_DIRECT;
+        }
+        else if (args[i] == "--benchmark-writes")
+        {
+            benchmarkWrites = true;
+        }
+        else if (args[i] == "--dest" && hasValue)
+        {
+            destinationDirectories.push_back(DirectoryPrefix(args[++i]));
+        }
+        else if (args[i] == "--stripe" && hasValue && (args[i + 1] == "cameras" || args[i + 1] == "frames"))
+        {
+            stripeMode = args[++i] == "frames" ? STRIPE_FRAMES : STRIPE_CAMERAS;
+        }
+        else if (args[i] == "--stripe-frames" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            stripeFrames = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (
+            args[i] == "--stripe-policy" && hasValue && (args[i + 1] == "round-robin" || args[i + 1] == "bandwidth"))
+        {
+            stripePolicy = args[++i] == "bandwidth" ? STRIPE_BANDWIDTH : STRIPE_ROUND_ROBIN;
+        }
+        else if (args[i] == "--images" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            numImages = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--rotate-mb" && hasValue && atof(args[i + 1].c_str()) > 0.0)
+        {
+            rotateBytes = static_cast<uint64_t>(atof(args[++i].c_str()) * 1000000.0);
+        }
+        else if (args[i] == "--rotate-seconds" && hasValue && atof(args[i + 1].c_str()) > 0.0)
+        {
+            rotateSeconds = atof(args[++i].c_str());
+        }
+        else if (args[i] == "--retain-mb" && hasValue && atof(args[i + 1].c_str()) > 0.0)
+        {
+            retainBytes = static_cast<uint64_t>(atof(args[++i].c_str()) * 1000000.0);
+        }
+        else if (args[i] == "--compress")
+        {
+            compressFrames = true;
+        }
+        else if (args[i] == "--benchmark-codec" && hasValue)
+        {
+            codecBenchmarkPath = args[++i];
+        }
+        else if (args[i] == "--serial-config")
+        {
+            serialConfiguration = true;
+        }
+        else if (args[i] == "--export-threads" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            exportThreads = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--follow" && hasValue)
+        {
+            followPath = args[++i];
+        }
+        else if (args[i] == "--bench-dir" && hasValue)
+        {
+            benchmarkOptions.directory = DirectoryPrefix(args[++i]);
+        }
+        else if (args[i] == "--bench-writers" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            benchmarkOptions.writers = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--bench-frames" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            benchmarkOptions.frames = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--bench-size" && hasValue &&
+                 ParseFrameSize(args[i + 1], benchmarkOptions.width, benchmarkOptions.height))
+        {
+            i++;
+        }
+        else
+        {
+            PrintUsage();
+            return args[i] == "--help" ? 0 : -1;
+        }
+    }
+
+    if (retainBytes > 0 && !RotationEnabled())
+    {
+        cout << "--retain-mb needs --rotate-mb or --rotate-seconds" << endl;
+        return -1;
+    }
+
+    // The benchmark needs no cameras
+    if (benchmarkWrites)
+    {
+        return BenchmarkRecordingBackends(benchmarkOptions);
+    }
+
+    if (!codecBenchmarkPath.empty())
+    {
+        return BenchmarkCodec(codecBenchmarkPath);
+    }
+
+    // Neither does following a recording written by another process
+    if (!followPath.empty())
+    {
+        AsyncLog::start();
+        const int followResult = FollowRecording(followPath);
+        AsyncLog::stop();
+        return followResult;
+    }
+
     // Since this application saves images in the current folder
     // we must ensure that we have permission to write to this folder.
     // If we do not have permission, fail right away.
@@ -543,8 +2926,11 @@ int main(int /*argc*/, char** /*argv*/)
         return -1;
     }
 
-    // Run example on all cameras
+    // Run example on all cameras, printing the messages of its threads
+    // while they run
+    AsyncLog::start();
     result = result | RunCameras(camList, numCameras);
+    AsyncLog::stop();
 
     // Clear camera list before releasing system
     camList.Clear();
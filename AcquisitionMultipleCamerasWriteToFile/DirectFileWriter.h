@@ -0,0 +1,308 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief DirectFileWriter.h is an append-only file writer that bypasses the
+ *  page cache, used by the recordings of the
+ *  AcquisitionMultipleCamerasWriteToFile example.
+ *
+ *  The file is opened with O_DIRECT, so data goes from the writer's buffer
+ *  straight to the disk instead of piling up as dirty pages that the kernel
+ *  later writes back in bursts. O_DIRECT requires every write to start at an
+ *  aligned offset, cover a whole number of blocks and come from an aligned
+ *  buffer, so appended bytes are gathered in an aligned staging buffer that
+ *  is written out whenever it fills up. The file is extended with fallocate
+ *  well ahead of the data, so the file system allocates large contiguous
+ *  extents and does not update its metadata on every write.
+ *
+ *  File systems that do not support O_DIRECT (tmpfs, for example) are written
+ *  through the page cache with the same aligned writes; isDirect() tells which
+ *  one is in use. Only Linux is supported.
+ */
+
+#ifndef DIRECT_FILE_WRITER_H
+#define DIRECT_FILE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Offset, size and buffer alignment required for O_DIRECT writes
+#define DIRECT_IO_ALIGNMENT 4096
+
+// Size of the staging buffer, and so of most writes
+#define DIRECT_STAGING_SIZE (4 * 1024 * 1024)
+
+// How far ahead of the data the file is allocated
+#define DIRECT_PREALLOCATE_SIZE (256ull * 1024 * 1024)
+
+class DirectFileWriter
+{
+  public:
+    DirectFileWriter()
+        : m_fd(-1), m_staging(NULL), m_head(NULL), m_staged(0), m_flushed(0), m_allocated(0), m_direct(false),
+          m_failed(false), m_headDirty(false)
+    {
+    }
+
+    ~DirectFileWriter()
+    {
+        close();
+        free(m_staging);
+        free(m_head);
+    }
+
+    bool open(const std::string& path)
+    {
+        close();
+
+        m_staged = 0;
+        m_flushed = 0;
+        m_allocated = 0;
+        m_failed = false;
+        m_headDirty = false;
+
+#if defined(__linux__)
+        if ((m_staging == NULL && posix_memalign(&m_staging, DIRECT_IO_ALIGNMENT, DIRECT_STAGING_SIZE) != 0) ||
+            (m_head == NULL && posix_memalign(&m_head, DIRECT_IO_ALIGNMENT, DIRECT_IO_ALIGNMENT) != 0))
+        {
+            return false;
+        }
+
+        m_direct = true;
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (m_fd < 0 && errno == EINVAL)
+        {
+            m_direct = false;
+            m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+#endif
+        return m_fd >= 0;
+    }
+
+    // Append bytes at the end of the file
+    bool append(const void* data, size_t size)
+    {
+        const char* source = static_cast<const char*>(data);
+
+        while (size > 0 && !m_failed)
+        {
+            const size_t count = size < DIRECT_STAGING_SIZE - m_staged ? size : DIRECT_STAGING_SIZE - m_staged;
+            memcpy(static_cast<char*>(m_staging) + m_staged, source, count);
+            m_staged += count;
+            source += count;
+            size -= count;
+
+            if (m_staged == DIRECT_STAGING_SIZE)
+            {
+                flushStaging(DIRECT_STAGING_SIZE);
+                m_flushed += DIRECT_STAGING_SIZE;
+                m_staged = 0;
+            }
+        }
+
+        return m_fd >= 0 && !m_failed;
+    }
+
+    // Overwrite the first bytes of the file, which must already have been
+    // appended; used to finalize a file header
+    bool rewriteHead(const void* data, size_t size)
+    {
+        if (m_fd < 0 || size > DIRECT_IO_ALIGNMENT || size > m_flushed + m_staged)
+        {
+            return false;
+        }
+
+        if (m_flushed == 0)
+        {
+            memcpy(m_staging, data, size);
+        }
+        else
+        {
+            memcpy(m_head, data, size);
+            m_headDirty = true;
+        }
+        return true;
+    }
+
+    // Overwrite the first bytes of the file on disk right away, so readers of
+    // the file see them while it is still being written; only possible once
+    // the first block has been written
+    bool publishHead(const void* data, size_t size)
+    {
+        if (m_fd < 0 || m_flushed == 0 || size > DIRECT_IO_ALIGNMENT)
+        {
+            return false;
+        }
+
+        memcpy(m_head, data, size);
+        writeAt(m_head, DIRECT_IO_ALIGNMENT, 0);
+        m_headDirty = false;
+        return !m_failed;
+    }
+
+    // Write what is left, drop the padding and the unused preallocated space
+    // and close the file; returns false if any write failed
+    bool close()
+    {
+        if (m_fd < 0)
+        {
+            return false;
+        }
+
+        const uint64_t size = m_flushed + m_staged;
+
+        if (m_staged > 0)
+        {
+            const size_t padded = (m_staged + DIRECT_IO_ALIGNMENT - 1) & ~static_cast<size_t>(DIRECT_IO_ALIGNMENT - 1);
+            memset(static_cast<char*>(m_staging) + m_staged, 0, padded - m_staged);
+            flushStaging(padded);
+        }
+
+        if (m_headDirty)
+        {
+            writeAt(m_head, DIRECT_IO_ALIGNMENT, 0);
+        }
+
+#if defined(__linux__)
+        if (ftruncate(m_fd, static_cast<off_t>(size)) != 0 || ::close(m_fd) != 0)
+        {
+            m_failed = true;
+        }
+#endif
+        m_fd = -1;
+        return !m_failed;
+    }
+
+    bool isOpen() const
+    {
+        return m_fd >= 0;
+    }
+
+    // True if the page cache is bypassed
+    bool isDirect() const
+    {
+        return m_direct;
+    }
+
+    uint64_t size() const
+    {
+        return m_flushed + m_staged;
+    }
+
+    // Bytes already written to disk; the rest is still staged
+    uint64_t flushedSize() const
+    {
+        return m_flushed;
+    }
+
+  private:
+    // Write the first size bytes of the staging buffer at the end of the
+    // flushed data; size is a multiple of the alignment
+    void flushStaging(size_t size)
+    {
+        preallocate(m_flushed + size);
+
+        if (m_flushed == 0)
+        {
+            // Keep the first block, so the header can be rewritten on close
+            memcpy(m_head, m_staging, DIRECT_IO_ALIGNMENT);
+        }
+
+        writeAt(m_staging, size, m_flushed);
+    }
+
+    void writeAt(const void* data, size_t size, uint64_t offset)
+    {
+#if defined(__linux__)
+        const char* source = static_cast<const char*>(data);
+
+        while (size > 0 && !m_failed)
+        {
+            const ssize_t written = pwrite(m_fd, source, size, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                m_failed = true;
+                break;
+            }
+            source += written;
+            offset += static_cast<uint64_t>(written);
+            size -= static_cast<size_t>(written);
+        }
+#else
+        (void)data;
+        (void)size;
+        (void)offset;
+        m_failed = true;
+#endif
+    }
+
+    // Allocate the file in large steps ahead of the data. Only a full disk is
+    // an error; without fallocate support the file just grows as it is written.
+    void preallocate(uint64_t end)
+    {
+#if defined(__linux__)
+        if (end <= m_allocated)
+        {
+            return;
+        }
+
+        // Near the end of the disk, fall back to allocating just what is needed
+        const uint64_t lengths[2] = {end - m_allocated + DIRECT_PREALLOCATE_SIZE, end - m_allocated};
+        for (int i = 0; i < 2; i++)
+        {
+            if (fallocate(m_fd, 0, static_cast<off_t>(m_allocated), static_cast<off_t>(lengths[i])) == 0)
+            {
+                m_allocated += lengths[i];
+                return;
+            }
+            if (errno != ENOSPC && errno != EFBIG)
+            {
+                m_allocated = UINT64_MAX;
+                return;
+            }
+        }
+        m_failed = true;
+#else
+        (void)end;
+#endif
+    }
+
+    int m_fd;
+    void* m_staging;
+    void* m_head;
+    size_t m_staged;
+    uint64_t m_flushed;
+    uint64_t m_allocated;
+    bool m_direct;
+    bool m_failed;
+    bool m_headDirty;
+};
+
+#endif // DIRECT_FILE_WRITER_H
@@ -0,0 +1,372 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief FrameCodec.h is a fast lossless codec for 8-bit images, used to
+ *  compress frames on the host before they are recorded by the
+ *  AcquisitionMultipleCamerasWriteToFile example.
+ *
+ *  Each pixel is predicted from the previous pixel of the same color: the
+ *  one just before it for Mono8, two before it for Bayer 8-bit formats. The
+ *  prediction errors are mapped to small unsigned values (zigzag) and packed
+ *  in groups of 16: a group stores only as many bit planes as its largest
+ *  value needs, from none for a flat area up to 8 for noise. Each bit plane
+ *  is 16 bits, one per pixel of the group.
+ *
+ *  Encoded data is laid out as:
+ *
+ *    1 byte        prediction distance
+ *    for every two groups of 16 pixels:
+ *      1 byte      bit planes of the first (low nibble) and second group
+ *      2 bytes     per bit plane of the first group, then of the second
+ *    the last size % 16 pixels, unencoded
+ *
+ *  Every step maps directly onto 16-byte vectors: encoding uses SSE2 and
+ *  decoding SSSE3 when the processor has it, and both fall back to plain
+ *  code producing the same bytes otherwise.
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAME_CODEC_X86
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#endif
+
+// How the image data of a recorded frame is stored
+#define FRAME_CODEC_NONE 0
+#define FRAME_CODEC_DELTA_PACK 1
+
+namespace FrameCodec
+{
+// Largest number of bytes encode() writes for size bytes of image
+inline size_t maxEncodedSize(size_t size)
+{
+    return 1 + (size / 16 + 1) / 2 + size;
+}
+
+// Whether encode() and decode() can use vector instructions
+inline bool simdAvailable()
+{
+#if defined(FRAME_CODEC_X86)
+    return __builtin_cpu_supports("ssse3") != 0;
+#else
+    return false;
+#endif
+}
+
+// Number of bits needed for value
+inline unsigned int bitWidth(unsigned int value)
+{
+    unsigned int bits = 0;
+    while (value >> bits)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+// Residuals of the 16 pixels starting at base, zigzag coded
+inline void residuals(const uint8_t* src, size_t base, unsigned int distance, uint8_t* z)
+{
+    for (unsigned int j = 0; j < 16; j++)
+    {
+        const size_t i = base + j;
+        const uint8_t r = static_cast<uint8_t>(src[i] - (i >= distance ? src[i - distance] : 0));
+
+        // Unsigned arithmetic only; shifting a negative value is undefined
+        z[j] = static_cast<uint8_t>((r << 1) ^ (0u - (r >> 7)));
+    }
+}
+
+// Encode one group from its residuals
+inline uint8_t* packGroup(const uint8_t* z, uint8_t* out, unsigned int& bits)
+{
+    unsigned int any = 0;
+    for (unsigned int j = 0; j < 16; j++)
+    {
+        any |= z[j];
+    }
+    bits = bitWidth(any);
+
+    for (unsigned int k = 0; k < bits; k++)
+    {
+        unsigned int plane = 0;
+        for (unsigned int j = 0; j < 16; j++)
+        {
+            plane |= ((z[j] >> k) & 1u) << j;
+        }
+        out[0] = static_cast<uint8_t>(plane);
+        out[1] = static_cast<uint8_t>(plane >> 8);
+        out += 2;
+    }
+    return out;
+}
+
+#if defined(FRAME_CODEC_X86)
+// Encode one group with SSE2
+__attribute__((target("sse2"))) inline uint8_t* packGroupSse2(
+    const uint8_t* src,
+    size_t base,
+    unsigned int distance,
+    uint8_t* out,
+    unsigned int& bits)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i r;
+    if (base >= distance)
+    {
+        r = _mm_sub_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + base)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + base - distance)));
+    }
+    else
+    {
+        uint8_t z[16];
+        residuals(src, base, distance, z);
+        return packGroup(z, out, bits);
+    }
+
+    const __m128i z = _mm_xor_si128(_mm_add_epi8(r, r), _mm_cmpgt_epi8(zero, r));
+
+    // movemask takes the top bit of every byte, so shift bit k up to it
+    unsigned int planes[8];
+    planes[0] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 7)));
+    planes[1] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 6)));
+    planes[2] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 5)));
+    planes[3] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 4)));
+    planes[4] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 3)));
+    planes[5] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 2)));
+    planes[6] = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(z, 1)));
+    planes[7] = static_cast<unsigned int>(_mm_movemask_epi8(z));
+
+    bits = 8;
+    while (bits > 0 && planes[bits - 1] == 0)
+    {
+        bits--;
+    }
+
+    for (unsigned int k = 0; k < bits; k++)
+    {
+        out[0] = static_cast<uint8_t>(planes[k]);
+        out[1] = static_cast<uint8_t>(planes[k] >> 8);
+        out += 2;
+    }
+    return out;
+}
+#endif
+
+//
+// Encode size bytes of image; returns the number of bytes written to dst,
+// which must hold maxEncodedSize(size)
+//
+// *** NOTES ***
+// distance is 1 for Mono8 and 2 for Bayer 8-bit formats, so pixels are
+// predicted from the previous pixel of the same color. simd selects the
+// vector code where there is one; the output is the same either way.
+//
+inline size_t encode(const uint8_t* src, size_t size, unsigned int distance, uint8_t* dst, bool simd = true)
+{
+    uint8_t* out = dst;
+    *out++ = static_cast<uint8_t>(distance);
+
+#if defined(FRAME_CODEC_X86)
+    simd = simd && simdAvailable();
+#else
+    (void)simd;
+#endif
+
+    const size_t groups = size / 16;
+    for (size_t group = 0; group < groups; group += 2)
+    {
+        uint8_t* widths = out++;
+        *widths = 0;
+
+        for (size_t half = 0; half < 2 && group + half < groups; half++)
+        {
+            const size_t base = (group + half) * 16;
+            unsigned int bits = 0;
+
+#if defined(FRAME_CODEC_X86)
+            if (simd)
+            {
+                out = packGroupSse2(src, base, distance, out, bits);
+            }
+            else
+#endif
+            {
+                uint8_t z[16];
+                residuals(src, base, distance, z);
+                out = packGroup(z, out, bits);
+            }
+
+            *widths = static_cast<uint8_t>(*widths | (bits << (4 * half)));
+        }
+    }
+
+    // The pixels that do not fill a group are stored as they are
+    memcpy(out, src + groups * 16, size - groups * 16);
+    out += size - groups * 16;
+
+    return static_cast<size_t>(out - dst);
+}
+
+// Decode one group into dst + base; the pixels before it are already decoded
+inline void unpackGroup(const uint8_t* in, unsigned int bits, uint8_t* dst, size_t base, unsigned int distance)
+{
+    uint8_t z[16] = {0};
+    for (unsigned int k = 0; k < bits; k++)
+    {
+        const unsigned int plane = in[2 * k] | (in[2 * k + 1] << 8);
+        for (unsigned int j = 0; j < 16; j++)
+        {
+            z[j] = static_cast<uint8_t>(z[j] | (((plane >> j) & 1u) << k));
+        }
+    }
+
+    for (unsigned int j = 0; j < 16; j++)
+    {
+        const size_t i = base + j;
+        const uint8_t r = static_cast<uint8_t>((z[j] >> 1) ^ (0u - (z[j] & 1u)));
+        dst[i] = static_cast<uint8_t>(r + (i >= distance ? dst[i - distance] : 0));
+    }
+}
+
+#if defined(FRAME_CODEC_X86)
+// Decode one group with SSSE3; the running sums only vectorize for the
+// distances used for Mono8 and Bayer
+__attribute__((target("ssse3"))) inline void unpackGroupSsse3(
+    const uint8_t* in,
+    unsigned int bits,
+    uint8_t* dst,
+    size_t base,
+    unsigned int distance)
+{
+    if ((distance != 1 && distance != 2) || base < distance)
+    {
+        unpackGroup(in, bits, dst, base, distance);
+        return;
+    }
+
+    // Spread the two bytes of a plane over the low and high half, then pick
+    // each pixel's bit
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    __m128i z = _mm_setzero_si128();
+    for (unsigned int k = 0; k < bits; k++)
+    {
+        const short bitsOfPlane = static_cast<short>(in[2 * k] | (in[2 * k + 1] << 8));
+        const __m128i plane = _mm_shuffle_epi8(_mm_set1_epi16(bitsOfPlane), spread);
+        const __m128i set = _mm_cmpeq_epi8(_mm_and_si128(plane, select), select);
+        z = _mm_or_si128(z, _mm_and_si128(set, _mm_set1_epi8(static_cast<char>(1 << k))));
+    }
+
+    // Undo the zigzag coding
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i r = _mm_xor_si128(
+        _mm_and_si128(_mm_srli_epi16(z, 1), _mm_set1_epi8(0x7F)),
+        _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(z, one)));
+
+    // Running sums of every distance-th residual, then add the last decoded
+    // pixel of each color
+    __m128i carry;
+    if (distance == 1)
+    {
+        r = _mm_add_epi8(r, _mm_slli_si128(r, 1));
+        carry = _mm_set1_epi8(static_cast<char>(dst[base - 1]));
+    }
+    else
+    {
+        carry = _mm_set1_epi16(static_cast<short>(dst[base - 2] | (dst[base - 1] << 8)));
+    }
+    r = _mm_add_epi8(r, _mm_slli_si128(r, 2));
+    r = _mm_add_epi8(r, _mm_slli_si128(r, 4));
+    r = _mm_add_epi8(r, _mm_slli_si128(r, 8));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + base), _mm_add_epi8(r, carry));
+}
+#endif
+
+// Decode what encode() produced into size bytes at dst; returns false if the
+// encoded data is malformed
+inline bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size, bool simd = true)
+{
+    if (srcSize < 1 || src[0] == 0)
+    {
+        return false;
+    }
+
+    const unsigned int distance = src[0];
+    const uint8_t* in = src + 1;
+    const uint8_t* end = src + srcSize;
+
+#if defined(FRAME_CODEC_X86)
+    simd = simd && simdAvailable();
+#else
+    (void)simd;
+#endif
+
+    const size_t groups = size / 16;
+    for (size_t group = 0; group < groups; group += 2)
+    {
+        if (in >= end)
+        {
+            return false;
+        }
+        const unsigned int widths = *in++;
+
+        for (size_t half = 0; half < 2 && group + half < groups; half++)
+        {
+            const unsigned int bits = (widths >> (4 * half)) & 0xF;
+            if (bits > 8 || static_cast<size_t>(end - in) < 2 * bits)
+            {
+                return false;
+            }
+
+#if defined(FRAME_CODEC_X86)
+            if (simd)
+            {
+                unpackGroupSsse3(in, bits, dst, (group + half) * 16, distance);
+            }
+            else
+#endif
+            {
+                unpackGroup(in, bits, dst, (group + half) * 16, distance);
+            }
+            in += 2 * bits;
+        }
+    }
+
+    const size_t tail = size - groups * 16;
+    if (static_cast<size_t>(end - in) != tail)
+    {
+        return false;
+    }
+    memcpy(dst + groups * 16, in, tail);
+    return true;
+}
+} // namespace FrameCodec
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,977 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief FrameRecording.h defines the multi-frame recording container
+ *  written and read by the AcquisitionMultipleCamerasWriteToFile example.
+ *
+ *  A recording is a file header, one record per frame and a trailing index:
+ *
+ *    file header   64 bytes   magic "SREC", version, index offset, frame count
+ *    frame record             64 byte frame header followed by the image data
+ *    ...
+ *    index                    32 bytes per frame: FrameID, timestamp, record
+ *                             offset and image status
+ *
+ *  Each frame header carries the FrameID, the timestamp, the image size,
+ *  width, height, pixel format and image status, so frames of any size or
+ *  format, including incomplete ones, can be replayed. It also tells how the
+ *  image data is stored: as it is, or compressed with FrameCodec.h, in which
+ *  case it also carries the size of the decoded image. The index is written
+ *  when the recording is closed and its offset is stored in the file header;
+ *  a reader can then go straight to frame N, or binary search the timestamps
+ *  for a time range, without reading any image data. A recording that was
+ *  never closed has no index and is recovered by walking the frame headers.
+ *
+ *  While a recording is written, the frame count in the file header is kept
+ *  up to date: it is raised with a single atomic 64-bit store once frames are
+ *  complete in the file, so another process can follow the recording as it
+ *  grows (see RecordingTailReader.h). Version 1 recordings only set the
+ *  frame count on close.
+ *
+ *  All values are stored little-endian.
+ *
+ *  A recording is written either through std::ofstream or, for sustained
+ *  high data rates, with DirectFileWriter, which bypasses the page cache.
+ *  Both produce the same file.
+ *
+ *  One logical recording of a camera may be striped over several such files
+ *  (pieces), typically on different drives. A RecordingManifest lists the
+ *  pieces of every camera, and a RecordingSet reads the pieces of one camera
+ *  back as a single recording, in timestamp order.
+ */
+
+#ifndef FRAME_RECORDING_H
+#define FRAME_RECORDING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DirectFileWriter.h"
+#include "FrameCodec.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define RECORDING_MAGIC 0x43455253u        // "SREC"
+#define RECORDING_FRAME_MAGIC 0x454D5246u  // "FRME"
+#define RECORDING_VERSION 3
+#define RECORDING_HEADER_SIZE 64
+#define RECORDING_FRAME_COUNT_OFFSET 24
+#define RECORDING_FRAME_HEADER_SIZE 64
+#define RECORDING_INDEX_ENTRY_SIZE 32
+#define RECORDING_MANIFEST_NAME "recording.manifest"
+#define RECORDING_MANIFEST_VERSION 1
+
+// Image status stored for a frame that arrived complete
+#define RECORDING_STATUS_COMPLETE 0
+
+// How a recording is written to disk
+enum RecordingBackend
+{
+    RECORDING_BACKEND_STREAM, // std::ofstream, through the page cache
+    RECORDING_BACKEND_DIRECT  // DirectFileWriter, O_DIRECT with preallocated extents
+};
+
+// Everything known about one recorded frame
+struct RecordedFrame
+{
+    uint64_t frameId;
+    uint64_t timestamp;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixelFormat;
+    uint32_t status;
+
+    // Bytes of image data stored in the file
+    uint64_t dataSize;
+
+    // How the image data is stored (FRAME_CODEC_*) and its size once decoded
+    uint32_t codec;
+    uint64_t imageSize;
+
+    // Offset of the frame header in the file
+    uint64_t offset;
+
+    RecordedFrame()
+        : frameId(0), timestamp(0), width(0), height(0), pixelFormat(0), status(RECORDING_STATUS_COMPLETE),
+          dataSize(0), codec(FRAME_CODEC_NONE), imageSize(0), offset(0)
+    {
+    }
+
+    bool isComplete() const
+    {
+        return status == RECORDING_STATUS_COMPLETE;
+    }
+};
+
+namespace RecordingFormat
+{
+inline void put32(uint8_t* p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline void put64(uint8_t* p, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline uint32_t get32(const uint8_t* p)
+{
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline uint64_t get64(const uint8_t* p)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline void encodeFileHeader(uint8_t* p, uint64_t indexOffset, uint64_t frameCount)
+{
+    std::fill(p, p + RECORDING_HEADER_SIZE, static_cast<uint8_t>(0));
+    put32(p, RECORDING_MAGIC);
+    put32(p + 4, RECORDING_VERSION);
+    put32(p + 8, RECORDING_HEADER_SIZE);
+    put32(p + 12, RECORDING_FRAME_HEADER_SIZE);
+    put64(p + 16, indexOffset);
+    put64(p + RECORDING_FRAME_COUNT_OFFSET, frameCount);
+}
+
+inline void encodeFrameHeader(uint8_t* p, const RecordedFrame& frame)
+{
+    std::fill(p, p + RECORDING_FRAME_HEADER_SIZE, static_cast<uint8_t>(0));
+    put32(p, RECORDING_FRAME_MAGIC);
+    put32(p + 4, frame.status);
+    put64(p + 8, frame.frameId);
+    put64(p + 16, frame.timestamp);
+    put32(p + 24, frame.width);
+    put32(p + 28, frame.height);
+    put32(p + 32, frame.pixelFormat);
+    put32(p + 36, frame.codec);
+    put64(p + 40, frame.dataSize);
+    put64(p + 48, frame.codec == FRAME_CODEC_NONE ? frame.dataSize : frame.imageSize);
+}
+
+inline bool decodeFrameHeader(const uint8_t* p, uint64_t offset, RecordedFrame& frame)
+{
+    if (get32(p) != RECORDING_FRAME_MAGIC)
+    {
+        return false;
+    }
+    frame.status = get32(p + 4);
+    frame.frameId = get64(p + 8);
+    frame.timestamp = get64(p + 16);
+    frame.width = get32(p + 24);
+    frame.height = get32(p + 28);
+    frame.pixelFormat = get32(p + 32);
+    frame.codec = get32(p + 36);
+    frame.dataSize = get64(p + 40);
+    frame.imageSize = frame.codec == FRAME_CODEC_NONE ? frame.dataSize : get64(p + 48);
+    frame.offset = offset;
+    return true;
+}
+
+// Decode the image data of a frame as stored in the file into
+// frame.imageSize bytes at image
+inline bool decodeImage(const RecordedFrame& frame, const void* data, void* image)
+{
+    if (frame.codec == FRAME_CODEC_NONE)
+    {
+        memcpy(image, data, static_cast<size_t>(frame.dataSize));
+        return true;
+    }
+
+    return frame.codec == FRAME_CODEC_DELTA_PACK &&
+           FrameCodec::decode(
+               static_cast<const uint8_t*>(data),
+               static_cast<size_t>(frame.dataSize),
+               static_cast<uint8_t*>(image),
+               static_cast<size_t>(frame.imageSize));
+}
+
+inline void encodeIndexEntry(uint8_t* p, const RecordedFrame& frame)
+{
+    put64(p, frame.frameId);
+    put64(p + 8, frame.timestamp);
+    put64(p + 16, frame.offset);
+    put32(p + 24, frame.status);
+    put32(p + 28, 0);
+}
+} // namespace RecordingFormat
+
+//
+// Writes frames to a recording
+//
+// *** NOTES ***
+// The index is kept in memory while recording (32 bytes per frame) and is
+// written, together with the final file header, by close(). Only one thread
+// may use a writer at a time.
+//
+// Each frame is published once it is complete in the file, by raising the
+// frame count in the file header. With std::ofstream the file is flushed
+// after every frame and the count is stored through a shared mapping of the
+// header, with one atomic store. With DirectFileWriter frames only reach the
+// file when the staging buffer is written, so the header block is rewritten
+// after that, with the count of the frames that made it.
+//
+class RecordingWriter
+{
+  public:
+    RecordingWriter()
+        : m_backend(RECORDING_BACKEND_STREAM), m_offset(0), m_published(0), m_publishFd(-1), m_publishMap(NULL),
+          m_failed(false)
+    {
+    }
+
+    ~RecordingWriter()
+    {
+        close();
+    }
+
+    bool open(const std::string& path, RecordingBackend backend = RECORDING_BACKEND_STREAM)
+    {
+        close();
+
+        m_backend = backend;
+        if (m_backend == RECORDING_BACKEND_DIRECT)
+        {
+            m_failed = !m_direct.open(path);
+        }
+        else
+        {
+            m_file.open(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            m_failed = !m_file.is_open();
+        }
+        m_index.clear();
+        m_published = 0;
+
+        // The header is rewritten with the index location on close()
+        uint8_t header[RECORDING_HEADER_SIZE];
+        RecordingFormat::encodeFileHeader(header, 0, 0);
+        write(header, sizeof(header));
+        m_offset = RECORDING_HEADER_SIZE;
+
+        if (m_backend == RECORDING_BACKEND_STREAM && good())
+        {
+            m_file.flush();
+            mapHeader(path);
+        }
+
+        return good();
+    }
+
+    // Append one frame; frame.dataSize bytes are taken from data
+    bool writeFrame(RecordedFrame frame, const void* data)
+    {
+        frame.offset = m_offset;
+
+        uint8_t header[RECORDING_FRAME_HEADER_SIZE];
+        RecordingFormat::encodeFrameHeader(header, frame);
+        write(header, sizeof(header));
+        write(data, static_cast<size_t>(frame.dataSize));
+
+        if (!good())
+        {
+            return false;
+        }
+
+        m_offset += RECORDING_FRAME_HEADER_SIZE + frame.dataSize;
+        m_index.push_back(frame);
+        publish();
+        return good();
+    }
+
+    // Write the index and the final header; returns false if any write failed
+    bool close()
+    {
+        if (!isOpen())
+        {
+            return false;
+        }
+
+        unmapHeader();
+
+        std::vector<uint8_t> index(m_index.size() * RECORDING_INDEX_ENTRY_SIZE);
+        for (size_t i = 0; i < m_index.size(); i++)
+        {
+            RecordingFormat::encodeIndexEntry(&index[i * RECORDING_INDEX_ENTRY_SIZE], m_index[i]);
+        }
+        if (!index.empty())
+        {
+            write(&index[0], index.size());
+        }
+
+        uint8_t header[RECORDING_HEADER_SIZE];
+        RecordingFormat::encodeFileHeader(header, m_offset, m_index.size());
+
+        bool result = !m_failed;
+        if (m_backend == RECORDING_BACKEND_DIRECT)
+        {
+            result = result && m_direct.rewriteHead(header, sizeof(header));
+            result = m_direct.close() && result;
+        }
+        else
+        {
+            m_file.seekp(0);
+            write(header, sizeof(header));
+            m_file.close();
+            result = !m_failed && !m_file.fail();
+        }
+
+        m_failed = false;
+        return result;
+    }
+
+    bool good() const
+    {
+        return isOpen() && !m_failed;
+    }
+
+    // True if the recording bypasses the page cache
+    bool isDirect() const
+    {
+        return m_backend == RECORDING_BACKEND_DIRECT && m_direct.isDirect();
+    }
+
+    uint64_t frameCount() const
+    {
+        return m_index.size();
+    }
+
+    // Frames a reader of the file can already see
+    uint64_t publishedFrameCount() const
+    {
+        return m_published;
+    }
+
+    // Size of the file, including the index once it has been closed
+    uint64_t fileSize() const
+    {
+        return m_offset + (isOpen() ? 0 : m_index.size() * RECORDING_INDEX_ENTRY_SIZE);
+    }
+
+  private:
+    bool isOpen() const
+    {
+        return m_backend == RECORDING_BACKEND_DIRECT ? m_direct.isOpen() : m_file.is_open();
+    }
+
+    // Map the file header, to publish the frame count with atomic stores.
+    // Without it frames are only seen once the recording is closed.
+    void mapHeader(const std::string& path)
+    {
+#if defined(__linux__)
+        m_publishFd = ::open(path.c_str(), O_RDWR);
+        if (m_publishFd < 0)
+        {
+            return;
+        }
+
+        void* map = mmap(NULL, RECORDING_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_publishFd, 0);
+        if (map == MAP_FAILED)
+        {
+            unmapHeader();
+            return;
+        }
+        m_publishMap = map;
+#else
+        (void)path;
+#endif
+    }
+
+    void unmapHeader()
+    {
+#if defined(__linux__)
+        if (m_publishMap != NULL)
+        {
+            munmap(m_publishMap, RECORDING_HEADER_SIZE);
+            m_publishMap = NULL;
+        }
+        if (m_publishFd >= 0)
+        {
+            ::close(m_publishFd);
+            m_publishFd = -1;
+        }
+#endif
+    }
+
+    // Raise the frame count in the file header to the frames that are
+    // complete in the file
+    void publish()
+    {
+        if (m_backend == RECORDING_BACKEND_DIRECT)
+        {
+            uint64_t published = m_published;
+            while (published < m_index.size() &&
+                   m_index[published].offset + RECORDING_FRAME_HEADER_SIZE + m_index[published].dataSize <=
+                       m_direct.flushedSize())
+            {
+                published++;
+            }
+
+            if (published > m_published)
+            {
+                uint8_t header[RECORDING_HEADER_SIZE];
+                RecordingFormat::encodeFileHeader(header, 0, published);
+                m_failed = !m_direct.publishHead(header, sizeof(header));
+                m_published = published;
+            }
+            return;
+        }
+
+        m_file.flush();
+        m_failed = !m_file.good();
+        m_published = m_index.size();
+
+#if defined(__linux__)
+        if (m_publishMap != NULL && !m_failed)
+        {
+            // Stored as it is laid out in the file, so little-endian
+            uint8_t bytes[8];
+            RecordingFormat::put64(bytes, m_published);
+
+            uint64_t value;
+            memcpy(&value, bytes, sizeof(value));
+            __atomic_store_n(
+                reinterpret_cast<uint64_t*>(static_cast<uint8_t*>(m_publishMap) + RECORDING_FRAME_COUNT_OFFSET),
+                value,
+                __ATOMIC_RELEASE);
+        }
+#endif
+    }
+
+    void write(const void* data, size_t size)
+    {
+        if (m_failed || size == 0)
+        {
+            return;
+        }
+
+        if (m_backend == RECORDING_BACKEND_DIRECT)
+        {
+            m_failed = !m_direct.append(data, size);
+        }
+        else
+        {
+            m_file.write(static_cast<const char*>(data), size);
+            m_failed = !m_file.good();
+        }
+    }
+
+    RecordingBackend m_backend;
+    std::ofstream m_file;
+    DirectFileWriter m_direct;
+    std::vector<RecordedFrame> m_index;
+    uint64_t m_offset;
+    uint64_t m_published;
+    int m_publishFd;
+    void* m_publishMap;
+    bool m_failed;
+};
+
+//
+// Reads frames from a recording in any order
+//
+// *** NOTES ***
+// open() loads only the file header and the index. readFrame() then seeks to
+// the requested record and reads its header and image data. Timestamps are
+// expected to increase through a recording, as they do for the frames of a
+// single camera, so a time range is found with a binary search.
+//
+class RecordingReader
+{
+  public:
+    RecordingReader() : m_dataEnd(0), m_recovered(false)
+    {
+    }
+
+    bool open(const std::string& path)
+    {
+        m_frames.clear();
+        m_recovered = false;
+        m_path = path;
+        m_dataEnd = RECORDING_HEADER_SIZE;
+
+        m_file.close();
+        m_file.clear();
+        m_file.open(path.c_str(), std::ios::in | std::ios::binary);
+        if (!m_file.is_open())
+        {
+            return false;
+        }
+
+        uint8_t header[RECORDING_HEADER_SIZE];
+        if (!read(0, header, sizeof(header)) || RecordingFormat::get32(header) != RECORDING_MAGIC ||
+            RecordingFormat::get32(header + 4) == 0 || RecordingFormat::get32(header + 4) > RECORDING_VERSION)
+        {
+            return false;
+        }
+
+        const uint64_t indexOffset = RecordingFormat::get64(header + 16);
+        const uint64_t frameCount = RecordingFormat::get64(header + RECORDING_FRAME_COUNT_OFFSET);
+
+        if (indexOffset == 0)
+        {
+            // The writer did not get to close the file
+            m_recovered = true;
+            return scanFrames();
+        }
+
+        std::vector<uint8_t> index(static_cast<size_t>(frameCount * RECORDING_INDEX_ENTRY_SIZE));
+        if (!index.empty() && !read(indexOffset, &index[0], index.size()))
+        {
+            return false;
+        }
+
+        m_frames.resize(static_cast<size_t>(frameCount));
+        for (size_t i = 0; i < m_frames.size(); i++)
+        {
+            const uint8_t* entry = &index[i * RECORDING_INDEX_ENTRY_SIZE];
+            m_frames[i].frameId = RecordingFormat::get64(entry);
+            m_frames[i].timestamp = RecordingFormat::get64(entry + 8);
+            m_frames[i].offset = RecordingFormat::get64(entry + 16);
+            m_frames[i].status = RecordingFormat::get32(entry + 24);
+        }
+        m_dataEnd = indexOffset;
+        return true;
+    }
+
+    size_t frameCount() const
+    {
+        return m_frames.size();
+    }
+
+    // True if the index was rebuilt because the recording was not closed
+    bool recovered() const
+    {
+        return m_recovered;
+    }
+
+    // Index entry of frame n; size and format are only known after readFrame()
+    const RecordedFrame& indexEntry(size_t n) const
+    {
+        return m_frames.at(n);
+    }
+
+    // Read the header and the image data of frame n, decoded if it was
+    // stored compressed. The buffer is only grown, so it can be reused
+    // across calls.
+    bool readFrame(size_t n, RecordedFrame& frame, std::vector<char>& data)
+    {
+        if (n >= m_frames.size())
+        {
+            return false;
+        }
+
+        uint8_t header[RECORDING_FRAME_HEADER_SIZE];
+        if (!read(m_frames[n].offset, header, sizeof(header)) ||
+            !RecordingFormat::decodeFrameHeader(header, m_frames[n].offset, frame))
+        {
+            return false;
+        }
+
+        if (frame.codec == FRAME_CODEC_NONE)
+        {
+            if (data.size() < frame.dataSize)
+            {
+                data.resize(static_cast<size_t>(frame.dataSize));
+            }
+            return frame.dataSize == 0 || m_file.read(&data[0], static_cast<std::streamsize>(frame.dataSize));
+        }
+
+        // Compressed frames are read whole, then decoded into data
+        if (m_encoded.size() < frame.dataSize)
+        {
+            m_encoded.resize(static_cast<size_t>(frame.dataSize));
+        }
+        if (data.size() < frame.imageSize)
+        {
+            data.resize(static_cast<size_t>(frame.imageSize));
+        }
+        return frame.dataSize > 0 && frame.imageSize > 0 &&
+               m_file.read(&m_encoded[0], static_cast<std::streamsize>(frame.dataSize)) &&
+               RecordingFormat::decodeImage(frame, &m_encoded[0], &data[0]);
+    }
+
+    const std::string& path() const
+    {
+        return m_path;
+    }
+
+    // Offset just past the record of frame n. Records are stored back to
+    // back, so frames [first, last] occupy [indexEntry(first).offset,
+    // recordEnd(last)) and can be read with a single read.
+    uint64_t recordEnd(size_t n) const
+    {
+        return n + 1 < m_frames.size() ? m_frames[n + 1].offset : m_dataEnd;
+    }
+
+    // Decode the frame records in a block read from [offset, offset + size);
+    // the image data of frames[i] starts at block + dataOffsets[i]
+    static bool parseBlock(
+        const char* block,
+        size_t size,
+        uint64_t offset,
+        std::vector<RecordedFrame>& frames,
+        std::vector<size_t>& dataOffsets)
+    {
+        frames.clear();
+        dataOffsets.clear();
+
+        size_t position = 0;
+        while (position < size)
+        {
+            RecordedFrame frame;
+            if (size - position < RECORDING_FRAME_HEADER_SIZE ||
+                !RecordingFormat::decodeFrameHeader(
+                    reinterpret_cast<const uint8_t*>(block + position), offset + position, frame) ||
+                frame.dataSize > size - position - RECORDING_FRAME_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            frames.push_back(frame);
+            dataOffsets.push_back(position + RECORDING_FRAME_HEADER_SIZE);
+            position += RECORDING_FRAME_HEADER_SIZE + static_cast<size_t>(frame.dataSize);
+        }
+        return true;
+    }
+
+    // First frame with a timestamp at or after the given one; frameCount() if none
+    size_t findTimestamp(uint64_t timestamp) const
+    {
+        size_t low = 0;
+        size_t high = m_frames.size();
+        while (low < high)
+        {
+            const size_t middle = low + (high - low) / 2;
+            if (m_frames[middle].timestamp < timestamp)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // Frames [first, last) with timestamps in [begin, end)
+    void findTimeRange(uint64_t begin, uint64_t end, size_t& first, size_t& last) const
+    {
+        first = findTimestamp(begin);
+        last = std::max(first, findTimestamp(end));
+    }
+
+  private:
+    bool read(uint64_t offset, void* data, size_t size)
+    {
+        m_file.clear();
+        m_file.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(m_file.read(static_cast<char*>(data), static_cast<std::streamsize>(size)));
+    }
+
+    // Rebuild the index by walking the frame headers; a truncated last
+    // record is dropped
+    bool scanFrames()
+    {
+        m_file.clear();
+        m_file.seekg(0, std::ios::end);
+        const uint64_t fileSize = static_cast<uint64_t>(m_file.tellg());
+
+        uint64_t offset = RECORDING_HEADER_SIZE;
+        uint8_t header[RECORDING_FRAME_HEADER_SIZE];
+        RecordedFrame frame;
+
+        while (offset + RECORDING_FRAME_HEADER_SIZE <= fileSize && read(offset, header, sizeof(header)) &&
+               RecordingFormat::decodeFrameHeader(header, offset, frame) &&
+               frame.dataSize <= fileSize - offset - RECORDING_FRAME_HEADER_SIZE)
+        {
+            m_frames.push_back(frame);
+            offset += RECORDING_FRAME_HEADER_SIZE + frame.dataSize;
+        }
+        m_dataEnd = offset;
+        return true;
+    }
+
+    std::ifstream m_file;
+    std::string m_path;
+    std::vector<RecordedFrame> m_frames;
+    uint64_t m_dataEnd;
+    bool m_recovered;
+
+    // Compressed image data, kept for the next frame
+    std::vector<char> m_encoded;
+};
+
+//
+// List of the pieces that make up the recordings of all cameras
+//
+// *** NOTES ***
+// The manifest is a text file with one "key value" pair per line:
+//
+//   version 1
+//   stripe frames
+//   stripe_frames 8
+//   camera 0 /mnt/nvme0/camera0.piece0.tmp
+//   camera 0 /mnt/nvme1/camera0.piece1.tmp
+//   camera 1 ...
+//
+// "stripe" tells how the pieces were filled: "cameras" gives every camera a
+// single piece, "frames" spreads blocks of stripe_frames consecutive frames
+// of each camera over its pieces. Paths are stored as they were given to the
+// writer.
+//
+struct RecordingManifest
+{
+    std::string stripe;
+    unsigned int stripeFrames;
+
+    // Paths of the pieces of each camera
+    std::vector<std::vector<std::string>> pieces;
+
+    RecordingManifest() : stripe("cameras"), stripeFrames(0)
+    {
+    }
+
+    // Write through a temporary file, so a reader never sees half a manifest
+    bool write(const std::string& path) const
+    {
+        const std::string tmpPath = path + ".part";
+        std::ofstream file(tmpPath.c_str(), std::ios::out | std::ios::trunc);
+
+        file << "version " << RECORDING_MANIFEST_VERSION << std::endl;
+        file << "stripe " << stripe << std::endl;
+        file << "stripe_frames " << stripeFrames << std::endl;
+        for (size_t camera = 0; camera < pieces.size(); camera++)
+        {
+            for (size_t piece = 0; piece < pieces[camera].size(); piece++)
+            {
+                file << "camera " << camera << " " << pieces[camera][piece] << std::endl;
+            }
+        }
+
+        file.close();
+        if (file.fail())
+        {
+            remove(tmpPath.c_str());
+            return false;
+        }
+
+        // rename() does not replace an existing file on every platform
+        remove(path.c_str());
+        return rename(tmpPath.c_str(), path.c_str()) == 0;
+    }
+
+    bool read(const std::string& path)
+    {
+        std::ifstream file(path.c_str());
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        pieces.clear();
+
+        std::string line;
+        unsigned int version = 0;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            std::string key;
+            fields >> key;
+
+            if (key == "version")
+            {
+                fields >> version;
+            }
+            else if (key == "stripe")
+            {
+                fields >> stripe;
+            }
+            else if (key == "stripe_frames")
+            {
+                fields >> stripeFrames;
+            }
+            else if (key == "camera")
+            {
+                size_t camera = 0;
+                std::string piece;
+                if (!(fields >> camera) || !std::getline(fields >> std::ws, piece) || piece.empty())
+                {
+                    return false;
+                }
+                if (camera >= pieces.size())
+                {
+                    pieces.resize(camera + 1);
+                }
+                pieces[camera].push_back(piece);
+            }
+        }
+
+        return version == RECORDING_MANIFEST_VERSION;
+    }
+};
+
+//
+// Reads the pieces of one camera's recording as a single recording
+//
+// *** NOTES ***
+// Every piece holds the frames of some blocks, in order, so the frames of
+// all pieces are merged by timestamp. Frame numbers, readFrame() and the
+// timestamp searches then work as for a single RecordingReader.
+//
+class RecordingSet
+{
+  public:
+    bool open(const std::vector<std::string>& paths)
+    {
+        m_pieces.clear();
+        m_frames.clear();
+
+        for (size_t piece = 0; piece < paths.size(); piece++)
+        {
+            std::shared_ptr<RecordingReader> reader = std::make_shared<RecordingReader>();
+            if (!reader->open(paths[piece]))
+            {
+                return false;
+            }
+            m_pieces.push_back(reader);
+
+            for (size_t frame = 0; frame < reader->frameCount(); frame++)
+            {
+                m_frames.push_back(Entry(piece, frame, reader->indexEntry(frame).timestamp));
+            }
+        }
+
+        std::stable_sort(m_frames.begin(), m_frames.end());
+        return true;
+    }
+
+    size_t frameCount() const
+    {
+        return m_frames.size();
+    }
+
+    // True if the index of any piece was rebuilt
+    bool recovered() const
+    {
+        for (size_t piece = 0; piece < m_pieces.size(); piece++)
+        {
+            if (m_pieces[piece]->recovered())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const RecordedFrame& indexEntry(size_t n) const
+    {
+        return m_pieces[m_frames.at(n).piece]->indexEntry(m_frames[n].frame);
+    }
+
+    size_t pieceCount() const
+    {
+        return m_pieces.size();
+    }
+
+    const RecordingReader& piece(size_t p) const
+    {
+        return *m_pieces.at(p);
+    }
+
+    // Piece holding frame n, and the number of the frame within that piece
+    size_t pieceOf(size_t n) const
+    {
+        return m_frames.at(n).piece;
+    }
+
+    size_t frameInPiece(size_t n) const
+    {
+        return m_frames.at(n).frame;
+    }
+
+    bool readFrame(size_t n, RecordedFrame& frame, std::vector<char>& data)
+    {
+        return n < m_frames.size() && m_pieces[m_frames[n].piece]->readFrame(m_frames[n].frame, frame, data);
+    }
+
+    // First frame with a timestamp at or after the given one; frameCount() if none
+    size_t findTimestamp(uint64_t timestamp) const
+    {
+        return std::lower_bound(m_frames.begin(), m_frames.end(), Entry(0, 0, timestamp)) - m_frames.begin();
+    }
+
+    // Frames [first, last) with timestamps in [begin, end)
+    void findTimeRange(uint64_t begin, uint64_t end, size_t& first, size_t& last) const
+    {
+        first = findTimestamp(begin);
+        last = std::max(first, findTimestamp(end));
+    }
+
+  private:
+    struct Entry
+    {
+        size_t piece;
+        size_t frame;
+        uint64_t timestamp;
+
+        Entry(size_t piece_, size_t frame_, uint64_t timestamp_) : piece(piece_), frame(frame_), timestamp(timestamp_)
+        {
+        }
+
+        bool operator<(const Entry& other) const
+        {
+            return timestamp < other.timestamp;
+        }
+    };
+
+    std::vector<std::shared_ptr<RecordingReader>> m_pieces;
+    std::vector<Entry> m_frames;
+};
+
+#endif // FRAME_RECORDING_H
@@ -0,0 +1,259 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief RecordingTailReader.h follows a recording (see FrameRecording.h)
+ *  while it is being written, typically from another process.
+ *
+ *  The writer raises the frame count in the file header with an atomic store
+ *  once frames are complete in the file. The reader maps the file read-only,
+ *  loads that count and walks the frame headers it has not seen yet, so
+ *  it only ever looks at frames that are fully written. Image data is not
+ *  copied: frameData() points straight into the mapping. Once the writer
+ *  closes the recording, the index offset in the header is set and the
+ *  reader reports the recording as finished.
+ *
+ *  Recordings written with DirectFileWriter only publish frames when its
+ *  staging buffer reaches the disk, so they show up a few megabytes at a time.
+ *  Only Linux is supported.
+ */
+
+#ifndef RECORDING_TAIL_READER_H
+#define RECORDING_TAIL_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "FrameRecording.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//
+// Follows a growing recording
+//
+// *** NOTES ***
+// Call poll() to pick up the frames published since the last call. The
+// mapping grows with the file, so pointers returned by frameData() stay
+// valid only until the next poll().
+//
+class RecordingTailReader
+{
+  public:
+    RecordingTailReader() : m_fd(-1), m_map(NULL), m_mapSize(0), m_nextOffset(0), m_closed(false), m_failed(false)
+    {
+    }
+
+    ~RecordingTailReader()
+    {
+        close();
+    }
+
+    bool open(const std::string& path)
+    {
+        close();
+
+        m_frames.clear();
+        m_nextOffset = RECORDING_HEADER_SIZE;
+        m_closed = false;
+        m_failed = false;
+
+#if defined(__linux__)
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+        {
+            return false;
+        }
+
+        // The file is created before its header is written
+        if (!mapFile(RECORDING_HEADER_SIZE) || RecordingFormat::get32(m_map) != RECORDING_MAGIC ||
+            RecordingFormat::get32(m_map + 4) == 0 || RecordingFormat::get32(m_map + 4) > RECORDING_VERSION)
+        {
+            close();
+            return false;
+        }
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#if defined(__linux__)
+        if (m_map != NULL)
+        {
+            munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+        }
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+#endif
+        m_map = NULL;
+        m_mapSize = 0;
+        m_fd = -1;
+    }
+
+    // Pick up the frames published since the last call; returns how many
+    size_t poll()
+    {
+        if (m_map == NULL || m_failed)
+        {
+            return 0;
+        }
+
+        // The index offset is set by close() together with the final count,
+        // so once it is seen the count is final
+        const bool closed = loadHeaderField(16) != 0;
+        const uint64_t published = loadHeaderField(RECORDING_FRAME_COUNT_OFFSET);
+
+        const size_t previous = m_frames.size();
+        while (m_frames.size() < published)
+        {
+            RecordedFrame frame;
+            if (!mapFile(m_nextOffset + RECORDING_FRAME_HEADER_SIZE) ||
+                !RecordingFormat::decodeFrameHeader(m_map + m_nextOffset, m_nextOffset, frame) ||
+                !mapFile(m_nextOffset + RECORDING_FRAME_HEADER_SIZE + frame.dataSize))
+            {
+                // A published frame must be complete
+                m_failed = true;
+                break;
+            }
+
+            m_frames.push_back(frame);
+            m_nextOffset += RECORDING_FRAME_HEADER_SIZE + frame.dataSize;
+        }
+
+        m_closed = closed && m_frames.size() >= published;
+        return m_frames.size() - previous;
+    }
+
+    size_t frameCount() const
+    {
+        return m_frames.size();
+    }
+
+    const RecordedFrame& frame(size_t n) const
+    {
+        return m_frames[n];
+    }
+
+    // Image data of frame n, inside the mapping of the file
+    const void* frameData(size_t n) const
+    {
+        return m_map + m_frames[n].offset + RECORDING_FRAME_HEADER_SIZE;
+    }
+
+    // True once the writer has closed the recording and every frame in it
+    // has been picked up
+    bool finished() const
+    {
+        return m_closed;
+    }
+
+    // True if the file does not hold what the header promised
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    // True if the file has been deleted since it was opened, in which case
+    // nothing more will be written to it
+    bool removed() const
+    {
+#if defined(__linux__)
+        struct stat status;
+        return m_fd >= 0 && fstat(m_fd, &status) == 0 && status.st_nlink == 0;
+#else
+        return false;
+#endif
+    }
+
+  private:
+    // Load a 64-bit field of the file header; pairs with the release store
+    // of the writer
+    uint64_t loadHeaderField(size_t offset) const
+    {
+#if defined(__linux__)
+        const uint64_t value = __atomic_load_n(reinterpret_cast<const uint64_t*>(m_map + offset), __ATOMIC_ACQUIRE);
+
+        uint8_t bytes[8];
+        memcpy(bytes, &value, sizeof(bytes));
+        return RecordingFormat::get64(bytes);
+#else
+        (void)offset;
+        return 0;
+#endif
+    }
+
+    // Make sure the first size bytes of the file are mapped, remapping the
+    // whole file if it has grown past the mapping
+    bool mapFile(uint64_t size)
+    {
+        if (size <= m_mapSize)
+        {
+            return true;
+        }
+
+#if defined(__linux__)
+        struct stat status;
+        if (fstat(m_fd, &status) != 0 || static_cast<uint64_t>(status.st_size) < size)
+        {
+            return false;
+        }
+
+        if (m_map != NULL)
+        {
+            munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+            m_map = NULL;
+            m_mapSize = 0;
+        }
+
+        const size_t mapSize = static_cast<size_t>(status.st_size);
+        void* map = mmap(NULL, mapSize, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (map == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_map = static_cast<const uint8_t*>(map);
+        m_mapSize = mapSize;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    int m_fd;
+    const uint8_t* m_map;
+    size_t m_mapSize;
+    std::vector<RecordedFrame> m_frames;
+    uint64_t m_nextOffset;
+    bool m_closed;
+    bool m_failed;
+};
+
+#endif // RECORDING_TAIL_READER_H
@@ -0,0 +1,853 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @example AcquisitionMultipleCoroutine.cpp
+ *
+ *  @brief AcquisitionMultipleCoroutine.cpp shows how to capture images from
+ *  many cameras at once with C++20 coroutines, on a few threads rather than
+ *  one thread per camera. It relies on information provided in the
+ *  Enumeration, Acquisition, ImageEvents and AcquisitionMultipleThread
+ *  examples, and needs a C++20 compiler.
+ *
+ *  This example follows AcquisitionMultipleThread: every camera is
+ *  initialized, acquires 10 images and saves them as JPEG. Instead of a
+ *  thread that blocks in GetNextImage, each camera has a coroutine that
+ *  waits with co_await stream.nextImage(...). The camera's image event
+ *  handler resumes the coroutine when an image arrives (see
+ *  CoroutineScheduler.h), and a fixed pool of threads runs whichever
+ *  coroutines are ready, so the number of threads no longer grows with the
+ *  number of cameras. Blocking calls such as Init still occupy a pool
+ *  thread while they run.
+ *
+ *  --compare runs the cameras both ways, one thread per camera and then
+ *  coroutines on the pool, and prints the context switches and CPU time per
+ *  frame of each. The SDK receives images on threads of its own either way,
+ *  and both counts cover the whole process, those threads included.
+ *  --no-save leaves out converting and saving the images, which otherwise
+ *  takes most of the CPU time, to compare the cost of scheduling alone.
+ *
+ *  Please leave us feedback at: https://www.surveymonkey.com/r/TDYMVAPI
+ *  More source code examples at: https://github.com/Teledyne-MV/Spinnaker-Examples
+ *  Need help? Check out our forum at: https://teledynevisionsolutions.zendesk.com/hc/en-us/community/topics
+ */
+
+#include "Spinnaker.h"
+#include "SpinGenApi/SpinnakerGenApi.h"
+#include "AsyncLog.h"
+#include "CoroutineScheduler.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace Spinnaker;
+using namespace Spinnaker::GenApi;
+using namespace Spinnaker::GenICam;
+using namespace std;
+
+// Number of images acquired from each camera; set with --images
+unsigned int numImages = 10;
+
+// Number of threads running the coroutines of all cameras; 0 uses one per
+// processor core. Set with --pool-threads.
+unsigned int numPoolThreads = 0;
+
+// Most images of a camera waiting for its coroutine; beyond that the oldest
+// is dropped
+const size_t k_maxQueuedImages = 32;
+
+// How long a camera may deliver no image before its acquisition is aborted
+const unsigned int k_grabTimeoutMs = 1000;
+
+// Convert and save the images; cleared with --no-save
+bool saveImages = true;
+
+// State of one camera
+struct CameraContext
+{
+    CameraPtr pCam;
+    unsigned int cameraIndex = 0;
+    std::string serialNumber;
+
+    // Image event handler the coroutine waits on; unused with one thread
+    // per camera
+    std::unique_ptr<ImageStream> stream;
+
+    // Written by the camera's coroutine or thread only
+    unsigned int imagesReceived = 0;
+    unsigned int imagesSaved = 0;
+    bool succeeded = false;
+};
+
+// CPU time and context switches of the whole process so far
+struct ProcessUsage
+{
+    bool available = false;
+    double cpuSeconds = 0.0;
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+};
+
+// What one way of running the cameras cost
+struct RunResult
+{
+    const char* name = "";
+    unsigned int numThreads = 0;
+    unsigned int frames = 0;
+    uint64_t resumes = 0;
+    uint64_t dropped = 0;
+    double seconds = 0.0;
+    ProcessUsage usage;
+};
+
+// This function prints the device information of the camera from the transport
+// layer; please see NodeMapInfo example for more in-depth comments on printing
+// device information from the nodemap.
+int PrintDeviceInfo(INodeMap& nodeMap, std::string camSerial)
+{
+    int result = 0;
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "[" << camSerial << "] Printing device information ...");
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+
+    try
+    {
+        FeatureList_t features;
+        CCategoryPtr category = nodeMap.GetNode("DeviceInformation");
+        if (IsReadable(category))
+        {
+            category->GetFeatures(features);
+
+            FeatureList_t::const_iterator it;
+            for (it = features.begin(); it != features.end(); ++it)
+            {
+                try
+                {
+                    CNodePtr pfeatureNode = *it;
+                    CValuePtr pValue = (CValuePtr)pfeatureNode;
+                    ASYNC_LOG(ASYNC_LOG_INFO, pfeatureNode->GetName()
+                                                  << " : "
+                                                  << (IsReadable(pValue) ? pValue->ToString() : "Node not readable"));
+                }
+                catch (Spinnaker::Exception)
+                {
+                    ASYNC_LOG(ASYNC_LOG_INFO, "Node not readable");
+                }
+            }
+        }
+        else
+        {
+            ASYNC_LOG(ASYNC_LOG_INFO, "Device control information not readable.");
+        }
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << e.what());
+        result = -1;
+    }
+
+    return result;
+}
+
+// Disables or enables heartbeat on GEV cameras so debugging does not incur timeout errors
+int ConfigureGVCPHeartbeat(CameraPtr pCam, bool enableHeartbeat)
+{
+    //
+    // Write to boolean node controlling the camera's heartbeat
+    //
+    // *** NOTES ***
+    // This applies only to GEV cameras.
+    //
+    // GEV cameras have a heartbeat built in, but when debugging applications the
+    // camera may time out due to its heartbeat. Disabling the heartbeat prevents
+    // this timeout from occurring, enabling us to continue with any necessary 
+    // debugging.
+    //
+    // *** LATER ***
+    // Make sure that the heartbeat is reset upon completion of the debugging.  
+    // If the application is terminated unexpectedly, the camera may not locked
+    // to Spinnaker indefinitely due to the the timeout being disabled.  When that 
+    // happens, a camera power cycle will reset the heartbeat to its default setting.
+
+    // Retrieve TL device nodemap
+    INodeMap& nodeMapTLDevice = pCam->GetTLDeviceNodeMap();
+
+    // Retrieve GenICam nodemap
+    INodeMap& nodeMap = pCam->GetNodeMap();
+
+    CEnumerationPtr ptrDeviceType = nodeMapTLDevice.GetNode("DeviceType");
+    if (!IsReadable(ptrDeviceType))
+    {
+        return -1;
+    }
+
+    if (ptrDeviceType->GetIntValue() != DeviceType_GigEVision)
+    {
+        return 0;
+    }
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+    ASYNC_LOG(ASYNC_LOG_INFO, (enableHeartbeat ? "Resetting heartbeat..." : "Disabling heartbeat..."));
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+
+    CBooleanPtr ptrDeviceHeartbeat = nodeMap.GetNode("GevGVCPHeartbeatDisable");
+    if (!IsWritable(ptrDeviceHeartbeat))
+    {
+        ASYNC_LOG(ASYNC_LOG_WARNING,
+                  "Unable to configure heartbeat. Continuing with execution as this may be non-fatal...");
+        ASYNC_LOG(ASYNC_LOG_WARNING, "");
+    }
+    else
+    {
+        ptrDeviceHeartbeat->SetValue(!enableHeartbeat);
+
+        if (!enableHeartbeat)
+        {
+            ASYNC_LOG(ASYNC_LOG_WARNING, "WARNING: Heartbeat has been disabled for the rest of this example run.");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         Heartbeat will be reset upon the completion of this run.  If the ");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         example is aborted unexpectedly before the heartbeat is reset, the");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         camera may need to be power cycled to reset the heartbeat.");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "");
+        }
+        else
+        {
+            ASYNC_LOG(ASYNC_LOG_INFO, "Heartbeat has been reset.");
+        }
+    }
+
+    return 0;
+}
+
+int ResetGVCPHeartbeat(CameraPtr pCam)
+{
+    return ConfigureGVCPHeartbeat(pCam, true);
+}
+
+int DisableGVCPHeartbeat(CameraPtr pCam)
+{
+    return ConfigureGVCPHeartbeat(pCam, false);
+}
+
+
+// This function reads the CPU time and context switches of the process; the
+// kernel counts them for all of its threads.
+ProcessUsage ReadProcessUsage()
+{
+    ProcessUsage usage;
+
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage rusage;
+    if (getrusage(RUSAGE_SELF, &rusage) == 0)
+    {
+        usage.available = true;
+        usage.cpuSeconds = rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec / 1000000.0 + rusage.ru_stime.tv_sec +
+                           rusage.ru_stime.tv_usec / 1000000.0;
+        usage.voluntarySwitches = rusage.ru_nvcsw;
+        usage.involuntarySwitches = rusage.ru_nivcsw;
+    }
+#endif
+
+    return usage;
+}
+
+// This function returns the image processor of the calling thread, so the
+// threads never wait on one another to convert.
+ImageProcessor& ThreadImageProcessor()
+{
+    thread_local ImageProcessor processor;
+    thread_local bool configured = false;
+
+    //
+    // Set default image processor color processing method
+    //
+    // *** NOTES ***
+    // By default, if no specific color processing algorithm is set, the image
+    // processor will default to NEAREST_NEIGHBOR method.
+    //
+    if (!configured)
+    {
+        processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+        configured = true;
+    }
+    return processor;
+}
+
+// This function converts an image to mono 8 and saves it, unless images are
+// not to be saved.
+void SaveImage(CameraContext& camera, const ImagePtr& image, unsigned int imageCnt)
+{
+    if (!saveImages)
+    {
+        return;
+    }
+
+    // Convert image to mono 8
+    ImagePtr convertedImage = ThreadImageProcessor().Convert(image, PixelFormat_Mono8);
+
+    // Create a unique filename
+    std::ostringstream filename;
+
+    filename << "AcquisitionMultipleCoroutine-";
+    if (camera.serialNumber != "")
+    {
+        filename << camera.serialNumber.c_str();
+    }
+
+    filename << "-" << imageCnt << ".jpg";
+
+    // Save image
+    convertedImage->Save(filename.str().c_str());
+    camera.imagesSaved++;
+
+    ASYNC_LOG(ASYNC_LOG_DEBUG, "[" << camera.serialNumber << "] "
+                                   << "Image saved at " << filename.str());
+}
+
+// This function initializes a camera and sets it to acquire continuously;
+// the same for both ways of running the cameras.
+bool StartCamera(CameraContext& camera)
+{
+    CameraPtr pCam = camera.pCam;
+
+    // Retrieve TL device nodemap
+    INodeMap& nodeMapTLDevice = pCam->GetTLDeviceNodeMap();
+
+    // Retrieve device serial number for filename
+    CStringPtr ptrStringSerial = nodeMapTLDevice.GetNode("DeviceSerialNumber");
+
+    camera.serialNumber = "";
+    if (IsReadable(ptrStringSerial))
+    {
+        camera.serialNumber = ptrStringSerial->GetValue();
+    }
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+    ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                  << "*** IMAGE ACQUISITION STARTING ***");
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+
+    // Print device information
+    PrintDeviceInfo(nodeMapTLDevice, camera.serialNumber);
+
+    // Initialize camera
+    pCam->Init();
+
+    // Retrieve nodemap
+    INodeMap& nodeMap = pCam->GetNodeMap();
+
+#ifdef _DEBUG
+    // Disable heartbeat for GEV camera for Debug mode
+    if (DisableGVCPHeartbeat(pCam) != 0)
+#else
+    // Reset heartbeat for GEV camera for Release mode
+    if (ResetGVCPHeartbeat(pCam) != 0)
+#endif
+    {
+        return false;
+    }
+
+    // Set acquisition mode to continuous
+    CEnumerationPtr ptrAcquisitionMode = nodeMap.GetNode("AcquisitionMode");
+    if (!IsReadable(ptrAcquisitionMode) || !IsWritable(ptrAcquisitionMode))
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Unable to set acquisition mode to continuous (node retrieval; camera "
+                                       << camera.serialNumber << "). Aborting...");
+        return false;
+    }
+
+    CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
+    if (!IsReadable(ptrAcquisitionModeContinuous))
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Unable to get acquisition mode to continuous (entry 'continuous' retrieval "
+                                       << camera.serialNumber << "). Aborting...");
+        return false;
+    }
+
+    ptrAcquisitionMode->SetIntValue(ptrAcquisitionModeContinuous->GetValue());
+
+    ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                  << "Acquisition mode set to continuous...");
+    return true;
+}
+
+// This function stops a camera's acquisition, if it is running, and
+// deinitializes the camera.
+void StopCamera(CameraContext& camera)
+{
+    CameraPtr pCam = camera.pCam;
+
+    if (pCam->IsStreaming())
+    {
+        pCam->EndAcquisition();
+    }
+
+#ifdef _DEBUG
+    // Reset heartbeat for GEV camera
+    ResetGVCPHeartbeat(pCam);
+#endif
+
+    // Deinitialize camera
+    pCam->DeInit();
+}
+
+//
+// This coroutine acquires the images of a camera and saves them
+//
+// *** NOTES ***
+// Where AcquisitionMultipleThread blocks a thread of its own in
+// GetNextImage, this waits with co_await, which suspends the coroutine and
+// frees the pool thread for other cameras. The image event handler copies
+// each image as it arrives and resumes the coroutine, possibly on another
+// pool thread than the one it suspended on, so it keeps no state in
+// thread-local variables across a co_await.
+//
+Task AcquireImages(CameraContext& camera)
+{
+    bool registered = false;
+
+    try
+    {
+        if (!StartCamera(camera))
+        {
+            StopCamera(camera);
+            co_return;
+        }
+
+        // Images are delivered to the stream once acquisition begins
+        camera.pCam->RegisterEventHandler(*camera.stream);
+        registered = true;
+        camera.pCam->BeginAcquisition();
+
+        ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                      << "Started acquiring images...");
+
+        bool timedOut = false;
+        for (unsigned int imageCnt = 0; imageCnt < numImages; imageCnt++)
+        {
+            StreamImage image;
+            if (!co_await camera.stream->nextImage(image, chrono::milliseconds(k_grabTimeoutMs)))
+            {
+                ASYNC_LOG(ASYNC_LOG_ERROR, "[" << camera.serialNumber << "] "
+                                               << "No image received for " << k_grabTimeoutMs << " ms. Aborting...");
+                timedOut = true;
+                break;
+            }
+            camera.imagesReceived++;
+
+            if (image.incomplete)
+            {
+                ASYNC_LOG(ASYNC_LOG_WARNING, "[" << camera.serialNumber << "] "
+                                                 << "Image incomplete with image status " << image.status << "...");
+                continue;
+            }
+
+            ASYNC_LOG(ASYNC_LOG_DEBUG, "[" << camera.serialNumber << "] "
+                                           << "Grabbed image " << imageCnt << ", width = " << image.image->GetWidth()
+                                           << ", height = " << image.image->GetHeight());
+
+            SaveImage(camera, image.image, imageCnt);
+        }
+
+        camera.pCam->EndAcquisition();
+        camera.pCam->UnregisterEventHandler(*camera.stream);
+        registered = false;
+        StopCamera(camera);
+
+        camera.succeeded = !timedOut;
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "[" << camera.serialNumber << "] "
+                                       << "Error: " << e.what());
+
+        // The SDK refuses to unregister a handler that was never registered,
+        // and the camera is stopped either way
+        if (registered)
+        {
+            try
+            {
+                camera.pCam->UnregisterEventHandler(*camera.stream);
+            }
+            catch (Spinnaker::Exception&)
+            {
+            }
+        }
+
+        try
+        {
+            StopCamera(camera);
+        }
+        catch (Spinnaker::Exception&)
+        {
+        }
+    }
+}
+
+// This function acquires the images of a camera on a thread of its own, as
+// AcquisitionMultipleThread does, to compare with.
+void AcquireImagesOnThread(CameraContext& camera)
+{
+    try
+    {
+        if (!StartCamera(camera))
+        {
+            StopCamera(camera);
+            return;
+        }
+
+        camera.pCam->BeginAcquisition();
+
+        ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                      << "Started acquiring images...");
+
+        for (unsigned int imageCnt = 0; imageCnt < numImages; imageCnt++)
+        {
+            // Retrieve next received image and ensure image completion
+            ImagePtr pResultImage = camera.pCam->GetNextImage(k_grabTimeoutMs);
+            camera.imagesReceived++;
+
+            if (pResultImage->IsIncomplete())
+            {
+                ASYNC_LOG(ASYNC_LOG_WARNING, "[" << camera.serialNumber << "] "
+                                                 << "Image incomplete with image status "
+                                                 << pResultImage->GetImageStatus() << "...");
+            }
+            else
+            {
+                ASYNC_LOG(ASYNC_LOG_DEBUG, "[" << camera.serialNumber << "] "
+                                               << "Grabbed image " << imageCnt << ", width = "
+                                               << pResultImage->GetWidth() << ", height = "
+                                               << pResultImage->GetHeight());
+
+                SaveImage(camera, pResultImage, imageCnt);
+            }
+
+            // Release image
+            pResultImage->Release();
+        }
+
+        StopCamera(camera);
+        camera.succeeded = true;
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "[" << camera.serialNumber << "] "
+                                       << "Error: " << e.what());
+        try
+        {
+            StopCamera(camera);
+        }
+        catch (Spinnaker::Exception&)
+        {
+        }
+    }
+}
+
+// This function runs all cameras, with coroutines on the pool or with one
+// thread per camera, and measures what it cost.
+int RunCameras(CameraList& camList, bool useCoroutines, RunResult& run)
+{
+    int result = 0;
+
+    const unsigned int numCameras = camList.GetSize();
+    unsigned int numThreads = numCameras;
+    if (useCoroutines)
+    {
+        numThreads = numPoolThreads;
+        if (numThreads == 0)
+        {
+            numThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        }
+    }
+
+    cout << endl
+         << "*** RUNNING " << numCameras << " CAMERAS "
+         << (useCoroutines ? "AS COROUTINES ON " : "ON ") << numThreads << " THREADS ***" << endl;
+
+    vector<CameraContext> cameras(numCameras);
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        cameras[i].pCam = camList.GetByIndex(i);
+        cameras[i].cameraIndex = i;
+    }
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    const ProcessUsage startUsage = ReadProcessUsage();
+
+    if (useCoroutines)
+    {
+        //
+        // Run a coroutine per camera on the pool
+        //
+        // *** NOTES ***
+        // Each stream keeps its timeout timer in the scheduler, so the
+        // streams are created after the scheduler and destroyed before it.
+        //
+        std::unique_ptr<Scheduler> scheduler(new Scheduler(numThreads));
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            cameras[i].stream.reset(new ImageStream(*scheduler, k_maxQueuedImages));
+        }
+
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            scheduler->spawn(AcquireImages(cameras[i]));
+        }
+        scheduler->wait();
+
+        run.resumes = scheduler->resumeCount();
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            run.dropped += cameras[i].stream->droppedCount();
+            cameras[i].stream.reset();
+        }
+        scheduler.reset();
+    }
+    else
+    {
+        vector<std::thread> threads;
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            threads.push_back(std::thread(AcquireImagesOnThread, std::ref(cameras[i])));
+        }
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            threads[i].join();
+        }
+    }
+
+    const ProcessUsage endUsage = ReadProcessUsage();
+    run.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    run.usage.available = startUsage.available && endUsage.available;
+    run.usage.cpuSeconds = endUsage.cpuSeconds - startUsage.cpuSeconds;
+    run.usage.voluntarySwitches = endUsage.voluntarySwitches - startUsage.voluntarySwitches;
+    run.usage.involuntarySwitches = endUsage.involuntarySwitches - startUsage.involuntarySwitches;
+    run.name = useCoroutines ? "Coroutines on a thread pool" : "One thread per camera";
+    run.numThreads = numThreads;
+
+    // Print what the cameras reported before the results
+    AsyncLog::flush();
+
+    cout << endl;
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        run.frames += cameras[i].imagesReceived;
+        cout << "[" << cameras[i].serialNumber << "] " << cameras[i].imagesReceived << " images received, "
+             << cameras[i].imagesSaved << " saved" << endl;
+        if (!cameras[i].succeeded)
+        {
+            cout << "Camera at index " << i << " finished with errors. Please check onscreen print outs for error "
+                 << "details" << endl;
+            result = -1;
+        }
+    }
+
+    // Release the cameras before the list is cleared
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        cameras[i].pCam = nullptr;
+    }
+
+    return result;
+}
+
+// This function prints what each way of running the cameras cost per frame.
+void PrintRunResults(const vector<RunResult>& runs)
+{
+    cout << endl << "*** SCHEDULING COST ***" << endl << endl;
+
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        const RunResult& run = runs[i];
+        const double frames = run.frames > 0 ? run.frames : 1;
+
+        cout << run.name << string(28 - string(run.name).size(), ' ') << ": " << run.numThreads << " threads, "
+             << run.frames << " frames in " << run.seconds * 1000.0 << " ms";
+        if (run.usage.available)
+        {
+            cout << ", " << (run.usage.voluntarySwitches + run.usage.involuntarySwitches) / frames
+                 << " context switches (" << run.usage.voluntarySwitches / frames << " voluntary) and "
+                 << run.usage.cpuSeconds * 1000000.0 / frames << " us CPU per frame";
+        }
+        if (run.resumes > 0)
+        {
+            cout << ", " << run.resumes / frames << " resumes per frame";
+        }
+        if (run.dropped > 0)
+        {
+            cout << ", " << run.dropped << " images dropped";
+        }
+        cout << endl;
+    }
+
+    if (!runs.empty() && !runs[0].usage.available)
+    {
+        cout << "Context switches and CPU time are not available on this system" << endl;
+    }
+    cout << endl;
+}
+
+// This function prints the options of the example.
+void PrintUsage()
+{
+    cout << "Usage: AcquisitionMultipleCoroutine [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "--pool-threads N      : Run the coroutines on N threads (default: one per processor core)" << endl;
+    cout << "--images N            : Number of images to grab from each camera (default: " << numImages << ")"
+         << endl;
+    cout << "--compare             : Also run the cameras with one thread each and compare the cost per frame"
+         << endl;
+    cout << "--no-save             : Do not convert and save the images, to measure the scheduling alone" << endl;
+    cout << "--help                : Print this message" << endl;
+}
+
+// Example entry point; please see Enumeration example for more in-depth
+// comments on preparing and cleaning up the system.
+int main(int argc, char** argv)
+{
+    bool compare = false;
+
+    // Change arguments to string for easy read
+    vector<string> args(argv, argv + argc);
+
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        const bool hasValue = i + 1 < args.size();
+
+        if (args[i] == "--pool-threads" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            numPoolThreads = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--images" && hasValue && atoi(args[i + 1].c_str()) > 0)
+        {
+            numImages = static_cast<unsigned int>(atoi(args[++i].c_str()));
+        }
+        else if (args[i] == "--compare")
+        {
+            compare = true;
+        }
+        else if (args[i] == "--no-save")
+        {
+            saveImages = false;
+        }
+        else
+        {
+            PrintUsage();
+            return args[i] == "--help" ? 0 : -1;
+        }
+    }
+
+    // Since this application saves images in the current folder
+    // we must ensure that we have permission to write to this folder.
+    // If we do not have permission, fail right away.
+    FILE* tempFile = fopen("test.txt", "w+");
+    if (tempFile == nullptr)
+    {
+        cout << "Failed to create file in current folder.  Please check permissions." << endl;
+        cout << "Press Enter to exit..." << endl;
+        getchar();
+        return -1;
+    }
+
+    fclose(tempFile);
+    remove("test.txt");
+
+    int result = 0;
+
+    // Print application build information
+    cout << "Application build date: " << __DATE__ << " " << __TIME__ << endl << endl;
+
+    // Retrieve singleton reference to system object
+    SystemPtr system = System::GetInstance();
+
+    // Print out current library version
+    const LibraryVersion spinnakerLibraryVersion = system->GetLibraryVersion();
+    cout << "Spinnaker library version: " << spinnakerLibraryVersion.major << "." << spinnakerLibraryVersion.minor
+         << "." << spinnakerLibraryVersion.type << "." << spinnakerLibraryVersion.build << endl
+         << endl;
+
+    // Retrieve list of cameras from the system
+    CameraList camList = system->GetCameras();
+
+    unsigned int numCameras = camList.GetSize();
+
+    cout << "Number of cameras detected: " << numCameras << endl << endl;
+
+    // Finish if there are no cameras
+    if (numCameras == 0)
+    {
+        // Clear camera list before releasing system
+        camList.Clear();
+
+        // Release system
+        system->ReleaseInstance();
+
+        cout << "Not enough cameras!" << endl;
+        cout << "Done! Press Enter to exit..." << endl;
+        getchar();
+
+        return -1;
+    }
+
+    // Run example on all cameras, printing the messages of the cameras
+    // while they run
+    AsyncLog::start();
+
+    vector<RunResult> runs;
+    try
+    {
+        if (compare)
+        {
+            runs.push_back(RunResult());
+            result = result | RunCameras(camList, false, runs.back());
+        }
+
+        runs.push_back(RunResult());
+        result = result | RunCameras(camList, true, runs.back());
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        cout << "Error: " << e.what() << endl;
+        result = -1;
+    }
+
+    AsyncLog::stop();
+
+    PrintRunResults(runs);
+
+    cout << "Example complete..." << endl << endl;
+
+    // Clear camera list before releasing system
+    camList.Clear();
+
+    // Release system
+    system->ReleaseInstance();
+
+    cout << endl << "Done! Press Enter to exit..." << endl;
+    getchar();
+
+    return result;
+}
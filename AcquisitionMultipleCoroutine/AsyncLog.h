@@ -0,0 +1,513 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief AsyncLog.h is a console log that never makes the thread writing a
+ *  message wait, used by the examples that grab from many cameras at once.
+ *
+ *  Printing with cout << endl from several threads serializes them on the
+ *  stream's lock and flushes the console on every line. Instead, each thread
+ *  formats its messages into a buffer of its own, and a background thread
+ *  collects the messages of all threads every few milliseconds, puts them in
+ *  the order they were logged and prints them in one write.
+ *
+ *  A thread's buffer is a single-producer/single-consumer ring of bytes, so
+ *  logging a message costs the formatting, a copy and a few atomic
+ *  operations; the only lock is taken once per thread, when its buffer is
+ *  created. When a buffer is full because the console cannot keep up, new
+ *  messages are dropped rather than waited for, and the number dropped is
+ *  printed.
+ *
+ *  Messages are logged with ASYNC_LOG(severity, message), where message is
+ *  anything that can follow cout <<. Messages below ASYNC_LOG_LEVEL are
+ *  removed at compile time, arguments included; compile with
+ *  -D ASYNC_LOG_LEVEL=ASYNC_LOG_INFO to leave out the messages printed for
+ *  every frame. Call AsyncLog::flush() before printing to cout directly, so
+ *  the output stays in order, and AsyncLog::stop() before exiting.
+ *
+ *  Each example is self-contained, so this header is copied into every
+ *  example that uses it. The AcquisitionMultipleThread copy is the
+ *  original: change that one, copy it over the others, and run
+ *  make check_copies in AcquisitionMultipleThread to confirm they match.
+ */
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Severities of messages
+#define ASYNC_LOG_DEBUG 0
+#define ASYNC_LOG_INFO 1
+#define ASYNC_LOG_WARNING 2
+#define ASYNC_LOG_ERROR 3
+
+// Messages below this severity are compiled out
+#ifndef ASYNC_LOG_LEVEL
+#define ASYNC_LOG_LEVEL ASYNC_LOG_DEBUG
+#endif
+
+// Size of each thread's buffer; a power of two
+#define ASYNC_LOG_BUFFER_SIZE (64 * 1024)
+
+// How often the background thread prints what was logged, in milliseconds
+#define ASYNC_LOG_DRAIN_INTERVAL_MS 10
+
+// Size of a cache line on the processors the examples run on
+#define ASYNC_LOG_CACHE_LINE 64
+
+// Log a line; the condition is a constant, so the compiler drops messages
+// below ASYNC_LOG_LEVEL along with the code formatting them
+#define ASYNC_LOG(severity, message)                                                                                   \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((severity) >= ASYNC_LOG_LEVEL)                                                                             \
+        {                                                                                                              \
+            std::ostream& asyncLogStream = AsyncLog::beginLine();                                                      \
+            asyncLogStream << message;                                                                                 \
+            AsyncLog::endLine(severity);                                                                               \
+        }                                                                                                              \
+    } while (0)
+
+namespace AsyncLog
+{
+// The messages of one thread, on their way to the background thread
+class Buffer
+{
+  public:
+    Buffer()
+        : m_data(ASYNC_LOG_BUFFER_SIZE), m_head(0), m_cachedTail(0), m_dropped(0), m_tail(0), m_droppedReported(0),
+          m_retired(false)
+    {
+    }
+
+    // Owner thread only: add a message, or count it as dropped if there is
+    // no room
+    void write(int64_t time, int severity, const char* text, size_t length)
+    {
+        const size_t size = recordSize(length);
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+
+        // A record is never split; if it does not fit before the end of the
+        // buffer, the rest of the buffer is skipped
+        const size_t position = static_cast<size_t>(head & (ASYNC_LOG_BUFFER_SIZE - 1));
+        const size_t skip = ASYNC_LOG_BUFFER_SIZE - position < size ? ASYNC_LOG_BUFFER_SIZE - position : 0;
+
+        if (head + skip + size - m_cachedTail > ASYNC_LOG_BUFFER_SIZE)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head + skip + size - m_cachedTail > ASYNC_LOG_BUFFER_SIZE)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        if (skip >= sizeof(Header))
+        {
+            Header wrap = {0, k_wrap, 0};
+            memcpy(m_data.data() + position, &wrap, sizeof(wrap));
+        }
+
+        const size_t start = static_cast<size_t>((head + skip) & (ASYNC_LOG_BUFFER_SIZE - 1));
+        Header header = {time, static_cast<uint32_t>(length), static_cast<uint32_t>(severity)};
+        memcpy(m_data.data() + start, &header, sizeof(header));
+        memcpy(m_data.data() + start + sizeof(header), text, length);
+
+        m_head.store(head + skip + size, std::memory_order_release);
+    }
+
+    // Background thread only: take all messages written so far
+    template <typename Visitor> void read(Visitor& visitor)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+
+        while (tail < head)
+        {
+            const size_t position = static_cast<size_t>(tail & (ASYNC_LOG_BUFFER_SIZE - 1));
+            const size_t rest = ASYNC_LOG_BUFFER_SIZE - position;
+
+            Header header = {0, k_wrap, 0};
+            if (rest >= sizeof(Header))
+            {
+                memcpy(&header, m_data.data() + position, sizeof(header));
+            }
+            if (header.length == k_wrap)
+            {
+                tail += rest;
+                continue;
+            }
+
+            visitor(header.time, static_cast<int>(header.severity), m_data.data() + position + sizeof(header),
+                    static_cast<size_t>(header.length));
+            tail += recordSize(header.length);
+        }
+
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+    // Background thread only: messages dropped because the buffer was full
+    // since the last call
+    uint64_t takeDropped()
+    {
+        const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        const uint64_t count = dropped - m_droppedReported;
+        m_droppedReported = dropped;
+        return count;
+    }
+
+    // Set when the owner thread has exited; the buffer is freed once empty
+    void retire()
+    {
+        m_retired.store(true, std::memory_order_release);
+    }
+
+    bool retired() const
+    {
+        return m_retired.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct Header
+    {
+        int64_t time;
+        uint32_t length;
+        uint32_t severity;
+    };
+
+    static const uint32_t k_wrap = 0xFFFFFFFFu;
+
+    // Records start on 8-byte boundaries, so a header always fits in the
+    // space left at the end of the buffer or not at all
+    static size_t recordSize(size_t length)
+    {
+        return (sizeof(Header) + length + 7) & ~static_cast<size_t>(7);
+    }
+
+    Buffer(const Buffer&);
+    Buffer& operator=(const Buffer&);
+
+    std::vector<char> m_data;
+
+    // Written by the owner thread
+    char m_producerPadding[ASYNC_LOG_CACHE_LINE];
+    std::atomic<uint64_t> m_head;
+    uint64_t m_cachedTail;
+    std::atomic<uint64_t> m_dropped;
+
+    // Written by the background thread
+    char m_consumerPadding[ASYNC_LOG_CACHE_LINE];
+    std::atomic<uint64_t> m_tail;
+    uint64_t m_droppedReported;
+    std::atomic<bool> m_retired;
+    char m_endPadding[ASYNC_LOG_CACHE_LINE];
+};
+
+// Stream buffer that formats a line into memory it keeps between lines
+class LineBuffer : public std::streambuf
+{
+  public:
+    LineBuffer() : m_text(256)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        setp(&m_text[0], &m_text[0] + m_text.size());
+    }
+
+    const char* data() const
+    {
+        return pbase();
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(pptr() - pbase());
+    }
+
+  protected:
+    int_type overflow(int_type ch)
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+            return traits_type::not_eof(ch);
+        }
+
+        const size_t used = size();
+        m_text.resize(m_text.size() * 2);
+        setp(&m_text[0], &m_text[0] + m_text.size());
+        pbump(static_cast<int>(used));
+
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+  private:
+    std::vector<char> m_text;
+};
+
+// Collects the buffers of all threads and prints their messages
+class Logger
+{
+  public:
+    static Logger& instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    ~Logger()
+    {
+        stop();
+    }
+
+    void add(const std::shared_ptr<Buffer>& buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        m_buffers.push_back(buffer);
+    }
+
+    // Start printing in the background; until then messages only collect in
+    // the buffers
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        if (!m_thread.joinable())
+        {
+            m_stopping = false;
+            m_thread = std::thread(&Logger::run, this);
+        }
+    }
+
+    // Print what is left and end the background thread
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        drain();
+    }
+
+    // Print every message logged so far, on the calling thread
+    void drain()
+    {
+        std::lock_guard<std::mutex> drainLock(m_drainMutex);
+
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            buffers = m_buffers;
+        }
+
+        // Take the messages of every thread, then print them in the order
+        // they were logged
+        m_lines.clear();
+        m_text.clear();
+        uint64_t dropped = 0;
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            buffers[i]->read(*this);
+            dropped += buffers[i]->takeDropped();
+        }
+        std::stable_sort(m_lines.begin(), m_lines.end());
+
+        std::string output;
+        for (size_t i = 0; i < m_lines.size(); i++)
+        {
+            output.append(m_text, m_lines[i].offset, m_lines[i].length);
+            output += '\n';
+        }
+        if (dropped > 0)
+        {
+            output += std::to_string(dropped) + " log messages dropped; the console fell behind\n";
+        }
+        if (!output.empty())
+        {
+            std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+            std::cout.flush();
+        }
+
+        // Free the buffers of threads that have exited once they are empty
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (size_t i = 0; i < m_buffers.size();)
+        {
+            if (m_buffers[i]->retired() && m_buffers[i]->empty())
+            {
+                m_buffers.erase(m_buffers.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    // Called by Buffer::read for every message
+    void operator()(int64_t time, int /*severity*/, const char* text, size_t length)
+    {
+        Line line = {time, m_lines.size(), m_text.size(), length};
+        m_lines.push_back(line);
+        m_text.append(text, length);
+    }
+
+  private:
+    struct Line
+    {
+        int64_t time;
+        size_t order;
+        size_t offset;
+        size_t length;
+
+        bool operator<(const Line& other) const
+        {
+            return time < other.time || (time == other.time && order < other.order);
+        }
+    };
+
+    Logger() : m_stopping(false)
+    {
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_threadMutex);
+        while (!m_stopping)
+        {
+            m_wake.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_DRAIN_INTERVAL_MS));
+
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<Buffer>> m_buffers;
+
+    std::mutex m_threadMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+    bool m_stopping;
+
+    // Used while draining only
+    std::mutex m_drainMutex;
+    std::vector<Line> m_lines;
+    std::string m_text;
+};
+
+// What a thread needs to log: its buffer and a stream to format lines with
+class ThreadLog
+{
+  public:
+    ThreadLog() : m_buffer(new Buffer), m_stream(&m_lineBuffer)
+    {
+        m_flags = m_stream.flags();
+        m_precision = m_stream.precision();
+        Logger::instance().add(m_buffer);
+    }
+
+    ~ThreadLog()
+    {
+        m_buffer->retire();
+    }
+
+    // Start a line with the stream formatting the way a fresh cout does
+    std::ostream& begin()
+    {
+        m_lineBuffer.clear();
+        m_stream.flags(m_flags);
+        m_stream.precision(m_precision);
+        m_stream.fill(' ');
+        return m_stream;
+    }
+
+    void end(int severity)
+    {
+        const int64_t time = std::chrono::steady_clock::now().time_since_epoch().count();
+        m_buffer->write(time, severity, m_lineBuffer.data(), m_lineBuffer.size());
+    }
+
+  private:
+    std::shared_ptr<Buffer> m_buffer;
+    LineBuffer m_lineBuffer;
+    std::ostream m_stream;
+    std::ios_base::fmtflags m_flags;
+    std::streamsize m_precision;
+};
+
+inline ThreadLog& threadLog()
+{
+    thread_local ThreadLog log;
+    return log;
+}
+
+inline std::ostream& beginLine()
+{
+    return threadLog().begin();
+}
+
+inline void endLine(int severity)
+{
+    threadLog().end(severity);
+}
+
+inline void start()
+{
+    Logger::instance().start();
+}
+
+inline void flush()
+{
+    Logger::instance().drain();
+}
+
+inline void stop()
+{
+    Logger::instance().stop();
+}
+} // namespace AsyncLog
+
+#endif // ASYNC_LOG_H
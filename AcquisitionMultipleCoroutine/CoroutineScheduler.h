@@ -0,0 +1,519 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief CoroutineScheduler.h runs C++20 coroutines on a small, fixed pool
+ *  of threads and lets them wait for the images of a camera, used by the
+ *  AcquisitionMultipleCoroutine example.
+ *
+ *  A Task is a coroutine handed to a Scheduler with spawn(). The scheduler's
+ *  threads resume whichever tasks are ready; a task that has to wait
+ *  suspends instead of blocking its thread, so a few threads can serve many
+ *  cameras.
+ *
+ *  An ImageStream is the image event handler of one camera. The SDK calls
+ *  it on its own thread for every image; it copies the image into a queue
+ *  and, if a task is waiting in co_await stream.nextImage(...), hands that
+ *  task back to the scheduler. The SDK's thread never runs the task itself,
+ *  so it is back to receiving images right away. A wait can time out: each
+ *  stream has one timer in the scheduler, armed for every wait and disarmed
+ *  when an image arrives first, so waiting allocates nothing and leaves no
+ *  expired deadlines behind.
+ */
+
+#ifndef COROUTINE_SCHEDULER_H
+#define COROUTINE_SCHEDULER_H
+
+#include "Spinnaker.h"
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Scheduler;
+
+// A coroutine run by a Scheduler; it starts once spawned and frees itself
+// when it finishes
+class Task
+{
+  public:
+    struct promise_type
+    {
+        Scheduler* scheduler = nullptr;
+
+        Task get_return_object()
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // Wait for spawn() to hand the task to a scheduler
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+            void await_resume() noexcept
+            {
+            }
+        };
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        // Tasks catch what they expect, as a thread would
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    ~Task()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+  private:
+    friend class Scheduler;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle)
+    {
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+//
+// Fixed pool of threads that resume tasks
+//
+// *** NOTES ***
+// Ready tasks wait in one queue shared by all threads. A thread with
+// nothing to resume sleeps until a task is queued or the earliest armed
+// timer is due; a due timer runs its callback on the thread that finds it.
+// There is a timer per camera rather than per wait, so finding the earliest
+// is a scan of a few dozen timers.
+//
+class Scheduler
+{
+  public:
+    // Runs a callback on one of the threads once its deadline passes. The
+    // timer is created once and armed again for every deadline; it must be
+    // destroyed before the scheduler.
+    class Timer
+    {
+      public:
+        Timer(Scheduler& scheduler, std::function<void()> callback)
+            : m_scheduler(scheduler), m_callback(std::move(callback)),
+              m_deadline(std::chrono::steady_clock::time_point::max()), m_running(0)
+        {
+            std::lock_guard<std::mutex> lock(m_scheduler.m_mutex);
+            m_scheduler.m_timers.push_back(this);
+        }
+
+        // Waits for the callback if it is running
+        ~Timer()
+        {
+            std::unique_lock<std::mutex> lock(m_scheduler.m_mutex);
+            m_scheduler.m_done.wait(lock, [this] { return m_running == 0; });
+            m_scheduler.m_timers.erase(std::find(m_scheduler.m_timers.begin(), m_scheduler.m_timers.end(), this));
+        }
+
+        // Replaces the deadline, if the timer was already armed
+        void arm(std::chrono::steady_clock::time_point deadline)
+        {
+            bool earliest = true;
+            {
+                std::lock_guard<std::mutex> lock(m_scheduler.m_mutex);
+                m_deadline = deadline;
+                for (size_t i = 0; i < m_scheduler.m_timers.size(); i++)
+                {
+                    earliest = earliest && !(m_scheduler.m_timers[i]->m_deadline < deadline);
+                }
+            }
+
+            // A sleeping thread may have to wake up earlier than it planned
+            if (earliest)
+            {
+                m_scheduler.m_wake.notify_one();
+            }
+        }
+
+        void disarm()
+        {
+            std::lock_guard<std::mutex> lock(m_scheduler.m_mutex);
+            m_deadline = std::chrono::steady_clock::time_point::max();
+        }
+
+      private:
+        friend class Scheduler;
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        Scheduler& m_scheduler;
+        const std::function<void()> m_callback;
+
+        // Guarded by the scheduler's mutex; max() when not armed
+        std::chrono::steady_clock::time_point m_deadline;
+        unsigned int m_running;
+    };
+
+    explicit Scheduler(unsigned int numThreads) : m_active(0), m_resumes(0), m_stopping(false)
+    {
+        for (unsigned int i = 0; i < numThreads; i++)
+        {
+            m_threads.push_back(std::thread(&Scheduler::run, this));
+        }
+    }
+
+    // Ends the threads; tasks still suspended are left as they are
+    ~Scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (size_t i = 0; i < m_threads.size(); i++)
+        {
+            m_threads[i].join();
+        }
+    }
+
+    unsigned int threadCount() const
+    {
+        return static_cast<unsigned int>(m_threads.size());
+    }
+
+    // Start a task on the pool
+    void spawn(Task&& task)
+    {
+        std::coroutine_handle<Task::promise_type> handle = std::exchange(task.m_handle, nullptr);
+        handle.promise().scheduler = this;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active++;
+        }
+        post(handle);
+    }
+
+    // Queue a suspended coroutine to be resumed by one of the threads
+    void post(std::coroutine_handle<> handle)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.push_back(handle);
+        }
+        m_wake.notify_one();
+    }
+
+    // Wait until every spawned task has finished
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_active == 0; });
+    }
+
+    // Number of times a task was resumed, starts included
+    uint64_t resumeCount() const
+    {
+        return m_resumes.load(std::memory_order_relaxed);
+    }
+
+  private:
+    friend struct Task::promise_type::FinalAwaiter;
+
+    void taskFinished()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0)
+        {
+            m_done.notify_all();
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            Timer* timer = nullptr;
+            for (size_t i = 0; i < m_timers.size(); i++)
+            {
+                if (timer == nullptr || m_timers[i]->m_deadline < timer->m_deadline)
+                {
+                    timer = m_timers[i];
+                }
+            }
+            if (timer != nullptr && timer->m_deadline == std::chrono::steady_clock::time_point::max())
+            {
+                timer = nullptr;
+            }
+
+            if (!m_ready.empty())
+            {
+                std::coroutine_handle<> handle = m_ready.front();
+                m_ready.pop_front();
+
+                lock.unlock();
+                m_resumes.fetch_add(1, std::memory_order_relaxed);
+                handle.resume();
+                lock.lock();
+            }
+            else if (timer != nullptr && timer->m_deadline <= std::chrono::steady_clock::now())
+            {
+                timer->m_deadline = std::chrono::steady_clock::time_point::max();
+                timer->m_running++;
+
+                lock.unlock();
+                timer->m_callback();
+                lock.lock();
+
+                // The timer's owner may be waiting to destroy it
+                if (--timer->m_running == 0)
+                {
+                    m_done.notify_all();
+                }
+            }
+            else if (m_stopping)
+            {
+                return;
+            }
+            else if (timer == nullptr)
+            {
+                m_wake.wait(lock);
+            }
+            else
+            {
+                m_wake.wait_until(lock, timer->m_deadline);
+            }
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::vector<Timer*> m_timers;
+    unsigned int m_active;
+    std::atomic<uint64_t> m_resumes;
+    bool m_stopping;
+};
+
+// The task is done with once it reaches its end; the scheduler has to be
+// read before the coroutine is freed along with the promise
+inline void Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+{
+    Scheduler* scheduler = handle.promise().scheduler;
+    handle.destroy();
+    scheduler->taskFinished();
+}
+
+// An image received from a camera; image is a copy, and null for an
+// incomplete image
+struct StreamImage
+{
+    Spinnaker::ImagePtr image;
+    uint64_t frameId = 0;
+    bool incomplete = false;
+    Spinnaker::ImageStatus status = Spinnaker::SPINNAKER_IMAGE_STATUS_NO_ERROR;
+    std::chrono::steady_clock::time_point received;
+};
+
+// Image event handler of one camera that tasks can wait on
+class ImageStream : public Spinnaker::ImageEventHandler
+{
+  public:
+    // At most maxQueued images wait to be taken; beyond that the oldest is
+    // dropped, as the SDK's thread must not wait for the task
+    ImageStream(Scheduler& scheduler, size_t maxQueued)
+        : m_scheduler(scheduler), m_maxQueued(maxQueued), m_dropped(0), m_timeout(scheduler, [this] { expire(); })
+    {
+    }
+
+    // Called by the SDK on its own thread for every image
+    void OnImageEvent(Spinnaker::ImagePtr image)
+    {
+        StreamImage received;
+        received.frameId = image->GetFrameID();
+        received.incomplete = image->IsIncomplete();
+        received.status = image->GetImageStatus();
+        received.received = std::chrono::steady_clock::now();
+
+        // The image belongs to the SDK again once this returns
+        if (!received.incomplete)
+        {
+            received.image = Spinnaker::Image::Create(image);
+        }
+
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_images.size() >= m_maxQueued)
+            {
+                m_images.pop_front();
+                m_dropped++;
+            }
+            m_images.push_back(std::move(received));
+            waiter = std::exchange(m_waiter, nullptr);
+            if (waiter)
+            {
+                m_timeout.disarm();
+            }
+        }
+
+        if (waiter)
+        {
+            m_scheduler.post(waiter);
+        }
+    }
+
+    // Awaiting this takes the next image into image and yields true, or
+    // yields false if none arrived before the timeout
+    class NextImage
+    {
+      public:
+        NextImage(ImageStream& stream, StreamImage& image, std::chrono::milliseconds timeout)
+            : m_stream(stream), m_image(image), m_timeout(timeout)
+        {
+        }
+
+        bool await_ready()
+        {
+            return false;
+        }
+
+        // Suspend unless an image is already waiting. Once the handle is
+        // published another thread may resume the task, so nothing of the
+        // awaiter is touched after that.
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            ImageStream& stream = m_stream;
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + m_timeout;
+
+            std::lock_guard<std::mutex> lock(stream.m_mutex);
+            if (!stream.m_images.empty())
+            {
+                return false;
+            }
+            stream.m_waiter = handle;
+            stream.m_deadline = deadline;
+            stream.m_timeout.arm(deadline);
+            return true;
+        }
+
+        bool await_resume()
+        {
+            std::lock_guard<std::mutex> lock(m_stream.m_mutex);
+            if (m_stream.m_images.empty())
+            {
+                return false;
+            }
+            m_image = std::move(m_stream.m_images.front());
+            m_stream.m_images.pop_front();
+            return true;
+        }
+
+      private:
+        ImageStream& m_stream;
+        StreamImage& m_image;
+        const std::chrono::milliseconds m_timeout;
+    };
+
+    NextImage nextImage(StreamImage& image, std::chrono::milliseconds timeout)
+    {
+        return NextImage(*this, image, timeout);
+    }
+
+    // Images dropped because the task fell maxQueued images behind
+    uint64_t droppedCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_dropped;
+    }
+
+  private:
+    // Resume the task if its wait has timed out. The timer may have fired
+    // just as an image ended that wait and the task started the next one,
+    // which has a later deadline and is left alone.
+    void expire()
+    {
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_waiter && m_deadline <= std::chrono::steady_clock::now())
+            {
+                waiter = std::exchange(m_waiter, nullptr);
+            }
+        }
+
+        if (waiter)
+        {
+            m_scheduler.post(waiter);
+        }
+    }
+
+    Scheduler& m_scheduler;
+    const size_t m_maxQueued;
+
+    std::mutex m_mutex;
+    std::deque<StreamImage> m_images;
+    std::coroutine_handle<> m_waiter;
+    std::chrono::steady_clock::time_point m_deadline;
+    uint64_t m_dropped;
+
+    // Last, so it is destroyed first, waiting for expire() if it is running
+    Scheduler::Timer m_timeout;
+};
+
+#endif // COROUTINE_SCHEDULER_H
@@ -25,6 +25,32 @@
  *  This example is similar to the Acquisition example, except that threads
  *  are used to allow for simultaneous acquisitions.
  *
+ *  The grab thread of each camera only retrieves images and queues them. A
+ *  pool of encoder threads shared by all cameras converts the queued images
+ *  and saves them as JPEG, so the time it takes to encode an image does not
+ *  limit the frame rate of the cameras. Images are handed over through a
+ *  lock-free ring per camera (see FrameRing.h), so a grab thread never waits
+ *  for a lock held by an encoder. Each encoder prefers the rings of its own
+ *  cameras and steals work from the others when it runs out. When the
+ *  encoders fall far behind, the grab thread waits for them, or with
+ *  --overwrite-oldest drops the oldest image not yet saved. The queue depth
+ *  and the latency from grab to saved file are reported per camera, and
+ *  --benchmark-ring measures what handing over a frame costs. The grab and
+ *  encoder threads print through an asynchronous log (see AsyncLog.h), so
+ *  they never wait on each other or on the console either; the messages
+ *  printed for every image can be compiled out with
+ *  -D ASYNC_LOG_LEVEL=ASYNC_LOG_INFO.
+ *
+ *  On machines with several processor sockets, the grab threads can be kept
+ *  on the socket of the network card the cameras are connected to (see
+ *  ThreadAffinity.h). --nic IFACE or --numa-node N pins each grab thread to a
+ *  core of that NUMA node in turn and has it allocate its memory, including
+ *  the stream buffers the camera fills, from the node. --grab-cpus and
+ *  --encoder-cpus choose the cores explicitly; the encoders are only pinned
+ *  when asked to. The topology and the choices made are printed first, and
+ *  the frames each camera dropped are reported at the end, so placements can
+ *  be compared.
+ *
  *  Please leave us feedback at: https://www.surveymonkey.com/r/TDYMVAPI
  *  More source code examples at: https://github.com/Teledyne-MV/Spinnaker-Examples
  *  Need help? Check out our forum at: https://teledynevisionsolutions.zendesk.com/hc/en-us/community/topics
@@ -32,8 +58,19 @@
 
 #include "Spinnaker.h"
 #include "SpinGenApi/SpinnakerGenApi.h"
+#include "AsyncLog.h"
+#include "FrameRing.h"
+#include "ThreadAffinity.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <stdint.h>
+#include <thread>
+#include <vector>
 
 #ifndef _WIN32
 #include <pthread.h>
@@ -44,6 +81,278 @@ using namespace Spinnaker::GenApi;
 using namespace Spinnaker::GenICam;
 using namespace std;
 
+// Number of images acquired from each camera
+const unsigned int k_numImages = 10;
+
+// Number of encoder threads shared by all cameras; 0 uses one per processor
+// core
+const unsigned int k_numEncoderThreads = 0;
+
+// Most images of a camera waiting to be encoded; beyond that its grab thread
+// waits for the encoders to catch up instead of using more memory
+const unsigned int k_maxQueuedImages = 32;
+
+// Drop the oldest waiting image of a camera instead of waiting when the
+// encoders fall k_maxQueuedImages behind; set with --overwrite-oldest
+bool overwriteOldest = false;
+
+// Frames handed over in each measurement of --benchmark-ring
+const unsigned int k_ringBenchmarkFrames = 1000000;
+
+// Cores the grab threads are pinned to, one core per camera in turn; set
+// with --grab-cpus, or from the NUMA node. Empty leaves them unpinned.
+vector<int> grabCpus;
+
+// Cores the encoder threads are pinned to, one core per thread in turn; set
+// with --encoder-cpus. Empty leaves them unpinned.
+vector<int> encoderCpus;
+
+// NUMA node the grab threads allocate memory from, -1 for no preference;
+// set with --numa-node, or from the node of the interface given with --nic
+int grabNode = -1;
+string nicName;
+
+// State of one camera, shared by its grab thread and the encoders
+struct CameraContext
+{
+    CameraPtr pCam;
+    unsigned int cameraIndex;
+    std::string serialNumber;
+
+    // Images grabbed but not yet taken by an encoder. Only the grab thread
+    // pushes; the encoders pop one at a time, whichever holds consuming.
+    std::unique_ptr<FrameRing<FrameHandle>> ring;
+    std::atomic<bool> consuming;
+
+    // Written by the grab thread only: the most images there have been in
+    // the ring, and how long the grab thread waited for room in it
+    unsigned int maxQueueDepth;
+    double queueWaitSeconds;
+
+    // Time from the image being grabbed to it being saved, guarded by mutex
+    std::mutex mutex;
+    unsigned int imagesSaved;
+    double totalLatencySeconds;
+    double maxLatencySeconds;
+
+    // Written by the grab thread only: the frame IDs it received, to count
+    // the frames that never arrived, and the stream's own counts of lost and
+    // dropped frames (-1 if the stream does not have them)
+    unsigned int imagesReceived;
+    uint64_t firstFrameId;
+    uint64_t lastFrameId;
+    int64_t streamLostFrames;
+    int64_t streamDroppedFrames;
+
+    CameraContext()
+        : cameraIndex(0), ring(new FrameRing<FrameHandle>(k_maxQueuedImages, overwriteOldest)), consuming(false),
+          maxQueueDepth(0), queueWaitSeconds(0.0), imagesSaved(0), totalLatencySeconds(0.0), maxLatencySeconds(0.0),
+          imagesReceived(0), firstFrameId(0), lastFrameId(0), streamLostFrames(-1), streamDroppedFrames(-1)
+    {
+    }
+};
+
+void EncodeImage(ImageProcessor& processor, CameraContext& camera, const FrameHandle& frame);
+
+//
+// Pool of threads that encode the images of all cameras
+//
+// *** NOTES ***
+// Every camera has its own ring of images (see FrameRing.h), so handing an
+// image over never makes a grab thread wait for a lock. Each thread takes
+// images from the rings of its own cameras first, so it keeps working on the
+// cameras it knows, and steals from the rings of the other cameras when
+// those are empty. That way a burst from one camera is spread over all
+// threads. A ring has a single consumer, so a thread takes from a ring only
+// while it holds the camera's consuming flag; a thread that finds the flag
+// taken moves on to the next camera instead of waiting.
+//
+// Threads with nothing to do sleep until an image is queued. The grab
+// threads only take the lock to wake them up when one of them is asleep.
+//
+class EncoderPool
+{
+  public:
+    // Each thread is pinned to one of the cores in turn, if any are given
+    EncoderPool(unsigned int numThreads, const vector<int>& cpus, CameraContext* cameras, unsigned int numCameras)
+        : m_cpus(cpus), m_cameras(cameras), m_numCameras(numCameras), m_numThreads(numThreads), m_sleeping(0),
+          m_stolen(0), m_stopping(false)
+    {
+        for (unsigned int i = 0; i < numThreads; i++)
+        {
+            m_threads.push_back(std::thread(&EncoderPool::run, this, i));
+        }
+    }
+
+    ~EncoderPool()
+    {
+        stop();
+    }
+
+    unsigned int threadCount() const
+    {
+        return m_numThreads;
+    }
+
+    // Called by a grab thread after it pushed an image into its camera's ring
+    void imageQueued()
+    {
+        // Pairs with the fence in run(): either the sleeping thread sees the
+        // image, or this sees the thread asleep and wakes it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_workAvailable.notify_one();
+        }
+    }
+
+    // Encode what is still queued, then end the threads; the grab threads
+    // must have finished
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+
+        for (size_t i = 0; i < m_threads.size(); i++)
+        {
+            m_threads[i].join();
+        }
+        m_threads.clear();
+    }
+
+    // Images encoded by a thread other than the one their camera belongs to
+    unsigned int stolenCount() const
+    {
+        return m_stolen.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // Take the next image of the thread's own cameras, or steal one. The
+    // cameras are scanned from a different one each time, so a busy camera
+    // cannot starve the others.
+    CameraContext* take(unsigned int worker, unsigned int& start, FrameHandle& frame)
+    {
+        start++;
+        for (int steal = 0; steal < 2; steal++)
+        {
+            for (unsigned int n = 0; n < m_numCameras; n++)
+            {
+                const unsigned int i = (start + n) % m_numCameras;
+                CameraContext& camera = m_cameras[i];
+                if ((i % m_numThreads == worker) == (steal != 0) ||
+                    camera.consuming.exchange(true, std::memory_order_acquire))
+                {
+                    continue;
+                }
+
+                const bool taken = camera.ring->pop(frame);
+                camera.consuming.store(false, std::memory_order_release);
+
+                if (taken)
+                {
+                    if (steal != 0)
+                    {
+                        m_stolen.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return &camera;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    bool hasWork() const
+    {
+        for (unsigned int i = 0; i < m_numCameras; i++)
+        {
+            if (m_cameras[i].ring->size() > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(unsigned int worker)
+    {
+        if (!m_cpus.empty())
+        {
+            const int cpu = m_cpus[worker % m_cpus.size()];
+            if (ThreadAffinity::pinCurrentThread(vector<int>(1, cpu)))
+            {
+                ASYNC_LOG(ASYNC_LOG_INFO, "Encoder thread " << worker << " pinned to CPU " << cpu << ", running on CPU "
+                                                            << ThreadAffinity::currentCpu());
+            }
+            else
+            {
+                ASYNC_LOG(ASYNC_LOG_WARNING, "Unable to pin encoder thread " << worker << " to CPU " << cpu
+                                                                             << ". Continuing unpinned...");
+            }
+        }
+
+        //
+        // Create ImageProcessor instance for post processing images
+        //
+        // *** NOTES ***
+        // Each encoder has its own processor, so the threads never wait on one
+        // another to convert.
+        //
+        ImageProcessor processor;
+
+        //
+        // Set default image processor color processing method
+        //
+        // *** NOTES ***
+        // By default, if no specific color processing algorithm Is set, the image
+        // processor will default to NEAREST_NEIGHBOR method.
+        //
+        processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+
+        FrameHandle frame;
+        unsigned int start = worker;
+        while (true)
+        {
+            CameraContext* camera = take(worker, start, frame);
+            if (camera != nullptr)
+            {
+                EncodeImage(processor, *camera, frame);
+                frame.image = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_workAvailable.wait(lock, [this] { return hasWork() || m_stopping; });
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+
+            if (m_stopping && !hasWork())
+            {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    const vector<int> m_cpus;
+    CameraContext* m_cameras;
+    const unsigned int m_numCameras;
+    const unsigned int m_numThreads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::atomic<unsigned int> m_sleeping;
+    std::atomic<unsigned int> m_stolen;
+    bool m_stopping;
+};
+
+// Pool shared by the grab threads of all cameras
+EncoderPool* encoderPool = nullptr;
+
 // This function prints the device information of the camera from the transport
 // layer; please see NodeMapInfo example for more in-depth comments on printing
 // device information from the nodemap.
@@ -51,7 +360,8 @@ int PrintDeviceInfo(INodeMap& nodeMap, std::string camSerial)
 {
     int result = 0;
 
-    cout << "[" << camSerial << "] Printing device information ..." << endl << endl;
+    ASYNC_LOG(ASYNC_LOG_INFO, "[" << camSerial << "] Printing device information ...");
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
 
     try
     {
@@ -67,25 +377,25 @@ int PrintDeviceInfo(INodeMap& nodeMap, std::string camSerial)
                 try
                 {
                     CNodePtr pfeatureNode = *it;
-                    cout << pfeatureNode->GetName() << " : ";
                     CValuePtr pValue = (CValuePtr)pfeatureNode;
-                    cout << (IsReadable(pValue) ? pValue->ToString() : "Node not readable");
-                    cout << endl;
+                    ASYNC_LOG(ASYNC_LOG_INFO, pfeatureNode->GetName()
+                                                  << " : "
+                                                  << (IsReadable(pValue) ? pValue->ToString() : "Node not readable"));
                 }
                 catch (Spinnaker::Exception)
                 {
-                    cout << "Node not readable" << endl;
+                    ASYNC_LOG(ASYNC_LOG_INFO, "Node not readable");
                 }
             }
         }
         else
         {
-            cout << "Device control information not readable." << endl;
+            ASYNC_LOG(ASYNC_LOG_INFO, "Device control information not readable.");
         }
     }
     catch (Spinnaker::Exception& e)
     {
-        cout << "Error: " << e.what() << endl;
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << e.what());
         result = -1;
     }
 
@@ -129,21 +439,16 @@ int ConfigureGVCPHeartbeat(CameraPtr pCam, bool enableHeartbeat)
         return 0;
     }
 
-    if (enableHeartbeat)
-    {
-        cout << endl << "Resetting heartbeat..." << endl << endl;
-    }
-    else
-    {
-        cout << endl << "Disabling heartbeat..." << endl << endl;
-    }
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
+    ASYNC_LOG(ASYNC_LOG_INFO, (enableHeartbeat ? "Resetting heartbeat..." : "Disabling heartbeat..."));
+    ASYNC_LOG(ASYNC_LOG_INFO, "");
 
     CBooleanPtr ptrDeviceHeartbeat = nodeMap.GetNode("GevGVCPHeartbeatDisable");
     if (!IsWritable(ptrDeviceHeartbeat))
     {
-        cout << "Unable to configure heartbeat. Continuing with execution as this may be non-fatal..."
-            << endl
-            << endl;
+        ASYNC_LOG(ASYNC_LOG_WARNING,
+                  "Unable to configure heartbeat. Continuing with execution as this may be non-fatal...");
+        ASYNC_LOG(ASYNC_LOG_WARNING, "");
     }
     else
     {
@@ -151,14 +456,15 @@ int ConfigureGVCPHeartbeat(CameraPtr pCam, bool enableHeartbeat)
 
         if (!enableHeartbeat)
         {
-            cout << "WARNING: Heartbeat has been disabled for the rest of this example run." << endl;
-            cout << "         Heartbeat will be reset upon the completion of this run.  If the " << endl;
-            cout << "         example is aborted unexpectedly before the heartbeat is reset, the" << endl;
-            cout << "         camera may need to be power cycled to reset the heartbeat." << endl << endl;
+            ASYNC_LOG(ASYNC_LOG_WARNING, "WARNING: Heartbeat has been disabled for the rest of this example run.");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         Heartbeat will be reset upon the completion of this run.  If the ");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         example is aborted unexpectedly before the heartbeat is reset, the");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "         camera may need to be power cycled to reset the heartbeat.");
+            ASYNC_LOG(ASYNC_LOG_WARNING, "");
         }
         else
         {
-            cout << "Heartbeat has been reset." << endl;
+            ASYNC_LOG(ASYNC_LOG_INFO, "Heartbeat has been reset.");
         }
     }
 
@@ -175,15 +481,147 @@ int DisableGVCPHeartbeat(CameraPtr pCam)
     return ConfigureGVCPHeartbeat(pCam, false);
 }
 
-// This function acquires and saves 10 images from a camera.
+// This function converts a queued image to mono 8 and saves it; it runs on
+// the encoder threads.
+void EncodeImage(ImageProcessor& processor, CameraContext& camera, const FrameHandle& frame)
+{
+    try
+    {
+        // Convert image to mono 8
+        ImagePtr convertedImage = processor.Convert(frame.image, PixelFormat_Mono8);
+
+        // Create a unique filename
+        std::ostringstream filename;
+
+        filename << "AcquisitionMultipleThread-";
+        if (camera.serialNumber != "")
+        {
+            filename << camera.serialNumber.c_str();
+        }
+
+        filename << "-" << frame.imageCnt << ".jpg";
+
+        // Save image
+        convertedImage->Save(filename.str().c_str());
+
+        const double latency = chrono::duration<double>(chrono::steady_clock::now() - frame.grabbed).count();
+
+        ASYNC_LOG(ASYNC_LOG_DEBUG,
+                  "[" << camera.serialNumber << "] "
+                      << "Image " << frame.imageCnt << " saved at " << filename.str() << ", " << latency * 1000.0
+                      << " ms after it was grabbed");
+
+        std::lock_guard<std::mutex> lock(camera.mutex);
+        camera.imagesSaved++;
+        camera.totalLatencySeconds += latency;
+        if (latency > camera.maxLatencySeconds)
+        {
+            camera.maxLatencySeconds = latency;
+        }
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        ASYNC_LOG(ASYNC_LOG_ERROR, "[" << camera.serialNumber << "] "
+                                       << "Error: " << e.what());
+    }
+}
+
+// This function hands an image to the encoders and returns the number of
+// images of the camera that are now waiting. If the encoders have fallen
+// k_maxQueuedImages behind, it waits until they catch up, unless the oldest
+// waiting image is to be dropped instead.
+unsigned int QueueImage(CameraContext& camera, const FrameHandle& frame)
+{
+    if (!camera.ring->push(frame))
+    {
+        // The encoders have fallen far behind, so there is no hurry to
+        // notice when they catch up
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        do
+        {
+            encoderPool->imageQueued();
+            this_thread::sleep_for(chrono::milliseconds(1));
+        } while (!camera.ring->push(frame));
+
+        camera.queueWaitSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    encoderPool->imageQueued();
+
+    const unsigned int queueDepth = static_cast<unsigned int>(camera.ring->size());
+    if (queueDepth > camera.maxQueueDepth)
+    {
+        camera.maxQueueDepth = queueDepth;
+    }
+    return queueDepth;
+}
+
+// This function pins the calling grab thread to its camera's core and makes
+// it allocate memory from the chosen NUMA node.
+void PinGrabThread(const CameraContext& camera)
+{
+    //
+    // Pin the thread before the camera is initialized
+    //
+    // *** NOTES ***
+    // Memory is placed on a node when it is allocated, or at the latest when
+    // it is first written to. The stream buffers the camera's images arrive
+    // in are allocated when acquisition begins, on this thread, so the
+    // memory policy has to be in place by then to keep them next to the
+    // network card.
+    //
+    if (!grabCpus.empty())
+    {
+        const int cpu = grabCpus[camera.cameraIndex % grabCpus.size()];
+        if (ThreadAffinity::pinCurrentThread(vector<int>(1, cpu)))
+        {
+            ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                          << "Grab thread pinned to CPU " << cpu << ", running on CPU "
+                                          << ThreadAffinity::currentCpu());
+        }
+        else
+        {
+            ASYNC_LOG(ASYNC_LOG_WARNING, "[" << camera.serialNumber << "] "
+                                             << "Unable to pin grab thread to CPU " << cpu
+                                             << ". Continuing unpinned...");
+        }
+    }
+
+    if (grabNode >= 0)
+    {
+        if (ThreadAffinity::preferNodeMemory(grabNode))
+        {
+            ASYNC_LOG(ASYNC_LOG_INFO, "[" << camera.serialNumber << "] "
+                                          << "Grab thread allocates memory from NUMA node " << grabNode);
+        }
+        else
+        {
+            ASYNC_LOG(ASYNC_LOG_WARNING, "[" << camera.serialNumber << "] "
+                                             << "Unable to allocate memory from NUMA node " << grabNode
+                                             << ". Continuing...");
+        }
+    }
+}
+
+// This function reads a frame counter of the stream, or returns -1 if the
+// stream does not have it.
+int64_t ReadStreamCounter(INodeMap& nodeMapTLStream, const char* name)
+{
+    CIntegerPtr ptrCounter = nodeMapTLStream.GetNode(name);
+    return IsReadable(ptrCounter) ? ptrCounter->GetValue() : -1;
+}
+
+// This function acquires 10 images from a camera and queues them to be saved.
 #if defined(_WIN32)
 DWORD WINAPI AcquireImages(LPVOID lpParam)
 {
-    CameraPtr pCam = *((CameraPtr*)lpParam);
+    CameraContext& camera = *((CameraContext*)lpParam);
+    CameraPtr pCam = camera.pCam;
 #else
 void* AcquireImages(void* arg)
 {
-    CameraPtr pCam = *((CameraPtr*)arg);
+    CameraContext& camera = *((CameraContext*)arg);
+    CameraPtr pCam = camera.pCam;
 #endif
 
     try
@@ -201,11 +639,16 @@ void* AcquireImages(void* arg)
             serialNumber = ptrStringSerial->GetValue();
         }
 
-        cout << endl
-             << "[" << serialNumber << "] "
-             << "*** IMAGE ACQUISITION THREAD STARTING"
-             << " ***" << endl
-             << endl;
+        // The encoders name the files after the camera
+        camera.serialNumber = serialNumber;
+
+        PinGrabThread(camera);
+
+        ASYNC_LOG(ASYNC_LOG_INFO, "");
+        ASYNC_LOG(ASYNC_LOG_INFO, "[" << serialNumber << "] "
+                                      << "*** IMAGE ACQUISITION THREAD STARTING"
+                                      << " ***");
+        ASYNC_LOG(ASYNC_LOG_INFO, "");
 
         // Print device information
         PrintDeviceInfo(nodeMapTLDevice, serialNumber);
@@ -236,9 +679,9 @@ void* AcquireImages(void* arg)
         if (!IsReadable(ptrAcquisitionMode) ||
             !IsWritable(ptrAcquisitionMode))
         {
-            cout << "Unable to set acquisition mode to continuous (node retrieval; camera " << serialNumber
-                 << "). Aborting..." << endl
-                 << endl;
+            ASYNC_LOG(ASYNC_LOG_ERROR, "Unable to set acquisition mode to continuous (node retrieval; camera "
+                                           << serialNumber << "). Aborting...");
+            ASYNC_LOG(ASYNC_LOG_ERROR, "");
 #if defined(_WIN32)
             return 0;
 #else
@@ -249,9 +692,9 @@ void* AcquireImages(void* arg)
         CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
         if (!IsReadable(ptrAcquisitionModeContinuous))
         {
-            cout << "Unable to get acquisition mode to continuous (entry 'continuous' retrieval " << serialNumber
-                 << "). Aborting..." << endl
-                 << endl;
+            ASYNC_LOG(ASYNC_LOG_ERROR, "Unable to get acquisition mode to continuous (entry 'continuous' retrieval "
+                                           << serialNumber << "). Aborting...");
+            ASYNC_LOG(ASYNC_LOG_ERROR, "");
 #if defined(_WIN32)
             return 0;
 #else
@@ -263,35 +706,29 @@ void* AcquireImages(void* arg)
 
         ptrAcquisitionMode->SetIntValue(acquisitionModeContinuous);
 
-        cout << "[" << serialNumber << "] "
-             << "Acquisition mode set to continuous..." << endl;
+        ASYNC_LOG(ASYNC_LOG_INFO, "[" << serialNumber << "] "
+                                      << "Acquisition mode set to continuous...");
 
         // Begin acquiring images
         pCam->BeginAcquisition();
 
-        cout << "[" << serialNumber << "] "
-             << "Started acquiring images..." << endl;
-
-        //
-        // Retrieve, convert, and save images for each camera
-        //
-        const unsigned int k_numImages = 10;
-
-        //
-        // Create ImageProcessor instance for post processing images
-        //
-        ImageProcessor processor;
+        ASYNC_LOG(ASYNC_LOG_INFO, "[" << serialNumber << "] "
+                                      << "Started acquiring images...");
 
         //
-        // Set default image processor color processing method
+        // Retrieve images for each camera and queue them to be converted and
+        // saved
         //
         // *** NOTES ***
-        // By default, if no specific color processing algorithm Is set, the image
-        // processor will default to NEAREST_NEIGHBOR method.
+        // Converting and saving an image as JPEG can take longer than the
+        // time between two frames. Doing it here would hold up the next
+        // GetNextImage and need more stream buffers to avoid losing frames,
+        // so the encoder threads do it instead. Messages go through the
+        // asynchronous log (see AsyncLog.h) for the same reason: printing
+        // to the console directly would make the grab threads wait on each
+        // other and on the console.
         //
-        processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
-
-        cout << endl;
+        ASYNC_LOG(ASYNC_LOG_INFO, "");
 
         for (unsigned int imageCnt = 0; imageCnt < k_numImages; imageCnt++)
         {
@@ -300,49 +737,59 @@ void* AcquireImages(void* arg)
                 // Retrieve next received image and ensure image completion
                 ImagePtr pResultImage = pCam->GetNextImage(1000);
 
+                // Keep track of the frame IDs to count the frames that were dropped
+                if (camera.imagesReceived++ == 0)
+                {
+                    camera.firstFrameId = pResultImage->GetFrameID();
+                }
+                camera.lastFrameId = pResultImage->GetFrameID();
+
                 if (pResultImage->IsIncomplete())
                 {
-                    cout << "[" << serialNumber << "] "
-                         << "Image incomplete with image status " << pResultImage->GetImageStatus() << "..." << endl
-                         << endl;
+                    ASYNC_LOG(ASYNC_LOG_WARNING, "[" << serialNumber << "] "
+                                                     << "Image incomplete with image status "
+                                                     << pResultImage->GetImageStatus() << "...");
+                    ASYNC_LOG(ASYNC_LOG_WARNING, "");
+
+                    // Release image
+                    pResultImage->Release();
                 }
                 else
                 {
-                    // Convert image to mono 8
-                    ImagePtr convertedImage = processor.Convert(pResultImage, PixelFormat_Mono8);
-
-                    // Create a unique filename
-                    std::ostringstream filename;
-
-                    filename << "AcquisitionMultipleThread-";
-                    if (serialNumber != "")
-                    {
-                        filename << serialNumber.c_str();
-                    }
+                    FrameHandle frame;
+                    frame.imageCnt = imageCnt;
+                    frame.frameId = pResultImage->GetFrameID();
+                    frame.grabbed = chrono::steady_clock::now();
 
-                    filename << "-" << imageCnt << ".jpg";
+                    // Copy the image and release the buffer right away, so the
+                    // stream never runs short of buffers while the encoders
+                    // are busy
+                    frame.image = Image::Create(pResultImage);
+                    pResultImage->Release();
 
-                    // Save image
-                    convertedImage->Save(filename.str().c_str());
+                    const unsigned int queueDepth = QueueImage(camera, frame);
 
                     // Print image information
-                    cout << "[" << serialNumber << "] "
-                         << "Grabbed image " << imageCnt << ", width = " << pResultImage->GetWidth()
-                         << ", height = " << pResultImage->GetHeight() << ". Image saved at " << filename.str() << endl;
+                    ASYNC_LOG(ASYNC_LOG_DEBUG, "[" << serialNumber << "] "
+                                                   << "Grabbed image " << imageCnt << ", width = "
+                                                   << frame.image->GetWidth() << ", height = "
+                                                   << frame.image->GetHeight() << ". Queued for saving, "
+                                                   << queueDepth << " images waiting");
+                    ASYNC_LOG(ASYNC_LOG_DEBUG, "");
                 }
-
-                // Release image
-                pResultImage->Release();
-
-                cout << endl;
             }
             catch (Spinnaker::Exception& e)
             {
-                cout << "[" << serialNumber << "] "
-                     << "Error: " << e.what() << endl;
+                ASYNC_LOG(ASYNC_LOG_ERROR, "[" << serialNumber << "] "
+                                               << "Error: " << e.what());
             }
         }
 
+        // Read the stream's frame counters while it is still running
+        INodeMap& nodeMapTLStream = pCam->GetTLStreamNodeMap();
+        camera.streamLostFrames = ReadStreamCounter(nodeMapTLStream, "StreamLostFrameCount");
+        camera.streamDroppedFrames = ReadStreamCounter(nodeMapTLStream, "StreamDroppedFrameCount");
+
         // End acquisition
         pCam->EndAcquisition();
             
@@ -362,7 +809,7 @@ void* AcquireImages(void* arg)
     }
     catch (Spinnaker::Exception& e)
     {
-        cout << "Error: " << e.what() << endl;
+        ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << e.what());
 #if defined(_WIN32)
         return 0;
 #else
@@ -371,6 +818,110 @@ void* AcquireImages(void* arg)
     }
 }
 
+// This function prints the NUMA nodes of the machine and where the grab and
+// encoder threads will run.
+void PrintTopology(unsigned int numCameras, unsigned int numEncoderThreads)
+{
+    cout << endl << "*** THREAD PLACEMENT ***" << endl << endl;
+
+    const vector<ThreadAffinity::NumaNode> nodes = ThreadAffinity::numaNodes();
+    if (nodes.empty())
+    {
+        cout << "NUMA topology not available" << endl;
+    }
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        cout << "NUMA node " << nodes[i].id << ": CPUs " << ThreadAffinity::formatCpuList(nodes[i].cpus) << endl;
+    }
+
+    if (!nicName.empty())
+    {
+        cout << "Network interface " << nicName << ": ";
+        if (grabNode >= 0)
+        {
+            cout << "NUMA node " << grabNode << endl;
+        }
+        else
+        {
+            cout << "NUMA node not known" << endl;
+        }
+    }
+
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        cout << "Grab thread of camera " << i << ": ";
+        if (grabCpus.empty())
+        {
+            cout << "any CPU";
+        }
+        else
+        {
+            cout << "CPU " << grabCpus[i % grabCpus.size()];
+        }
+        if (grabNode >= 0)
+        {
+            cout << ", memory from node " << grabNode;
+        }
+        cout << endl;
+    }
+
+    cout << numEncoderThreads << " encoder threads: "
+         << (encoderCpus.empty() ? "any CPU" : "CPUs " + ThreadAffinity::formatCpuList(encoderCpus)) << endl
+         << endl;
+}
+
+// This function prints the frames each camera dropped, how far the encoders
+// fell behind it and how long its images took from being grabbed to being
+// saved.
+void PrintCameraStatistics(CameraContext* cameras, unsigned int numCameras)
+{
+    cout << endl
+         << "*** CAMERA STATISTICS ***" << endl
+         << endl
+         << encoderPool->threadCount() << " encoder threads, " << encoderPool->stolenCount()
+         << " images stolen from the queue of another thread" << endl;
+
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        const CameraContext& camera = cameras[i];
+
+        cout << "[" << camera.serialNumber << "] " << camera.imagesSaved << " images saved, queue depth peaked at "
+             << camera.maxQueueDepth << "/" << camera.ring->capacity();
+        if (camera.ring->overwritten() > 0)
+        {
+            cout << ", " << camera.ring->overwritten() << " images dropped unsaved";
+        }
+        if (camera.queueWaitSeconds > 0.0)
+        {
+            cout << ", grab thread waited " << camera.queueWaitSeconds * 1000.0 << " ms for the encoders";
+        }
+        if (camera.imagesSaved > 0)
+        {
+            cout << ", latency mean " << camera.totalLatencySeconds * 1000.0 / camera.imagesSaved << " ms, max "
+                 << camera.maxLatencySeconds * 1000.0 << " ms";
+        }
+        cout << endl;
+
+        // Frames between the first and the last one received that never
+        // arrived; frame IDs that went backwards mean the camera restarted
+        if (camera.imagesReceived > 0 && camera.lastFrameId >= camera.firstFrameId)
+        {
+            const uint64_t expected = camera.lastFrameId - camera.firstFrameId + 1;
+            const uint64_t missing = expected > camera.imagesReceived ? expected - camera.imagesReceived : 0;
+
+            cout << "[" << camera.serialNumber << "] " << camera.imagesReceived << " of " << expected
+                 << " frames received, drop rate " << 100.0 * missing / expected << "%";
+            if (camera.streamLostFrames >= 0 || camera.streamDroppedFrames >= 0)
+            {
+                cout << " (stream lost " << camera.streamLostFrames << ", dropped " << camera.streamDroppedFrames
+                     << ")";
+            }
+            cout << endl;
+        }
+    }
+    cout << endl;
+}
+
 // This function acts as the body of the example
 int RunMultipleCameras(CameraList camList)
 {
@@ -382,11 +933,27 @@ int RunMultipleCameras(CameraList camList)
         // Retrieve camera list size
         camListSize = camList.GetSize();
 
-        // Create an array of CameraPtrs. This array maintenances smart pointer's reference
+        // Create an array of camera contexts. This array maintenances smart pointer's reference
         // count when CameraPtr is passed into grab thread as void pointer
+        CameraContext* cameras = new CameraContext[camListSize];
+
+        // Start the encoders before any image is grabbed; by default there is
+        // one for each core they may run on
+        unsigned int numEncoderThreads = k_numEncoderThreads;
+        if (numEncoderThreads == 0 && !encoderCpus.empty())
+        {
+            numEncoderThreads = static_cast<unsigned int>(encoderCpus.size());
+        }
+        if (numEncoderThreads == 0)
+        {
+            numEncoderThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        }
+
+        PrintTopology(camListSize, numEncoderThreads);
+
+        encoderPool = new EncoderPool(numEncoderThreads, encoderCpus, cameras, camListSize);
 
         // Create an array of handles
-        CameraPtr* pCamList = new CameraPtr[camListSize];
 #if defined(_WIN32)
         HANDLE* grabThreads = new HANDLE[camListSize];
 #else
@@ -396,13 +963,14 @@ int RunMultipleCameras(CameraList camList)
         for (unsigned int i = 0; i < camListSize; i++)
         {
             // Select camera
-            pCamList[i] = camList.GetByIndex(i);
+            cameras[i].pCam = camList.GetByIndex(i);
+            cameras[i].cameraIndex = i;
             // Start grab thread
 #if defined(_WIN32)
-            grabThreads[i] = CreateThread(nullptr, 0, AcquireImages, &pCamList[i], 0, nullptr);
+            grabThreads[i] = CreateThread(nullptr, 0, AcquireImages, &cameras[i], 0, nullptr);
             assert(grabThreads[i] != nullptr);
 #else
-            int err = pthread_create(&(grabThreads[i]), nullptr, &AcquireImages, &pCamList[i]);
+            int err = pthread_create(&(grabThreads[i]), nullptr, &AcquireImages, &cameras[i]);
             assert(err == 0);
 #endif
         }
@@ -424,15 +992,14 @@ int RunMultipleCameras(CameraList camList)
             BOOL rc = GetExitCodeThread(grabThreads[i], &exitcode);
             if (!rc)
             {
-                cout << "Handle error from GetExitCodeThread() returned for camera at index " << i << endl;
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Handle error from GetExitCodeThread() returned for camera at index " << i);
                 result = -1;
             }
             else if (!exitcode)
             {
-                cout << "Grab thread for camera at index " << i
-                     << " exited with errors."
-                        "Please check onscreen print outs for error details"
-                     << endl;
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Grab thread for camera at index "
+                                               << i << " exited with errors."
+                                               << "Please check onscreen print outs for error details");
                 result = -1;
             }
         }
@@ -445,31 +1012,40 @@ int RunMultipleCameras(CameraList camList)
             int rc = pthread_join(grabThreads[i], &exitcode);
             if (rc != 0)
             {
-                cout << "Handle error from pthread_join returned for camera at index " << i << endl;
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Handle error from pthread_join returned for camera at index " << i);
                 result = -1;
             }
             else if ((int)(intptr_t)exitcode == 0) // check thread return code for each camera
             {
-                cout << "Grab thread for camera at index " << i
-                     << " exited with errors."
-                        "Please check onscreen print outs for error details"
-                     << endl;
+                ASYNC_LOG(ASYNC_LOG_ERROR, "Grab thread for camera at index "
+                                               << i << " exited with errors."
+                                               << "Please check onscreen print outs for error details");
                 result = -1;
             }
         }
 #endif
 
+        // Wait for the encoders to save the images still queued, and for
+        // their messages to be printed
+        encoderPool->stop();
+        AsyncLog::flush();
+
+        PrintCameraStatistics(cameras, camListSize);
+
+        delete encoderPool;
+        encoderPool = nullptr;
+
         // Clear CameraPtr array and close all handles
         for (unsigned int i = 0; i < camListSize; i++)
         {
-            pCamList[i] = 0;
+            cameras[i].pCam = 0;
 #if defined(_WIN32)
             CloseHandle(grabThreads[i]);
 #endif
         }
 
         // Delete array pointer
-        delete[] pCamList;
+        delete[] cameras;
 
         // Delete array pointer
         delete[] grabThreads;
@@ -483,10 +1059,233 @@ int RunMultipleCameras(CameraList camList)
     return result;
 }
 
+// A queue of frames guarded by a mutex, the usual alternative to a lock-free
+// ring, to compare with in the benchmark
+class LockedFrameQueue
+{
+  public:
+    explicit LockedFrameQueue(size_t capacity) : m_capacity(capacity)
+    {
+    }
+
+    bool push(const FrameHandle& frame)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_frames.size() == m_capacity)
+        {
+            return false;
+        }
+        m_frames.push_back(frame);
+        return true;
+    }
+
+    bool pop(FrameHandle& frame)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_frames.empty())
+        {
+            return false;
+        }
+        frame = m_frames.front();
+        m_frames.pop_front();
+        return true;
+    }
+
+  private:
+    const size_t m_capacity;
+    std::mutex m_mutex;
+    std::deque<FrameHandle> m_frames;
+};
+
+// This function hands k_ringBenchmarkFrames frames from one thread to
+// another through a queue and returns the time per frame in nanoseconds. If
+// sameThread is set, one thread pushes and pops each frame in turn instead,
+// which measures the cost of the operations without any waiting.
+template <typename Queue> double MeasureHandoff(Queue& queue, const ImagePtr& image, bool sameThread)
+{
+    FrameHandle frame;
+    frame.image = image;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    if (sameThread)
+    {
+        FrameHandle received;
+        for (unsigned int i = 0; i < k_ringBenchmarkFrames; i++)
+        {
+            frame.imageCnt = i;
+            queue.push(frame);
+            queue.pop(received);
+        }
+    }
+    else
+    {
+        // A ring that overwrites the oldest frame may drop frames, so the
+        // consumer runs until the last one arrives, which is never dropped
+        std::thread consumer([&queue] {
+            FrameHandle received;
+            do
+            {
+                while (!queue.pop(received))
+                {
+                    this_thread::yield();
+                }
+            } while (received.imageCnt != k_ringBenchmarkFrames - 1);
+        });
+
+        for (unsigned int i = 0; i < k_ringBenchmarkFrames; i++)
+        {
+            frame.imageCnt = i;
+            while (!queue.push(frame))
+            {
+                this_thread::yield();
+            }
+        }
+        consumer.join();
+    }
+
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / k_ringBenchmarkFrames;
+}
+
+//
+// Measure the cost of handing a frame from a grab thread to an encoder
+//
+// *** NOTES ***
+// Each frame is a FrameHandle holding a reference to an image, as in the
+// example, so the reference counting of ImagePtr is part of the cost. The
+// lock-free ring is compared with a deque guarded by a mutex. Between two
+// threads the time per frame includes the waiting when one thread runs ahead
+// of the other; on a machine with a single core it is mostly the time the
+// threads take to switch.
+//
+int BenchmarkFrameRing()
+{
+    cout << endl << "*** FRAME HANDOFF BENCHMARK ***" << endl << endl;
+
+    ImagePtr image = Image::Create();
+
+    cout << k_ringBenchmarkFrames << " frames, queues of " << k_maxQueuedImages << " frames, "
+         << std::thread::hardware_concurrency() << " cores" << endl
+         << endl;
+
+    for (int sameThread = 1; sameThread >= 0; sameThread--)
+    {
+        FrameRing<FrameHandle> ring(k_maxQueuedImages, false);
+        FrameRing<FrameHandle> overwritingRing(k_maxQueuedImages, true);
+        LockedFrameQueue lockedQueue(k_maxQueuedImages);
+
+        const char* mode = sameThread ? "one thread " : "two threads";
+        cout << "Lock-free ring, " << mode << "                  : " << MeasureHandoff(ring, image, sameThread != 0)
+             << " ns per frame" << endl;
+        cout << "Lock-free ring, overwrite oldest, " << mode << ": "
+             << MeasureHandoff(overwritingRing, image, sameThread != 0) << " ns per frame" << endl;
+        cout << "Mutex and deque, " << mode << "                 : "
+             << MeasureHandoff(lockedQueue, image, sameThread != 0) << " ns per frame" << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
+
+// This function prints the command line options of the example.
+void PrintUsage()
+{
+    cout << "Usage: AcquisitionMultipleThread [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "--nic IFACE           : Run the grab threads on the NUMA node of network interface IFACE (Linux)" << endl;
+    cout << "--numa-node N         : Run the grab threads on NUMA node N (Linux)" << endl;
+    cout << "--grab-cpus LIST      : Pin the grab thread of each camera to the next core of LIST, like 2-5,8" << endl;
+    cout << "--encoder-cpus LIST   : Pin the encoder threads to the cores of LIST, one thread per core" << endl;
+    cout << "--overwrite-oldest    : Drop the oldest unsaved image instead of waiting when the encoders fall "
+         << k_maxQueuedImages << " images behind" << endl;
+    cout << "--benchmark-ring      : Measure the cost of handing a frame to the encoders and exit" << endl;
+    cout << "--help                : Print this message" << endl;
+}
+
+// This function resolves the NUMA node given on the command line into the
+// cores the grab threads run on; returns false if the node is not known.
+bool ResolveGrabNode()
+{
+    if (!nicName.empty() && grabNode < 0)
+    {
+        grabNode = ThreadAffinity::networkInterfaceNode(nicName);
+        if (grabNode < 0)
+        {
+            cout << "NUMA node of network interface " << nicName
+                 << " not known; the grab threads will not be pinned to it." << endl;
+            return true;
+        }
+    }
+
+    if (grabNode >= 0 && grabCpus.empty())
+    {
+        grabCpus = ThreadAffinity::nodeCpus(grabNode);
+        if (grabCpus.empty())
+        {
+            cout << "NUMA node " << grabNode << " has no CPUs or does not exist. Aborting..." << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 // Example entry point; please see Enumeration example for more in-depth
 // comments on preparing and cleaning up the system.
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
+    bool benchmarkRing = false;
+
+    // Change arguments to string for easy read
+    vector<string> args(argv, argv + argc);
+
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        const bool hasValue = i + 1 < args.size();
+
+        if (args[i] == "--nic" && hasValue)
+        {
+            nicName = args[++i];
+        }
+        else if (args[i] == "--numa-node" && hasValue && !args[i + 1].empty() &&
+                 args[i + 1].find_first_not_of("0123456789") == string::npos)
+        {
+            grabNode = atoi(args[++i].c_str());
+        }
+        else if (args[i] == "--grab-cpus" && hasValue && ThreadAffinity::parseCpuList(args[i + 1], grabCpus))
+        {
+            i++;
+        }
+        else if (args[i] == "--encoder-cpus" && hasValue && ThreadAffinity::parseCpuList(args[i + 1], encoderCpus))
+        {
+            i++;
+        }
+        else if (args[i] == "--overwrite-oldest")
+        {
+            overwriteOldest = true;
+        }
+        else if (args[i] == "--benchmark-ring")
+        {
+            benchmarkRing = true;
+        }
+        else
+        {
+            PrintUsage();
+            return args[i] == "--help" ? 0 : -1;
+        }
+    }
+
+    // The benchmark does not need a camera
+    if (benchmarkRing)
+    {
+        return BenchmarkFrameRing();
+    }
+
+    if (!ResolveGrabNode())
+    {
+        return -1;
+    }
+
     // Since this application saves images in the current folder
     // we must ensure that we have permission to write to this folder.
     // If we do not have permission, fail right away.
@@ -542,8 +1341,13 @@ int main(int /*argc*/, char** /*argv*/)
     // Run example on all cameras
     cout << endl << "Running example for all cameras..." << endl;
 
+    // Print the messages of the camera threads while they run
+    AsyncLog::start();
+
     result = RunMultipleCameras(camList);
 
+    AsyncLog::stop();
+
     cout << "Example complete..." << endl << endl;
 
     // Clear camera list before releasing system
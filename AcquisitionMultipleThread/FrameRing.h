@@ -0,0 +1,295 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief FrameRing.h is a lock-free ring that hands frames from the thread
+ *  that acquires them to the thread that processes them, used by the
+ *  AcquisitionMultipleThread and ImageEvents examples.
+ *
+ *  The ring has one producer and one consumer. Neither ever takes a lock or
+ *  waits for the other: push always finishes in a fixed number of steps, so
+ *  handing a frame over costs the acquiring thread a few atomic operations
+ *  no matter what the processing thread is doing. So does pop, except that
+ *  in overwrite-oldest mode it tries again for every frame the producer drops
+ *  while it is taking one. The positions written by
+ *  the producer and by the consumer are kept on separate cache lines, so the
+ *  two threads do not slow each other down by writing to the same line, and
+ *  each side keeps a private copy of the other's position that it only
+ *  refreshes when the ring looks full or empty.
+ *
+ *  A full ring either refuses the new frame or, in overwrite-oldest mode,
+ *  drops the oldest frame the consumer has not taken yet, so a slow consumer
+ *  always gets the most recent frames. To make that possible the frames are
+ *  not stored in the ring itself: the ring holds the indices of frame slots,
+ *  and the consumer gives each slot back through a second, internal ring once
+ *  it has copied the frame out. The producer then only ever writes to a slot
+ *  nobody else is reading, even while it drops frames.
+ *
+ *  Each example is self-contained, so this header is copied into every
+ *  example that uses it. The AcquisitionMultipleThread copy is the
+ *  original: change that one, copy it over the others, and run
+ *  make check_copies in AcquisitionMultipleThread to confirm they match.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "Spinnaker.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// Size of a cache line on the processors the examples run on
+#define FRAME_RING_CACHE_LINE 64
+
+// An image handed from the thread that grabbed it to the thread that
+// processes it
+struct FrameHandle
+{
+    Spinnaker::ImagePtr image;
+    unsigned int imageCnt;
+    uint64_t frameId;
+    std::chrono::steady_clock::time_point grabbed;
+
+    FrameHandle() : imageCnt(0), frameId(0)
+    {
+    }
+};
+
+template <typename Frame> class FrameRing
+{
+  public:
+    // The capacity is rounded up to a power of two
+    FrameRing(size_t capacity, bool overwriteOldest)
+        : m_slotCount(roundUp(capacity)), m_frameCount(m_slotCount + 1), m_freeCount(roundUp(m_frameCount)),
+          m_overwriteOldest(overwriteOldest), m_frames(m_frameCount), m_slots(new std::atomic<uint32_t>[m_slotCount]),
+          m_free(m_freeCount), m_head(0), m_cachedTail(0), m_freeTail(0), m_cachedFreeHead(m_frameCount),
+          m_overwritten(0), m_tail(0), m_cachedHead(0), m_freeHead(m_frameCount)
+    {
+        for (size_t i = 0; i < m_slotCount; i++)
+        {
+            m_slots[i].store(0, std::memory_order_relaxed);
+        }
+
+        // Every frame slot starts out free
+        for (size_t i = 0; i < m_frameCount; i++)
+        {
+            m_free[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Producer only: add a frame. Returns false if the ring is full, which
+    // never happens in overwrite-oldest mode.
+    bool push(const Frame& frame)
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail >= m_slotCount)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+
+        uint32_t index;
+        if (head - m_cachedTail < m_slotCount)
+        {
+            index = takeFreeSlot();
+        }
+        else if (!m_overwriteOldest)
+        {
+            return false;
+        }
+        else
+        {
+            // Drop the oldest frame and reuse its slot, unless the consumer
+            // takes that frame first; then there is room anyway
+            uint64_t tail = m_cachedTail;
+            const uint32_t oldest = m_slots[tail & (m_slotCount - 1)].load(std::memory_order_relaxed);
+            if (m_tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                m_cachedTail = tail + 1;
+                m_overwritten.fetch_add(1, std::memory_order_relaxed);
+                index = oldest;
+            }
+            else
+            {
+                m_cachedTail = tail;
+                index = takeFreeSlot();
+            }
+        }
+
+        m_frames[index] = frame;
+        m_slots[head & (m_slotCount - 1)].store(index, std::memory_order_release);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: take the oldest frame. Returns false if the ring is
+    // empty.
+    bool pop(Frame& frame)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        while (true)
+        {
+            // The producer may have moved the tail past the cached head by
+            // dropping frames
+            if (tail >= m_cachedHead)
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail >= m_cachedHead)
+                {
+                    return false;
+                }
+            }
+
+            const uint32_t index = m_slots[tail & (m_slotCount - 1)].load(std::memory_order_acquire);
+
+            // Only in overwrite-oldest mode can the producer move the tail;
+            // if it did, the frame was dropped and the next one is tried
+            if (!m_overwriteOldest)
+            {
+                m_tail.store(tail + 1, std::memory_order_release);
+            }
+            else if (!m_tail.compare_exchange_strong(
+                         tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            // Copy the frame out and let go of the ring's reference to it
+            // before giving the slot back
+            frame = m_frames[index];
+            m_frames[index] = Frame();
+
+            const uint64_t freeHead = m_freeHead.load(std::memory_order_relaxed);
+            m_free[freeHead & (m_freeCount - 1)] = index;
+            m_freeHead.store(freeHead + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    // Frames waiting in the ring; exact only on the producer or the
+    // consumer thread while the other one is idle
+    size_t size() const
+    {
+        const uint64_t tail = m_tail.load(std::memory_order_acquire);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+
+    size_t capacity() const
+    {
+        return m_slotCount;
+    }
+
+    // Frames dropped to make room for newer ones
+    uint64_t overwritten() const
+    {
+        return m_overwritten.load(std::memory_order_relaxed);
+    }
+
+    // Before C++17, new ignores alignment beyond that of the largest standard
+    // type, so the ring allocates its own; rings that are not on the stack
+    // are created with new and held by pointer
+    static void* operator new(size_t size)
+    {
+        void* memory = NULL;
+#if defined(_WIN32)
+        memory = _aligned_malloc(size, FRAME_RING_CACHE_LINE);
+#else
+        if (posix_memalign(&memory, FRAME_RING_CACHE_LINE, size) != 0)
+        {
+            memory = NULL;
+        }
+#endif
+        if (memory == NULL)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    static void operator delete(void* memory)
+    {
+#if defined(_WIN32)
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+
+  private:
+    static size_t roundUp(size_t count)
+    {
+        size_t rounded = 1;
+        while (rounded < count)
+        {
+            rounded *= 2;
+        }
+        return rounded;
+    }
+
+    // There is always a free slot when the ring is not full: there is one
+    // more slot than the ring holds, and the consumer holds at most one
+    uint32_t takeFreeSlot()
+    {
+        if (m_freeTail == m_cachedFreeHead)
+        {
+            m_cachedFreeHead = m_freeHead.load(std::memory_order_acquire);
+        }
+        return m_free[m_freeTail++ & (m_freeCount - 1)];
+    }
+
+    FrameRing(const FrameRing&);
+    FrameRing& operator=(const FrameRing&);
+
+    const size_t m_slotCount;
+    const size_t m_frameCount;
+    const size_t m_freeCount;
+    const bool m_overwriteOldest;
+    std::vector<Frame> m_frames;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_slots;
+    std::vector<uint32_t> m_free;
+
+    //
+    // Written by the producer
+    //
+    // *** NOTES ***
+    // The alignment starts the producer's and the consumer's positions on
+    // cache lines of their own, so the two threads never write to the same
+    // line.
+    //
+    alignas(FRAME_RING_CACHE_LINE) std::atomic<uint64_t> m_head;
+    uint64_t m_cachedTail;
+    uint64_t m_freeTail;
+    uint64_t m_cachedFreeHead;
+    std::atomic<uint64_t> m_overwritten;
+
+    // Written by the consumer, and by the producer when it drops a frame
+    alignas(FRAME_RING_CACHE_LINE) std::atomic<uint64_t> m_tail;
+    uint64_t m_cachedHead;
+    std::atomic<uint64_t> m_freeHead;
+};
+
+#endif // FRAME_RING_H
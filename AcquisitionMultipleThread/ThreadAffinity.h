@@ -0,0 +1,255 @@
+//=============================================================================
+// Copyright (c) 2025 FLIR Integrated Imaging Solutions, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief ThreadAffinity.h reads the NUMA topology of the machine and pins
+ *  threads to processor cores, used by the AcquisitionMultipleThread example.
+ *
+ *  On a machine with several processor sockets, every socket has its own
+ *  memory and its own PCIe devices; each such group is a NUMA node. A grab
+ *  thread that the scheduler moves to another socket than the network card's
+ *  reads every image over the link between the sockets, and competes with
+ *  the threads of that socket for it. Pinning the thread to cores of the
+ *  card's node, and having it allocate its memory there, keeps the images on
+ *  the node they arrive on.
+ *
+ *  The topology is read from sysfs, threads are pinned with
+ *  pthread_setaffinity_np and the memory policy is set with the set_mempolicy
+ *  system call, so libnuma is not needed. Only Linux is supported; elsewhere
+ *  the topology is empty and pinning fails, leaving threads where the
+ *  operating system puts them.
+ */
+
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+// Memory policy of set_mempolicy that allocates from one node while it has
+// free memory, and from the others after that
+#define THREAD_AFFINITY_MPOL_PREFERRED 1
+
+namespace ThreadAffinity
+{
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// Parse a list of cores in the kernel's format, like "0-3,8,10-11"
+inline bool parseCpuList(const std::string& text, std::vector<int>& cpus)
+{
+    cpus.clear();
+
+    std::istringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        const size_t dash = range.find('-');
+        const std::string firstText = range.substr(0, dash);
+        const std::string lastText = dash == std::string::npos ? firstText : range.substr(dash + 1);
+        if (firstText.empty() || lastText.empty() ||
+            firstText.find_first_not_of("0123456789") != std::string::npos ||
+            lastText.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        const int first = atoi(firstText.c_str());
+        const int last = atoi(lastText.c_str());
+        if (last < first)
+        {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return !cpus.empty();
+}
+
+// The reverse of parseCpuList
+inline std::string formatCpuList(const std::vector<int>& cpus)
+{
+    std::ostringstream text;
+    for (size_t i = 0; i < cpus.size();)
+    {
+        size_t end = i + 1;
+        while (end < cpus.size() && cpus[end] == cpus[end - 1] + 1)
+        {
+            end++;
+        }
+
+        text << (i > 0 ? "," : "") << cpus[i];
+        if (end - i > 1)
+        {
+            text << "-" << cpus[end - 1];
+        }
+        i = end;
+    }
+    return text.str();
+}
+
+// The NUMA nodes of the machine with their cores, in order; empty if the
+// topology is not known
+inline std::vector<NumaNode> numaNodes()
+{
+    std::vector<NumaNode> nodes;
+
+#if defined(__linux__)
+    DIR* directory = opendir("/sys/devices/system/node");
+    if (directory == NULL)
+    {
+        return nodes;
+    }
+
+    for (struct dirent* entry = readdir(directory); entry != NULL; entry = readdir(directory))
+    {
+        const std::string name = entry->d_name;
+        if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos)
+        {
+            continue;
+        }
+
+        NumaNode node;
+        node.id = atoi(name.c_str() + 4);
+
+        std::ifstream cpuList(("/sys/devices/system/node/" + name + "/cpulist").c_str());
+        std::string text;
+        if (std::getline(cpuList, text))
+        {
+            parseCpuList(text, node.cpus);
+        }
+
+        // Keep the nodes sorted by id
+        std::vector<NumaNode>::iterator position = nodes.begin();
+        while (position != nodes.end() && position->id < node.id)
+        {
+            ++position;
+        }
+        nodes.insert(position, node);
+    }
+    closedir(directory);
+#endif
+
+    return nodes;
+}
+
+// The cores of a node; empty if it does not exist
+inline std::vector<int> nodeCpus(int node)
+{
+    const std::vector<NumaNode> nodes = numaNodes();
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].id == node)
+        {
+            return nodes[i].cpus;
+        }
+    }
+    return std::vector<int>();
+}
+
+// The node a network interface is attached to, or -1 if it is not known,
+// as for virtual interfaces and machines with a single node
+inline int networkInterfaceNode(const std::string& interfaceName)
+{
+    int node = -1;
+
+#if defined(__linux__)
+    std::ifstream file(("/sys/class/net/" + interfaceName + "/device/numa_node").c_str());
+    if (!(file >> node))
+    {
+        node = -1;
+    }
+#else
+    (void)interfaceName;
+#endif
+
+    return node;
+}
+
+// Restrict the calling thread to the given cores
+inline bool pinCurrentThread(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < cpus.size(); i++)
+    {
+        if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        CPU_SET(cpus[i], &set);
+    }
+
+    return !cpus.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// Make the memory the calling thread allocates from now on come from a node,
+// as long as it has free memory
+inline bool preferNodeMemory(int node)
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    const unsigned long bitsPerWord = 8 * sizeof(unsigned long);
+    if (node < 0 || node >= static_cast<int>(16 * bitsPerWord))
+    {
+        return false;
+    }
+
+    unsigned long mask[16] = {0};
+    mask[node / bitsPerWord] = 1ul << (node % bitsPerWord);
+    return syscall(SYS_set_mempolicy, THREAD_AFFINITY_MPOL_PREFERRED, mask, 16 * bitsPerWord + 1) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+// The core the calling thread is running on, or -1 if it is not known; logged
+// after pinning so the placement can be checked
+inline int currentCpu()
+{
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+} // namespace ThreadAffinity
+
+#endif // THREAD_AFFINITY_H
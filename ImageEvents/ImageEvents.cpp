@@ -31,6 +31,12 @@
  *	define any properties, parameters, and the event itself while ImageEventHandler
  *	allows the child class to appropriately interface with Spinnaker.
  *
+ *	OnImageEvent() runs on a thread of the library and holds it up for as long
+ *	as it takes, so it only copies each image and hands it to the main thread
+ *	through a lock-free ring (see FrameRing.h). The main thread converts and
+ *	saves the images. If it falls behind, the ring drops the oldest image it
+ *	has not taken yet, so the event handler never waits.
+ *
  *  Please leave us feedback at: https://www.surveymonkey.com/r/TDYMVAPI
  *  More source code examples at: https://github.com/Teledyne-MV/Spinnaker-Examples
  *  Need help? Check out our forum at: https://teledynevisionsolutions.zendesk.com/hc/en-us/community/topics
@@ -38,6 +44,9 @@
 
 #include "Spinnaker.h"
 #include "SpinGenApi/SpinnakerGenApi.h"
+#include "FrameRing.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 
@@ -71,6 +80,8 @@ class ImageEventHandlerImpl : public ImageEventHandler
     // The constructor retrieves the serial number and initializes the image
     // counter to 0.
     ImageEventHandlerImpl(CameraPtr pCam)
+        : m_ring(new FrameRing<FrameHandle>(mk_ringCapacity, true)), m_imagesReceived(0), m_handoffNanoseconds(0),
+          m_stopped(false)
     {
         // Retrieve device serial number
         INodeMap& nodeMap = pCam->GetTLDeviceNodeMap();
@@ -103,16 +114,14 @@ class ImageEventHandlerImpl : public ImageEventHandler
     }
 
     // This method defines an image event. In it, the image that triggered the
-    // event is converted and saved before incrementing the count. Please see
-    // Acquisition_CSharp example for more in-depth comments on the acquisition
-    // of images.
+    // event is copied and handed to the main thread, which converts and saves
+    // it. Please see Acquisition_CSharp example for more in-depth comments on
+    // the acquisition of images.
     void OnImageEvent(ImagePtr image)
     {
-        // Save a maximum of 10 images
-        if (m_imageCnt < mk_numImages)
+        // Hand over images until 10 have been saved
+        if (!m_stopped.load(memory_order_acquire))
         {
-            cout << "Image event occurred..." << endl;
-
             // Check image retrieval status
             if (image->IsIncomplete())
             {
@@ -120,31 +129,84 @@ class ImageEventHandlerImpl : public ImageEventHandler
             }
             else
             {
-                // Print image information
-                cout << "Grabbed image " << m_imageCnt << ", width = " << image->GetWidth()
-                     << ", height = " << image->GetHeight() << endl;
+                //
+                // Copy the image and hand it over
+                //
+                // *** NOTES ***
+                // The image belongs to the library again once this method
+                // returns, so it is copied. Pushing the copy into the ring
+                // never waits for the main thread; the time it takes is
+                // measured to show what handing over an image costs.
+                //
+                FrameHandle frame;
+                frame.image = Image::Create(image);
+                frame.imageCnt = m_imagesReceived++;
+                frame.frameId = image->GetFrameID();
+                frame.grabbed = chrono::steady_clock::now();
+
+                m_ring->push(frame);
+
+                m_handoffNanoseconds += static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - frame.grabbed).count());
+            }
+        }
+    }
+
+    // This method converts and saves the oldest image handed over by the
+    // event, if there is one, and increments the count. It runs on the main
+    // thread.
+    bool saveNextImage()
+    {
+        FrameHandle frame;
+        if (m_imageCnt >= mk_numImages || !m_ring->pop(frame))
+        {
+            return false;
+        }
 
-                // Convert image to mono 8
-                ImagePtr convertedImage = m_processor.Convert(image, PixelFormat_Mono8);
+        // Print image information
+        cout << "Grabbed image " << m_imageCnt << ", width = " << frame.image->GetWidth()
+             << ", height = " << frame.image->GetHeight() << endl;
 
-                // Create a unique filename and save image
-                ostringstream filename;
+        // Convert image to mono 8
+        ImagePtr convertedImage = m_processor.Convert(frame.image, PixelFormat_Mono8);
 
-                filename << "ImageEvents-";
-                if (m_deviceSerialNumber != "")
-                {
-                    filename << m_deviceSerialNumber.c_str() << "-";
-                }
-                filename << m_imageCnt << ".jpg";
+        // Create a unique filename and save image
+        ostringstream filename;
 
-                convertedImage->Save(filename.str().c_str());
+        filename << "ImageEvents-";
+        if (m_deviceSerialNumber != "")
+        {
+            filename << m_deviceSerialNumber.c_str() << "-";
+        }
+        filename << m_imageCnt << ".jpg";
 
-                cout << "Image saved at " << filename.str() << endl << endl;
+        convertedImage->Save(filename.str().c_str());
 
-                // Increment image counter
-                m_imageCnt++;
-            }
+        cout << "Image saved at " << filename.str() << endl << endl;
+
+        // Increment image counter
+        m_imageCnt++;
+
+        // Stop handing over images once all have been saved
+        if (m_imageCnt == mk_numImages)
+        {
+            m_stopped.store(true, memory_order_release);
+        }
+        return true;
+    }
+
+    // This method prints how many images the main thread did not keep up
+    // with and what handing an image over cost the event.
+    void printHandoffStatistics()
+    {
+        cout << "Images handed over: " << m_imagesReceived << ", dropped before they were saved: "
+             << m_ring->overwritten() << endl;
+        if (m_imagesReceived > 0)
+        {
+            cout << "Handing over an image took " << m_handoffNanoseconds / m_imagesReceived << " ns on average"
+                 << endl;
         }
+        cout << endl;
     }
 
     // Getter for image counter
@@ -161,9 +223,19 @@ class ImageEventHandlerImpl : public ImageEventHandler
 
   private:
     static const unsigned int mk_numImages = 10;
+    static const unsigned int mk_ringCapacity = 8;
     unsigned int m_imageCnt;
     string m_deviceSerialNumber;
     ImageProcessor m_processor;
+
+    // Images handed from the event to the main thread, and what only the
+    // event touches: the number of images and the time spent pushing them
+    std::unique_ptr<FrameRing<FrameHandle>> m_ring;
+    unsigned int m_imagesReceived;
+    uint64_t m_handoffNanoseconds;
+
+    // Set by the main thread once all images have been saved
+    atomic<bool> m_stopped;
 };
 
 // This function configures the example to execute image events by preparing and
@@ -222,18 +294,18 @@ int WaitForImages(ImageEventHandlerImpl*& imageEventHandler)
         //
         // *** NOTES ***
         // In order to passively capture images using image events and
-        // automatic polling, the main thread sleeps in increments of 200 ms
-        // until 10 images have been acquired and saved.
+        // automatic polling, the main thread saves the images the event
+        // hands over, and sleeps in increments of 1 ms whenever there is
+        // none, until 10 images have been acquired and saved.
         //
-        const int sleepDuration = 200; // in milliseconds
+        const int sleepDuration = 1; // in milliseconds
 
         while (imageEventHandler->getImageCount() < imageEventHandler->getMaxImages())
         {
-            cout << "\t//" << endl;
-            cout << "\t// Sleeping for " << sleepDuration << " ms. Grabbing images..." << endl;
-            cout << "\t//" << endl;
-
-            SleepyWrapper(sleepDuration);
+            if (!imageEventHandler->saveNextImage())
+            {
+                SleepyWrapper(sleepDuration);
+            }
         }
     }
     catch (Spinnaker::Exception& e)
@@ -370,6 +442,8 @@ int AcquireImages(
 
         // End acquisition
         pCam->EndAcquisition();
+
+        imageEventHandler->printHandoffStatistics();
     }
     catch (Spinnaker::Exception& e)
     {
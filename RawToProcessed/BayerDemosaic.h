@@ -0,0 +1,646 @@
+//=============================================================================
+// Copyright (c) 2001-2020 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief BayerDemosaic.h is an in-tree BayerBG16 to BGR8/RGB8 demosaic used by
+ *  the RawToProcessed example. Interpolation, white balance gains, the 16 to 8
+ *  bit shift and channel ordering are all done in a single pass.
+ *
+ *  Two interpolation methods are provided:
+ *  - bilinear: every missing sample is the average of its nearest neighbours
+ *    of that colour;
+ *  - edge-aware: as bilinear, except that green at red and blue sites is
+ *    interpolated along the direction (horizontal or vertical) with the
+ *    smaller gradient.
+ *
+ *  The arithmetic is defined in 16-bit integers, so the scalar, SSE4.2 and
+ *  AVX2 code paths produce bit-identical output. The fastest path supported
+ *  by the CPU is picked at runtime; frame edges are mirrored and always go
+ *  through the scalar code.
+ *
+ *  A scalar variant writes 16 bits per channel, applying the white balance
+ *  gains but no shift. Rows can be demosaiced one at a time, so a frame can
+ *  be processed in strips without holding the whole input or output.
+ */
+
+#ifndef BAYER_DEMOSAIC_H
+#define BAYER_DEMOSAIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BAYER_DEMOSAIC_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need per-function target attributes to emit SSE4.2/AVX2 code
+// without raising the baseline of the whole program; MSVC does not.
+#if defined(__GNUC__) || defined(__clang__)
+#define BAYER_DEMOSAIC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BAYER_DEMOSAIC_TARGET(isa)
+#endif
+
+enum DemosaicMethod
+{
+    DEMOSAIC_BILINEAR,
+    DEMOSAIC_EDGE_AWARE
+};
+
+enum DemosaicPath
+{
+    DEMOSAIC_PATH_SCALAR,
+    DEMOSAIC_PATH_SSE42,
+    DEMOSAIC_PATH_AVX2
+};
+
+struct DemosaicParams
+{
+    DemosaicMethod method;
+
+    // Right shift taking 16-bit samples to 8 bits (8 for full-range data)
+    unsigned int bitShift;
+
+    // White balance gains for blue, green and red in 8.8 fixed point (256 = 1.0)
+    uint16_t gains[3];
+
+    // Write pixels as R, G, B instead of B, G, R
+    bool rgbOrder;
+
+    DemosaicParams() : method(DEMOSAIC_BILINEAR), bitShift(8), rgbOrder(false)
+    {
+        gains[0] = gains[1] = gains[2] = 256;
+    }
+};
+
+inline const char* DemosaicPathName(DemosaicPath path)
+{
+    switch (path)
+    {
+    case DEMOSAIC_PATH_AVX2:
+        return "avx2";
+    case DEMOSAIC_PATH_SSE42:
+        return "sse4.2";
+    default:
+        return "scalar";
+    }
+}
+
+// Returns true if the CPU (and OS) support the given code path
+inline bool DemosaicPathSupported(DemosaicPath path)
+{
+    if (path == DEMOSAIC_PATH_SCALAR)
+    {
+        return true;
+    }
+
+#if defined(BAYER_DEMOSAIC_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse42 = __builtin_cpu_supports("sse4.2") != 0;
+    const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    return path == DEMOSAIC_PATH_AVX2 ? avx2 : sse42;
+#else
+    return false;
+#endif
+}
+
+// Pick the fastest code path supported at runtime
+inline DemosaicPath DemosaicDetectPath()
+{
+    if (DemosaicPathSupported(DEMOSAIC_PATH_AVX2))
+    {
+        return DEMOSAIC_PATH_AVX2;
+    }
+    if (DemosaicPathSupported(DEMOSAIC_PATH_SSE42))
+    {
+        return DEMOSAIC_PATH_SSE42;
+    }
+    return DEMOSAIC_PATH_SCALAR;
+}
+
+//
+// Scalar reference
+//
+// *** NOTES ***
+// Four-sample averages are computed as an average of two rounded pairwise
+// averages. This matches what the SIMD paths get from two rounds of
+// pavgw and keeps all paths bit-exact.
+//
+
+inline uint16_t DemosaicAvg2(uint16_t a, uint16_t b)
+{
+    return static_cast<uint16_t>((static_cast<uint32_t>(a) + b + 1) >> 1);
+}
+
+inline uint16_t DemosaicAbsDiff(uint16_t a, uint16_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+// Green at a red or blue site from its four direct neighbours
+inline uint16_t DemosaicCross(uint16_t w, uint16_t e, uint16_t n, uint16_t s, DemosaicMethod method)
+{
+    const uint16_t h = DemosaicAvg2(w, e);
+    const uint16_t v = DemosaicAvg2(n, s);
+
+    if (method == DEMOSAIC_EDGE_AWARE)
+    {
+        const uint16_t dh = DemosaicAbsDiff(w, e);
+        const uint16_t dv = DemosaicAbsDiff(n, s);
+        if (dh < dv)
+        {
+            return h;
+        }
+        if (dv < dh)
+        {
+            return v;
+        }
+    }
+
+    return DemosaicAvg2(h, v);
+}
+
+inline uint8_t DemosaicScale(uint16_t sample, uint16_t gain, unsigned int bitShift)
+{
+    const uint32_t value = (static_cast<uint32_t>(sample) * gain) >> (bitShift + 8);
+    return static_cast<uint8_t>(value > 255 ? 255 : value);
+}
+
+// Same as DemosaicScale for 16-bit output, which keeps the full sample range
+inline uint16_t DemosaicScale16(uint16_t sample, uint16_t gain)
+{
+    const uint32_t value = (static_cast<uint32_t>(sample) * gain) >> 8;
+    return static_cast<uint16_t>(value > 65535 ? 65535 : value);
+}
+
+inline void DemosaicStore(uint8_t* channel, uint16_t sample, uint16_t gain, unsigned int bitShift)
+{
+    *channel = DemosaicScale(sample, gain, bitShift);
+}
+
+inline void DemosaicStore(uint16_t* channel, uint16_t sample, uint16_t gain, unsigned int /*bitShift*/)
+{
+    *channel = DemosaicScale16(sample, gain);
+}
+
+// Demosaic columns [x0, x1) of one row into 8-bit or 16-bit channels. up and
+// down are the neighbouring rows, already mirrored at the top and bottom of
+// the frame.
+template <typename Channel>
+inline void DemosaicRowScalar(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    size_t width,
+    bool oddRow,
+    size_t x0,
+    size_t x1,
+    const DemosaicParams& params,
+    Channel* dst)
+{
+    const int blueIndex = params.rgbOrder ? 2 : 0;
+    const int redIndex = 2 - blueIndex;
+
+    for (size_t x = x0; x < x1; x++)
+    {
+        // Mirroring keeps the Bayer phase of the neighbours
+        const size_t l = x == 0 ? 1 : x - 1;
+        const size_t r = x + 1 == width ? width - 2 : x + 1;
+
+        // Blue sites on even rows and red sites on odd rows
+        const bool colourSite = ((x & 1) != 0) == oddRow;
+
+        uint16_t green;
+        uint16_t sameRow;
+        uint16_t otherRow;
+
+        if (colourSite)
+        {
+            green = DemosaicCross(cur[l], cur[r], up[x], down[x], params.method);
+            sameRow = cur[x];
+            otherRow = DemosaicAvg2(DemosaicAvg2(up[l], up[r]), DemosaicAvg2(down[l], down[r]));
+        }
+        else
+        {
+            green = cur[x];
+            sameRow = DemosaicAvg2(cur[l], cur[r]);
+            otherRow = DemosaicAvg2(up[x], down[x]);
+        }
+
+        // Even rows carry blue, odd rows carry red
+        const uint16_t blue = oddRow ? otherRow : sameRow;
+        const uint16_t red = oddRow ? sameRow : otherRow;
+
+        Channel* pixel = dst + 3 * x;
+        DemosaicStore(pixel + blueIndex, blue, params.gains[0], params.bitShift);
+        DemosaicStore(pixel + 1, green, params.gains[1], params.bitShift);
+        DemosaicStore(pixel + redIndex, red, params.gains[2], params.bitShift);
+    }
+}
+
+#if defined(BAYER_DEMOSAIC_X86)
+
+//
+// SSE4.2 path, 16 pixels per iteration
+//
+
+// Interleave three planes of 16 bytes into 48 bytes of packed pixels
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline void DemosaicInterleaveSse(__m128i p0, __m128i p1, __m128i p2, uint8_t* dst)
+{
+    static const int8_t masks[3][3][16] = {
+        {{0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5},
+         {-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1},
+         {-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1}},
+        {{-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1},
+         {5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10},
+         {-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1}},
+        {{-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1},
+         {-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1},
+         {10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15}}};
+
+    for (int i = 0; i < 3; i++)
+    {
+        __m128i out = _mm_shuffle_epi8(p0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[i][0])));
+        out = _mm_or_si128(out, _mm_shuffle_epi8(p1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[i][1]))));
+        out = _mm_or_si128(out, _mm_shuffle_epi8(p2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[i][2]))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16 * i), out);
+    }
+}
+
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline __m128i DemosaicAbsDiffSse(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline __m128i DemosaicCrossSse(__m128i w, __m128i e, __m128i n, __m128i s, bool edgeAware)
+{
+    const __m128i h = _mm_avg_epu16(w, e);
+    const __m128i v = _mm_avg_epu16(n, s);
+    __m128i result = _mm_avg_epu16(h, v);
+
+    if (edgeAware)
+    {
+        const __m128i dh = DemosaicAbsDiffSse(w, e);
+        const __m128i dv = DemosaicAbsDiffSse(n, s);
+        const __m128i smaller = _mm_min_epu16(dh, dv);
+        const __m128i hNotAbove = _mm_cmpeq_epi16(smaller, dh);
+        const __m128i vNotAbove = _mm_cmpeq_epi16(smaller, dv);
+        result = _mm_blendv_epi8(result, h, _mm_andnot_si128(vNotAbove, hNotAbove));
+        result = _mm_blendv_epi8(result, v, _mm_andnot_si128(hNotAbove, vNotAbove));
+    }
+
+    return result;
+}
+
+// Apply a gain and shift to eight 16-bit samples, saturating at 255
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline __m128i DemosaicScaleSse(__m128i samples, __m128i gain, __m128i shift)
+{
+    const __m128i max = _mm_set1_epi32(255);
+    __m128i lo = _mm_cvtepu16_epi32(samples);
+    __m128i hi = _mm_unpackhi_epi16(samples, _mm_setzero_si128());
+    lo = _mm_min_epi32(_mm_srl_epi32(_mm_mullo_epi32(lo, gain), shift), max);
+    hi = _mm_min_epi32(_mm_srl_epi32(_mm_mullo_epi32(hi, gain), shift), max);
+    return _mm_packus_epi32(lo, hi);
+}
+
+// Interpolate eight pixels starting at an even column
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline void DemosaicBlockSse(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    __m128i colourSites,
+    bool edgeAware,
+    __m128i& sameRow,
+    __m128i& green,
+    __m128i& otherRow)
+{
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur - 1));
+    const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + 1));
+    const __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up));
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down));
+    const __m128i nw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up - 1));
+    const __m128i ne = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + 1));
+    const __m128i sw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down - 1));
+    const __m128i se = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + 1));
+
+    const __m128i h = _mm_avg_epu16(w, e);
+    const __m128i v = _mm_avg_epu16(n, s);
+    const __m128i diagonal = _mm_avg_epu16(_mm_avg_epu16(nw, ne), _mm_avg_epu16(sw, se));
+
+    green = _mm_blendv_epi8(c, DemosaicCrossSse(w, e, n, s, edgeAware), colourSites);
+    sameRow = _mm_blendv_epi8(h, c, colourSites);
+    otherRow = _mm_blendv_epi8(v, diagonal, colourSites);
+}
+
+BAYER_DEMOSAIC_TARGET("sse4.2")
+inline size_t DemosaicRowSse(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    size_t width,
+    bool oddRow,
+    const DemosaicParams& params,
+    uint8_t* dst)
+{
+    const bool edgeAware = params.method == DEMOSAIC_EDGE_AWARE;
+    const __m128i colourSites = oddRow ? _mm_set_epi16(-1, 0, -1, 0, -1, 0, -1, 0)
+                                       : _mm_set_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+    const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(params.bitShift + 8));
+    const __m128i blueGain = _mm_set1_epi32(params.gains[0]);
+    const __m128i greenGain = _mm_set1_epi32(params.gains[1]);
+    const __m128i redGain = _mm_set1_epi32(params.gains[2]);
+
+    // Column 0 and 1 need mirroring and are left to the scalar code, as is
+    // anything within one block plus one column of the right edge
+    size_t x = 2;
+    for (; x + 16 + 1 <= width; x += 16)
+    {
+        __m128i sameRow[2], green[2], otherRow[2];
+        DemosaicBlockSse(up + x, cur + x, down + x, colourSites, edgeAware, sameRow[0], green[0], otherRow[0]);
+        DemosaicBlockSse(
+            up + x + 8, cur + x + 8, down + x + 8, colourSites, edgeAware, sameRow[1], green[1], otherRow[1]);
+
+        __m128i blue8, green8, red8;
+        const __m128i* blue = oddRow ? otherRow : sameRow;
+        const __m128i* red = oddRow ? sameRow : otherRow;
+        blue8 = _mm_packus_epi16(DemosaicScaleSse(blue[0], blueGain, shift), DemosaicScaleSse(blue[1], blueGain, shift));
+        green8 =
+            _mm_packus_epi16(DemosaicScaleSse(green[0], greenGain, shift), DemosaicScaleSse(green[1], greenGain, shift));
+        red8 = _mm_packus_epi16(DemosaicScaleSse(red[0], redGain, shift), DemosaicScaleSse(red[1], redGain, shift));
+
+        if (params.rgbOrder)
+        {
+            DemosaicInterleaveSse(red8, green8, blue8, dst + 3 * x);
+        }
+        else
+        {
+            DemosaicInterleaveSse(blue8, green8, red8, dst + 3 * x);
+        }
+    }
+
+    return x;
+}
+
+//
+// AVX2 path, 16 pixels per iteration in a single register
+//
+
+BAYER_DEMOSAIC_TARGET("avx2")
+inline __m256i DemosaicAbsDiffAvx2(__m256i a, __m256i b)
+{
+    return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+}
+
+BAYER_DEMOSAIC_TARGET("avx2")
+inline __m256i DemosaicCrossAvx2(__m256i w, __m256i e, __m256i n, __m256i s, bool edgeAware)
+{
+    const __m256i h = _mm256_avg_epu16(w, e);
+    const __m256i v = _mm256_avg_epu16(n, s);
+    __m256i result = _mm256_avg_epu16(h, v);
+
+    if (edgeAware)
+    {
+        const __m256i dh = DemosaicAbsDiffAvx2(w, e);
+        const __m256i dv = DemosaicAbsDiffAvx2(n, s);
+        const __m256i smaller = _mm256_min_epu16(dh, dv);
+        const __m256i hNotAbove = _mm256_cmpeq_epi16(smaller, dh);
+        const __m256i vNotAbove = _mm256_cmpeq_epi16(smaller, dv);
+        result = _mm256_blendv_epi8(result, h, _mm256_andnot_si256(vNotAbove, hNotAbove));
+        result = _mm256_blendv_epi8(result, v, _mm256_andnot_si256(hNotAbove, vNotAbove));
+    }
+
+    return result;
+}
+
+// Apply a gain and shift to sixteen 16-bit samples, saturating at 255, and
+// return them as sixteen bytes in order
+BAYER_DEMOSAIC_TARGET("avx2")
+inline __m128i DemosaicScaleAvx2(__m256i samples, __m256i gain, __m128i shift)
+{
+    const __m256i max = _mm256_set1_epi32(255);
+    __m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(samples));
+    __m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(samples, 1));
+    lo = _mm256_min_epi32(_mm256_srl_epi32(_mm256_mullo_epi32(lo, gain), shift), max);
+    hi = _mm256_min_epi32(_mm256_srl_epi32(_mm256_mullo_epi32(hi, gain), shift), max);
+
+    // packus works within 128-bit lanes; restore the pixel order afterwards
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+BAYER_DEMOSAIC_TARGET("avx2")
+inline size_t DemosaicRowAvx2(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    size_t width,
+    bool oddRow,
+    const DemosaicParams& params,
+    uint8_t* dst)
+{
+    const bool edgeAware = params.method == DEMOSAIC_EDGE_AWARE;
+    const __m256i colourSites = oddRow ? _mm256_set_epi16(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0)
+                                       : _mm256_set_epi16(0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1);
+    const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(params.bitShift + 8));
+    const __m256i blueGain = _mm256_set1_epi32(params.gains[0]);
+    const __m256i greenGain = _mm256_set1_epi32(params.gains[1]);
+    const __m256i redGain = _mm256_set1_epi32(params.gains[2]);
+
+    size_t x = 2;
+    for (; x + 16 + 1 <= width; x += 16)
+    {
+        const uint16_t* u = up + x;
+        const uint16_t* m = cur + x;
+        const uint16_t* d = down + x;
+
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m));
+        const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m - 1));
+        const __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + 1));
+        const __m256i n = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u));
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d));
+        const __m256i nw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u - 1));
+        const __m256i ne = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + 1));
+        const __m256i sw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d - 1));
+        const __m256i se = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + 1));
+
+        const __m256i h = _mm256_avg_epu16(w, e);
+        const __m256i v = _mm256_avg_epu16(n, s);
+        const __m256i diagonal = _mm256_avg_epu16(_mm256_avg_epu16(nw, ne), _mm256_avg_epu16(sw, se));
+
+        const __m256i green = _mm256_blendv_epi8(c, DemosaicCrossAvx2(w, e, n, s, edgeAware), colourSites);
+        const __m256i sameRow = _mm256_blendv_epi8(h, c, colourSites);
+        const __m256i otherRow = _mm256_blendv_epi8(v, diagonal, colourSites);
+
+        const __m128i blue8 = DemosaicScaleAvx2(oddRow ? otherRow : sameRow, blueGain, shift);
+        const __m128i green8 = DemosaicScaleAvx2(green, greenGain, shift);
+        const __m128i red8 = DemosaicScaleAvx2(oddRow ? sameRow : otherRow, redGain, shift);
+
+        if (params.rgbOrder)
+        {
+            DemosaicInterleaveSse(red8, green8, blue8, dst + 3 * x);
+        }
+        else
+        {
+            DemosaicInterleaveSse(blue8, green8, red8, dst + 3 * x);
+        }
+    }
+
+    return x;
+}
+
+#endif // BAYER_DEMOSAIC_X86
+
+// The kernels mirror at the frame edges and work on pairs of columns, so the
+// frame must be even in both dimensions and at least 2x2
+inline bool DemosaicSupportsSize(size_t width, size_t height)
+{
+    return width >= 2 && height >= 2 && (width & 1) == 0 && (height & 1) == 0;
+}
+
+// Index of the row above and below row y, mirrored at the top and bottom of
+// the frame; mirroring keeps the Bayer phase of the neighbouring rows
+inline size_t DemosaicRowAbove(size_t y)
+{
+    return y == 0 ? 1 : y - 1;
+}
+
+inline size_t DemosaicRowBelow(size_t y, size_t height)
+{
+    return y + 1 == height ? height - 2 : y + 1;
+}
+
+// Demosaic one row of a BayerBG16 frame into width * 3 bytes with the given
+// code path. up and down are the rows returned by DemosaicRowAbove() and
+// DemosaicRowBelow(), so callers streaming a frame only need those rows.
+inline void DemosaicBayerBG16Row(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    size_t width,
+    bool oddRow,
+    uint8_t* dst,
+    const DemosaicParams& params,
+    DemosaicPath path)
+{
+    // SIMD paths cover the interior; the first two columns and the remainder
+    // on the right go through the scalar code
+    size_t x = 0;
+#if defined(BAYER_DEMOSAIC_X86)
+    if (path == DEMOSAIC_PATH_AVX2)
+    {
+        x = DemosaicRowAvx2(up, cur, down, width, oddRow, params, dst);
+    }
+    else if (path == DEMOSAIC_PATH_SSE42)
+    {
+        x = DemosaicRowSse(up, cur, down, width, oddRow, params, dst);
+    }
+#else
+    (void)path;
+#endif
+    if (x == 0)
+    {
+        DemosaicRowScalar(up, cur, down, width, oddRow, 0, width, params, dst);
+    }
+    else
+    {
+        DemosaicRowScalar(up, cur, down, width, oddRow, 0, 2, params, dst);
+        DemosaicRowScalar(up, cur, down, width, oddRow, x, width, params, dst);
+    }
+}
+
+// Demosaic one row into width * 3 16-bit channels (scalar only)
+inline void DemosaicBayerBG16Row16(
+    const uint16_t* up,
+    const uint16_t* cur,
+    const uint16_t* down,
+    size_t width,
+    bool oddRow,
+    uint16_t* dst,
+    const DemosaicParams& params)
+{
+    DemosaicRowScalar(up, cur, down, width, oddRow, 0, width, params, dst);
+}
+
+// Demosaic rows [firstRow, firstRow + numRows) of a BayerBG16 frame with the
+// given code path. dst receives numRows packed rows of width * 3 bytes. Width
+// and height must pass DemosaicSupportsSize().
+inline void DemosaicBayerBG16Rows(
+    const uint16_t* src,
+    size_t width,
+    size_t height,
+    size_t firstRow,
+    size_t numRows,
+    uint8_t* dst,
+    const DemosaicParams& params,
+    DemosaicPath path)
+{
+    for (size_t y = firstRow; y < firstRow + numRows; y++)
+    {
+        DemosaicBayerBG16Row(
+            src + DemosaicRowAbove(y) * width,
+            src + y * width,
+            src + DemosaicRowBelow(y, height) * width,
+            width,
+            (y & 1) != 0,
+            dst + (y - firstRow) * width * 3,
+            params,
+            path);
+    }
+}
+
+// Demosaic a whole BayerBG16 frame into packed BGR8 (or RGB8). Width and
+// height must pass DemosaicSupportsSize().
+inline void DemosaicBayerBG16(
+    const uint16_t* src,
+    size_t width,
+    size_t height,
+    uint8_t* dst,
+    const DemosaicParams& params,
+    DemosaicPath path)
+{
+    DemosaicBayerBG16Rows(src, width, height, 0, height, dst, params, path);
+}
+
+#endif // BAYER_DEMOSAIC_H
@@ -36,158 +36,3027 @@
 // for windows mkdir
 #ifdef _WIN32
 #include <direct.h>
+#include <time.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// for watch mode
+#ifdef __linux__
+#include <poll.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#endif
+
+#include <errno.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+#include <map>
+#include "BayerDemosaic.h"
+#include "TiffStripWriter.h"
+
+// dirent.h in this folder is only a Windows shim; use the system header elsewhere
+#ifdef _WIN32
+#include "dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+using namespace Spinnaker;
+using namespace Spinnaker::GenApi;
+using namespace Spinnaker::GenICam;
+using namespace std;
+
+// Define image settings and directories. HEIGHT, WIDTH, BYTE_DEPTH and
+// RAW_IMAGE_PIXEL_TYPE are the defaults for files without a geometry header,
+// sidecar or directory geometry file.
+#define HEIGHT                  480
+#define WIDTH                   640
+#define BYTE_DEPTH              2
+#define X_OFFSET                0
+#define Y_OFFSET                0
+#define RAW_FILE_TYPE           "Raw"
+#define TARGET_FILE_TYPE        "Tiff"
+#define RAW_IMAGE_PIXEL_TYPE    PixelFormat_BayerBG16
+#define TARGET_IMAGE_FORMAT     PixelFormat_BGR8
+#define RAW_INPUT_DIR           "./input"
+#define PROCESSED_OUTPUT_DIR    "output"
+
+// Right shift taking 16-bit raw samples to 8 bits in the in-tree demosaic
+#define DEMOSAIC_BIT_SHIFT      8
+
+// Conversion journal kept in the output directory by --resume
+#define MANIFEST_FILE_NAME      "manifest.txt"
+
+// Geometry of a raw file can be given by a text sidecar named after it (for
+// example image.raw.geometry), or for a whole directory by a geometry file in it
+#define SIDECAR_FILE_TYPE       "geometry"
+#define DIRECTORY_GEOMETRY_FILE "geometry.txt"
+
+// Optional binary header at the start of a raw file; see readRawHeader()
+#define RAW_HEADER_MAGIC        "SRAW"
+#define RAW_HEADER_SIZE         32
+
+// Maximum number of input files compared against the SDK by --verify-demosaic
+#define VERIFY_DEMOSAIC_FILES   16
+
+// Number of conversion workers used when none is given on the command line;
+// 0 uses one worker per hardware thread
+#define DEFAULT_NUM_WORKERS     1
+
+// Number of upcoming files each worker asks the OS to read ahead in mmap mode
+#define MMAP_READAHEAD_FILES    4
+
+// Rows per strip written by the streaming TIFF writer
+#define TIFF_ROWS_PER_STRIP     16
+
+// Defaults of the throughput benchmark: corpus size, and where it is
+// generated (tmpfs on Linux, so the benchmark measures conversion rather than
+// the disk)
+#define BENCHMARK_FILES         200
+#ifdef __linux__
+#define BENCHMARK_DIR           "/dev/shm/RawToProcessedBenchmark"
+#else
+#define BENCHMARK_DIR           "benchmark"
+#endif
+
+// Number of distinct synthetic frames cycled through the benchmark corpus
+#define BENCHMARK_DISTINCT_FRAMES 8
+
+// Raw pixel formats that can be named in a geometry header or sidecar
+struct RawPixelFormat
+{
+    const char* name;
+    PixelFormatEnums format;
+    unsigned int bytesPerPixel;
+};
+
+const RawPixelFormat raw_pixel_formats[] = {
+    {"Mono8", PixelFormat_Mono8, 1},
+    {"Mono16", PixelFormat_Mono16, 2},
+    {"BayerRG8", PixelFormat_BayerRG8, 1},
+    {"BayerGR8", PixelFormat_BayerGR8, 1},
+    {"BayerGB8", PixelFormat_BayerGB8, 1},
+    {"BayerBG8", PixelFormat_BayerBG8, 1},
+    {"BayerRG16", PixelFormat_BayerRG16, 2},
+    {"BayerGR16", PixelFormat_BayerGR16, 2},
+    {"BayerGB16", PixelFormat_BayerGB16, 2},
+    {"BayerBG16", PixelFormat_BayerBG16, 2}};
+
+const size_t num_raw_pixel_formats = sizeof(raw_pixel_formats) / sizeof(raw_pixel_formats[0]);
+
+// Look up a raw pixel format by name; returns NULL if it is not supported
+const RawPixelFormat* findRawPixelFormat(const string& name)
+{
+    for (size_t i = 0; i < num_raw_pixel_formats; i++)
+    {
+        if (name == raw_pixel_formats[i].name)
+        {
+            return &raw_pixel_formats[i];
+        }
+    }
+    return NULL;
+}
+
+const RawPixelFormat* findRawPixelFormat(PixelFormatEnums format)
+{
+    for (size_t i = 0; i < num_raw_pixel_formats; i++)
+    {
+        if (format == raw_pixel_formats[i].format)
+        {
+            return &raw_pixel_formats[i];
+        }
+    }
+    return NULL;
+}
+
+// Size and pixel format of a raw file, and the offset of its pixel data
+struct RawGeometry
+{
+    unsigned int width;
+    unsigned int height;
+    PixelFormatEnums pixelFormat;
+    size_t dataOffset;
+
+    RawGeometry() : width(WIDTH), height(HEIGHT), pixelFormat(RAW_IMAGE_PIXEL_TYPE), dataOffset(0)
+    {
+    }
+
+    bool isValid() const
+    {
+        return width > 0 && height > 0 && pixelFormat != UNKNOWN_PIXELFORMAT;
+    }
+
+    size_t imageSize() const
+    {
+        const RawPixelFormat* format = findRawPixelFormat(pixelFormat);
+        return static_cast<size_t>(width) * height * (format != NULL ? format->bytesPerPixel : BYTE_DEPTH);
+    }
+
+    string name() const
+    {
+        const RawPixelFormat* format = findRawPixelFormat(pixelFormat);
+
+        ostringstream sstream;
+        sstream << width << "x" << height << " " << (format != NULL ? format->name : "unknown");
+        return sstream.str();
+    }
+
+    // Files that differ only in data offset share image buffers
+    bool operator<(const RawGeometry& other) const
+    {
+        if (width != other.width)
+        {
+            return width < other.width;
+        }
+        if (height != other.height)
+        {
+            return height < other.height;
+        }
+        return pixelFormat < other.pixelFormat;
+    }
+};
+
+// A queued raw file and its geometry, resolved when it was queued
+struct RawFile
+{
+    string name;
+    RawGeometry geometry;
+};
+
+// Options selected on the command line
+struct ConversionOptions
+{
+    unsigned int numWorkers;
+    bool useMmap;
+
+    // Number of frames in flight in pipelined mode; 0 disables the pipeline
+    unsigned int pipelineFrames;
+
+    // Keep running and convert files as they appear in the input directory
+    bool watch;
+
+    // Record results in a manifest and skip files converted by earlier runs
+    bool resume;
+
+    // Print a progress line for every file
+    bool verbose;
+
+    // Demosaic with the in-tree kernel (BayerDemosaic.h) instead of the SDK
+    bool nativeDemosaic;
+    DemosaicParams demosaicParams;
+    DemosaicPath demosaicPath;
+
+    // Bits per channel written by the streaming TIFF writer; 0 saves through
+    // the SDK instead
+    unsigned int streamTiffBits;
+    unsigned int rowsPerStrip;
+
+    ConversionOptions()
+        : numWorkers(DEFAULT_NUM_WORKERS), useMmap(false), pipelineFrames(0), watch(false), resume(false),
+          verbose(true),
+          nativeDemosaic(false),
+          demosaicPath(DemosaicDetectPath()),
+          streamTiffBits(0),
+          rowsPerStrip(TIFF_ROWS_PER_STRIP)
+    {
+        demosaicParams.bitShift = DEMOSAIC_BIT_SHIFT;
+        demosaicParams.rgbOrder = TARGET_IMAGE_FORMAT == PixelFormat_RGB8;
+    }
+};
+
+// Thread-safe queue of raw files shared by the conversion workers. Workers
+// block in pop() until a file is available or the queue has been closed and
+// drained.
+class WorkQueue
+{
+  public:
+    WorkQueue() : m_closed(false)
+    {
+    }
+
+    void push(const RawFile& file)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_files.push_back(file);
+        }
+        m_condition.notify_one();
+    }
+
+    // Signal that no more filenames will be pushed
+    void close()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_condition.notify_all();
+    }
+
+    // Take the next file off the queue. If lookahead is non-zero, upcoming is
+    // set to the name of the file that many places behind it (or left empty),
+    // so callers can start reading that file ahead of time.
+    bool pop(RawFile& file, size_t lookahead, string& upcoming)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return !m_files.empty() || m_closed; });
+
+        if (m_files.empty())
+        {
+            return false;
+        }
+
+        file = m_files.front();
+        m_files.pop_front();
+
+        upcoming.clear();
+        if (lookahead > 0 && lookahead <= m_files.size())
+        {
+            upcoming = m_files[lookahead - 1].name;
+        }
+        return true;
+    }
+
+    size_t size()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_files.size();
+    }
+
+    // Empty the queue and accept files again after close()
+    void reopen()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_files.clear();
+        m_closed = false;
+    }
+
+  private:
+    mutex m_mutex;
+    condition_variable m_condition;
+    deque<RawFile> m_files;
+    bool m_closed;
+};
+
+// Distinct geometries found in the input and the number of files of each, so
+// workers can allocate their buffers up front and the mix can be reported
+class GeometryCatalog
+{
+  public:
+    void add(const RawGeometry& geometry)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_counts[geometry]++;
+    }
+
+    map<RawGeometry, uint64_t> counts()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_counts;
+    }
+
+  private:
+    mutex m_mutex;
+    map<RawGeometry, uint64_t> m_counts;
+};
+
+// Input image and in-tree demosaic output for one geometry
+struct GeometryBuffers
+{
+    ImagePtr rawImage;
+    ImagePtr nativeImage;
+};
+
+// Images owned by one worker (or pipeline frame), one set per geometry. Each
+// set is allocated once and reused for every file of that geometry, so a
+// mixed corpus does not reallocate buffers when the geometry changes.
+class GeometryBufferPool
+{
+  public:
+    GeometryBufferPool() : m_allocateRaw(false), m_allocateNative(false)
+    {
+    }
+
+    // Choose which images are allocated: the input image is not needed when
+    // files are memory-mapped, the output image only with the in-tree demosaic
+    void configure(bool allocateRaw, bool allocateNative)
+    {
+        m_allocateRaw = allocateRaw;
+        m_allocateNative = allocateNative;
+    }
+
+    // Buffers for the geometry, allocated on first use
+    GeometryBuffers& get(const RawGeometry& geometry)
+    {
+        GeometryBuffers& buffers = m_buffers[geometry];
+
+        if (m_allocateRaw && !buffers.rawImage.IsValid())
+        {
+            buffers.rawImage = Image::Create();
+            buffers.rawImage->ResetImage(geometry.width, geometry.height, X_OFFSET, Y_OFFSET, geometry.pixelFormat);
+        }
+
+        if (m_allocateNative && !buffers.nativeImage.IsValid())
+        {
+            buffers.nativeImage = Image::Create();
+            buffers.nativeImage->ResetImage(geometry.width, geometry.height, X_OFFSET, Y_OFFSET, TARGET_IMAGE_FORMAT);
+        }
+
+        return buffers;
+    }
+
+    // Allocate the buffers of every valid geometry seen so far
+    void reserve(const map<RawGeometry, uint64_t>& geometries)
+    {
+        for (map<RawGeometry, uint64_t>::const_iterator it = geometries.begin(); it != geometries.end(); ++it)
+        {
+            if (it->first.isValid())
+            {
+                get(it->first);
+            }
+        }
+    }
+
+  private:
+    map<RawGeometry, GeometryBuffers> m_buffers;
+    bool m_allocateRaw;
+    bool m_allocateNative;
+};
+
+// Bounded blocking queue joining two pipeline stages. push() blocks while the
+// queue is full and pop() blocks while it is empty; both add the time spent
+// blocked to the caller's stall counter.
+template <typename T> class BoundedQueue
+{
+  public:
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity), m_closed(false)
+    {
+    }
+
+    void push(const T& item, double& stallSeconds)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            if (m_items.size() >= m_capacity)
+            {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                m_notFull.wait(lock, [this] { return m_items.size() < m_capacity; });
+                stallSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            }
+            m_items.push_back(item);
+        }
+        m_notEmpty.notify_one();
+    }
+
+    // Returns false once the queue has been closed and drained
+    bool pop(T& item, double& stallSeconds)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            if (m_items.empty() && !m_closed)
+            {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_closed; });
+                stallSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            }
+
+            if (m_items.empty())
+            {
+                return false;
+            }
+
+            item = m_items.front();
+            m_items.pop_front();
+        }
+        m_notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+    }
+
+  private:
+    mutex m_mutex;
+    condition_variable m_notEmpty;
+    condition_variable m_notFull;
+    deque<T> m_items;
+    size_t m_capacity;
+    bool m_closed;
+};
+
+// Throughput counters kept by each conversion worker
+struct WorkerStats
+{
+    uint64_t filesConverted;
+    uint64_t filesFailed;
+    uint64_t bytesRead;
+    double busySeconds;
+
+    // Seconds taken by each converted file
+    vector<double> latencies;
+
+    WorkerStats() : filesConverted(0), filesFailed(0), bytesRead(0), busySeconds(0.0)
+    {
+    }
+};
+
+// Read-only view of a raw image file mapped into memory. The mapping is
+// private, so the pages come straight from the page cache and any write
+// through it (should the SDK ever touch the input) stays local to the process.
+class MappedFile
+{
+  public:
+    MappedFile() : m_data(NULL), m_size(0)
+    {
+#ifdef _WIN32
+        m_file = INVALID_HANDLE_VALUE;
+        m_mapping = NULL;
+#endif
+    }
+
+    ~MappedFile()
+    {
+        unmap();
+    }
+
+    bool map(const string& filepath)
+    {
+        unmap();
+
+#ifdef _WIN32
+        m_file = CreateFileA(
+            filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            unmap();
+            return false;
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+
+        m_mapping = CreateFileMappingA(m_file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (m_mapping == NULL)
+        {
+            unmap();
+            return false;
+        }
+
+        m_data = static_cast<unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0));
+        if (m_data == NULL)
+        {
+            unmap();
+            return false;
+        }
+#else
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat fileInfo;
+        if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+        m_size = static_cast<size_t>(fileInfo.st_size);
+
+        void* data = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+        // The mapping keeps its own reference to the file
+        close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            m_size = 0;
+            return false;
+        }
+        m_data = static_cast<unsigned char*>(data);
+
+        // The frame is consumed front to back exactly once; ask for aggressive
+        // readahead and start paging it in now
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+        madvise(m_data, m_size, MADV_WILLNEED);
+#endif
+        return true;
+    }
+
+    void unmap()
+    {
+#ifdef _WIN32
+        if (m_data != NULL)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != NULL)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = NULL;
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_data != NULL)
+        {
+            munmap(m_data, m_size);
+        }
+#endif
+        m_data = NULL;
+        m_size = 0;
+    }
+
+    unsigned char* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+  private:
+    // Mappings are not copyable
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    unsigned char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+};
+
+// Ask the OS to start reading a file that will be converted soon, so its pages
+// are already cached by the time a worker maps it
+void readaheadFile(const string& filepath)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    (void)filepath;
+#endif
+}
+
+// Size and modification time of a source file, used to tell whether it has
+// changed since it was last converted
+struct FileStamp
+{
+    uint64_t size;
+    int64_t mtime;
+
+    FileStamp() : size(0), mtime(0)
+    {
+    }
+
+    bool operator==(const FileStamp& other) const
+    {
+        return size == other.size && mtime == other.mtime;
+    }
+};
+
+// Get the size and modification time (in nanoseconds where available) of a file
+bool statFile(const string& filepath, FileStamp& stamp)
+{
+    struct stat info;
+    if (stat(filepath.c_str(), &info) != 0)
+    {
+        return false;
+    }
+
+    stamp.size = static_cast<uint64_t>(info.st_size);
+#if defined(__linux__)
+    stamp.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+    stamp.mtime = static_cast<int64_t>(info.st_mtime) * 1000000000;
+#endif
+    return true;
+}
+
+//
+// Append-only journal of conversion results
+//
+// *** NOTES ***
+// Each line holds the status ("ok" or "failed"), size, mtime and name of a
+// source file, and the last line for a file wins. A file whose latest entry
+// is "ok" with an unchanged size and mtime is not converted again, so an
+// interrupted run can be restarted without redoing completed work. A line cut
+// short by an interruption is ignored. On open, the journal is compacted to
+// one line per completed file.
+//
+class Manifest
+{
+  public:
+    Manifest() : m_file(NULL)
+    {
+    }
+
+    ~Manifest()
+    {
+        close();
+    }
+
+    // Load the existing journal, if any, and open it for appending
+    bool open(const string& path)
+    {
+        ifstream in(path.c_str());
+        string line;
+        while (getline(in, line))
+        {
+            // A final line without a newline was interrupted mid-write
+            if (in.eof())
+            {
+                break;
+            }
+
+            char status[16];
+            unsigned long long size = 0;
+            long long mtime = 0;
+            int nameOffset = 0;
+            if (sscanf(line.c_str(), "%15s %llu %lld %n", status, &size, &mtime, &nameOffset) != 3 ||
+                nameOffset == 0)
+            {
+                continue;
+            }
+
+            const string fileName = line.substr(nameOffset);
+            if (strcmp(status, "ok") == 0)
+            {
+                FileStamp stamp;
+                stamp.size = size;
+                stamp.mtime = mtime;
+                m_completed[fileName] = stamp;
+            }
+            else
+            {
+                m_completed.erase(fileName);
+            }
+        }
+        in.close();
+
+        // Rewrite the journal with only the completed files, then append to it
+        const string tempPath = path + ".tmp";
+        m_file = fopen(tempPath.c_str(), "w");
+        if (m_file == NULL)
+        {
+            return false;
+        }
+
+        for (unordered_map<string, FileStamp>::const_iterator it = m_completed.begin(); it != m_completed.end(); ++it)
+        {
+            writeEntry(it->first, it->second, true);
+        }
+        fclose(m_file);
+
+        remove(path.c_str());
+        if (rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            m_file = NULL;
+            return false;
+        }
+
+        m_file = fopen(path.c_str(), "a");
+        return m_file != NULL;
+    }
+
+    bool isEnabled() const
+    {
+        return m_file != NULL;
+    }
+
+    size_t completedCount() const
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_completed.size();
+    }
+
+    // Returns true if the file was converted before and has not changed since
+    bool isComplete(const string& fileName, const FileStamp& stamp) const
+    {
+        lock_guard<mutex> lock(m_mutex);
+        unordered_map<string, FileStamp>::const_iterator it = m_completed.find(fileName);
+        return it != m_completed.end() && it->second == stamp;
+    }
+
+    void record(const string& fileName, const FileStamp& stamp, bool converted)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_file == NULL)
+        {
+            return;
+        }
+
+        writeEntry(fileName, stamp, converted);
+
+        // Hand each entry to the OS right away so it survives the process
+        fflush(m_file);
+
+        if (converted)
+        {
+            m_completed[fileName] = stamp;
+        }
+        else
+        {
+            m_completed.erase(fileName);
+        }
+    }
+
+    void close()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_file != NULL)
+        {
+            fclose(m_file);
+            m_file = NULL;
+        }
+    }
+
+  private:
+    void writeEntry(const string& fileName, const FileStamp& stamp, bool converted)
+    {
+        fprintf(
+            m_file,
+            "%s %llu %lld %s\n",
+            converted ? "ok" : "failed",
+            static_cast<unsigned long long>(stamp.size),
+            static_cast<long long>(stamp.mtime),
+            fileName.c_str());
+    }
+
+    mutable mutex m_mutex;
+    unordered_map<string, FileStamp> m_completed;
+    FILE* m_file;
+};
+
+// Stable 64-bit FNV-1a hash of a filename, identical on every host
+uint64_t hashFileName(const string& fileName)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < fileName.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(fileName[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Partition of the input across independent processes or hosts. Shard i of N
+// converts the files whose name hashes to i modulo N, so shards never overlap
+// and need no coordination.
+struct ShardSpec
+{
+    unsigned int index;
+    unsigned int count;
+
+    ShardSpec() : index(0), count(1)
+    {
+    }
+
+    bool isSharded() const
+    {
+        return count > 1;
+    }
+
+    bool contains(const string& fileName) const
+    {
+        return count <= 1 || hashFileName(fileName) % count == index;
+    }
+
+    // Suffix identifying this shard in per-shard file names
+    string suffix() const
+    {
+        ostringstream sstream;
+        sstream << "shard-" << index << "-of-" << count;
+        return sstream.str();
+    }
+};
+
+// Directories read and written by the conversion; the throughput benchmark
+// points them at its own corpus
+string input_dir = RAW_INPUT_DIR;
+string output_dir = PROCESSED_OUTPUT_DIR;
+
+// Create a queue to store raw image filenames
+WorkQueue raw_image_files;
+
+// Geometries of the queued files
+GeometryCatalog input_geometries;
+
+// Geometry of files in the input directory without a header or sidecar
+RawGeometry input_defaults;
+
+// Share of the input converted by this process
+ShardSpec input_shard;
+
+// Journal of converted files, used with --resume
+Manifest conversion_manifest;
+
+// Number of files skipped because the manifest shows them as already converted
+atomic<uint64_t> skipped_files(0);
+
+// Number of raw image files to be processed in the current queue initialized to 0;
+// grows while files arrive in watch mode
+atomic<uint64_t> total_files(0);
+
+// Number of raw image files taken off the queue so far, across all workers
+atomic<uint64_t> files_started(0);
+
+// Serializes progress output from the conversion workers
+mutex console_mutex;
+
+// Case-insenstive comparison of two characters
+inline bool caseInsCharCompareN(char a, char b)
+{
+    return(toupper(a) == toupper(b));
+}
+
+// Case-insensitive comparison of two strings
+bool caseInsCompare(const string & s1, const string & s2)
+{
+    return((s1.size() == s2.size()) &&
+        equal(s1.begin(), s1.end(), s2.begin(), caseInsCharCompareN));
+}
+
+// Check whether a string has a specified ending
+bool hasEnding(string const & fullString, string const & ending)
+{
+    if (fullString.length() >= ending.length())
+    {
+        string ext = fullString.substr(fullString.length() - ending.length(), ending.length());
+        return (caseInsCompare(ext, ending));
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// Replace a filename extension with a new extension
+void replaceExt(string & s, const string & newExt)
+{
+    string::size_type i = s.rfind('.', s.length());
+
+    if (i != string::npos)
+    {
+        s.replace(i + 1, newExt.length(), newExt);
+    }
+}
+
+// Apply the "key value" lines of a geometry sidecar or directory geometry file
+// on top of the given geometry. Returns false if the file does not exist; a
+// file with invalid values marks the geometry invalid.
+bool loadGeometryFile(const string& path, RawGeometry& geometry)
+{
+    ifstream in(path.c_str());
+    if (!in)
+    {
+        return false;
+    }
+
+    string key;
+    string value;
+    while (in >> key >> value)
+    {
+        if (key == "width")
+        {
+            geometry.width = static_cast<unsigned int>(strtoul(value.c_str(), NULL, 10));
+        }
+        else if (key == "height")
+        {
+            geometry.height = static_cast<unsigned int>(strtoul(value.c_str(), NULL, 10));
+        }
+        else if (key == "offset")
+        {
+            geometry.dataOffset = static_cast<size_t>(strtoull(value.c_str(), NULL, 10));
+        }
+        else if (key == "pixel_format")
+        {
+            const RawPixelFormat* format = findRawPixelFormat(value);
+            if (format == NULL)
+            {
+                lock_guard<mutex> lock(console_mutex);
+                cout << "Error: unsupported pixel format " << value << " in " << path << endl;
+            }
+            geometry.pixelFormat = format != NULL ? format->format : UNKNOWN_PIXELFORMAT;
+        }
+        else
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Warning: ignoring unknown key " << key << " in " << path << endl;
+        }
+    }
+
+    return true;
+}
+
+uint32_t readLittleEndian(const unsigned char* bytes, size_t numBytes)
+{
+    uint32_t value = 0;
+    for (size_t i = numBytes; i > 0; i--)
+    {
+        value = (value << 8) | bytes[i - 1];
+    }
+    return value;
+}
+
+//
+// Read the optional binary header at the start of a raw file
+//
+// *** NOTES ***
+// The header is RAW_HEADER_SIZE bytes, little-endian:
+//     0   char[4]   RAW_HEADER_MAGIC
+//     4   uint16    version (1)
+//     6   uint16    offset of the pixel data (at least RAW_HEADER_SIZE)
+//     8   uint32    width
+//     12  uint32    height
+//     16  char[16]  pixel format name, e.g. "BayerRG16", NUL-padded
+// Files without the magic are headerless and keep the given geometry.
+//
+bool readRawHeader(const string& path, RawGeometry& geometry)
+{
+    unsigned char header[RAW_HEADER_SIZE];
+
+    FILE* inFile = fopen(path.c_str(), "rb");
+    if (inFile == NULL)
+    {
+        return false;
+    }
+    const size_t bytesRead = fread(header, 1, RAW_HEADER_SIZE, inFile);
+    fclose(inFile);
+
+    if (bytesRead != RAW_HEADER_SIZE || memcmp(header, RAW_HEADER_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+
+    const string formatName(reinterpret_cast<const char*>(header + 16), strnlen(reinterpret_cast<const char*>(header + 16), 16));
+    const RawPixelFormat* format = findRawPixelFormat(formatName);
+
+    geometry.dataOffset = readLittleEndian(header + 6, 2);
+    geometry.width = readLittleEndian(header + 8, 4);
+    geometry.height = readLittleEndian(header + 12, 4);
+    geometry.pixelFormat = format != NULL ? format->format : UNKNOWN_PIXELFORMAT;
+
+    if (readLittleEndian(header + 4, 2) != 1 || geometry.dataOffset < RAW_HEADER_SIZE || format == NULL)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: unsupported raw header in " << path << endl;
+        geometry.pixelFormat = UNKNOWN_PIXELFORMAT;
+    }
+
+    return true;
+}
+
+// Resolve the geometry of a raw file: its own header, then its sidecar, then
+// the directory defaults
+RawGeometry resolveGeometry(const string& dir, const string& fileName)
+{
+    RawGeometry geometry = input_defaults;
+
+    if (!readRawHeader(dir + fileName, geometry))
+    {
+        loadGeometryFile(dir + fileName + "." + SIDECAR_FILE_TYPE, geometry);
+    }
+
+    return geometry;
+}
+
+// Queue a raw file with its geometry and add it to the total
+void queueRawFile(const string& dir, const string& fileName, WorkQueue& files)
+{
+    RawFile file;
+    file.name = fileName;
+    file.geometry = resolveGeometry(dir, fileName);
+
+    input_geometries.add(file.geometry);
+    ++total_files;
+    files.push(file);
+}
+
+// Get .raw files under the specified directory and add them to the total.
+// Files are queued grouped by geometry.
+int getdir(string dir, WorkQueue & files)
+{
+    DIR *dp;
+    struct dirent *dirp;
+    if ((dp = opendir(dir.c_str())) == NULL)
+    {
+        cout << "Error(" << errno << ") opening " << dir << endl;
+        return errno;
+    }
+
+    map<RawGeometry, vector<RawFile> > groups;
+    while ((dirp = readdir(dp)) != NULL)
+    {
+        if (hasEnding(dirp->d_name, RAW_FILE_TYPE) && input_shard.contains(dirp->d_name))
+        {
+            // Skip files converted by an earlier run that have not changed since
+            FileStamp stamp;
+            if (conversion_manifest.isEnabled() && statFile(dir + dirp->d_name, stamp) &&
+                conversion_manifest.isComplete(dirp->d_name, stamp))
+            {
+                ++skipped_files;
+                continue;
+            }
+
+            RawFile file;
+            file.name = dirp->d_name;
+            file.geometry = resolveGeometry(dir, file.name);
+            groups[file.geometry].push_back(file);
+        }
+    }
+    closedir(dp);
+
+    for (map<RawGeometry, vector<RawFile> >::const_iterator group = groups.begin(); group != groups.end(); ++group)
+    {
+        for (size_t i = 0; i < group->second.size(); i++)
+        {
+            input_geometries.add(group->second[i].geometry);
+            ++total_files;
+            files.push(group->second[i]);
+        }
+    }
+    return 0;
+}
+
+// Read a .raw image into the buffer of the worker's pre-created input image,
+// which must have the file's geometry
+bool readRawFile(const string& filepath, const RawGeometry& geometry, ImagePtr& tempImage, WorkerStats& stats)
+{
+    unsigned char *buffer = static_cast<unsigned char*>(tempImage->GetData());
+    const size_t imageSize = geometry.imageSize();
+
+    // Open the current .raw image
+    FILE* inFile = fopen(filepath.c_str(), "rb");
+
+    if (inFile == NULL)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error reading: " << filepath << endl;
+        return false;
+    }
+
+    // Read the current .raw image data in the specified format and store them in the buffer
+    size_t bytesRead = 0;
+    if (fseek(inFile, static_cast<long>(geometry.dataOffset), SEEK_SET) == 0)
+    {
+        bytesRead = fread(buffer, sizeof(unsigned char), imageSize, inFile);
+    }
+
+    fclose(inFile);
+
+    stats.bytesRead += bytesRead;
+
+    if (bytesRead != imageSize)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: " << filepath << " is " << bytesRead << " bytes, expected " << imageSize << endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Map a .raw image into memory and wrap the mapped pages in an image
+bool mapRawFile(
+    const string& filepath,
+    const RawGeometry& geometry,
+    MappedFile& mappedFile,
+    ImagePtr& mappedImage,
+    WorkerStats& stats)
+{
+    //
+    // Wrap the mapped file directly in an image
+    //
+    // *** NOTES ***
+    // The image does not own the mapped pages, so it must be released before
+    // the file is unmapped.
+    //
+    const size_t imageSize = geometry.imageSize();
+
+    if (!mappedFile.map(filepath))
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error mapping: " << filepath << endl;
+        return false;
+    }
+
+    if (mappedFile.size() < geometry.dataOffset + imageSize)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: " << filepath << " is " << mappedFile.size() << " bytes, expected "
+             << geometry.dataOffset + imageSize << endl;
+        mappedFile.unmap();
+        return false;
+    }
+
+    try
+    {
+        mappedImage = Image::Create(
+            geometry.width,
+            geometry.height,
+            X_OFFSET,
+            Y_OFFSET,
+            geometry.pixelFormat,
+            mappedFile.data() + geometry.dataOffset);
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: " << e.what() << endl;
+        mappedFile.unmap();
+        return false;
+    }
+
+    stats.bytesRead += imageSize;
+    return true;
+}
+
+// Create the output filename and path with the target file type extension
+string outputFilepath(const string& fileName)
+{
+    string newFilename = fileName;
+    replaceExt(newFilename, TARGET_FILE_TYPE);
+    return output_dir + string("/") + newFilename;
+}
+
+// Convert a raw image to the target pixel format, either with the SDK image
+// processor or with the in-tree demosaic kernel. The kernel writes into
+// nativeImage, which is allocated on first use and reused afterwards. Inputs
+// other than BayerBG16, and sizes the kernel does not support, always go
+// through the SDK.
+ImagePtr convertImage(
+    const ImagePtr& rawImage,
+    ImageProcessor& processor,
+    ImagePtr& nativeImage,
+    const ConversionOptions& options)
+{
+    const size_t width = rawImage->GetWidth();
+    const size_t height = rawImage->GetHeight();
+
+    if (!options.nativeDemosaic || rawImage->GetPixelFormat() != PixelFormat_BayerBG16 ||
+        !DemosaicSupportsSize(width, height))
+    {
+        return processor.Convert(rawImage, TARGET_IMAGE_FORMAT);
+    }
+
+    if (!nativeImage.IsValid() || nativeImage->GetWidth() != width || nativeImage->GetHeight() != height)
+    {
+        nativeImage = Image::Create();
+        nativeImage->ResetImage(width, height, X_OFFSET, Y_OFFSET, TARGET_IMAGE_FORMAT);
+    }
+
+    DemosaicBayerBG16(
+        static_cast<const uint16_t*>(rawImage->GetData()),
+        width,
+        height,
+        static_cast<uint8_t*>(nativeImage->GetData()),
+        options.demosaicParams,
+        options.demosaicPath);
+
+    return nativeImage;
+}
+
+// Convert a raw image to the target pixel format and save it under the target file type
+bool saveConvertedImage(
+    const string& fileName,
+    const ImagePtr& rawImage,
+    ImageProcessor& processor,
+    ImagePtr& nativeImage,
+    const ConversionOptions& options)
+{
+    string newFilepath = outputFilepath(fileName);
+
+    // Save the image to the target pixel format and file type
+    try
+    {
+        ImagePtr convertedImage = convertImage(rawImage, processor, nativeImage, options);
+        convertedImage->Save(newFilepath.c_str());
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: " << e.what() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Working memory of a worker streaming files to TIFF strips
+struct StripBuffers
+{
+    // Input rows of one strip plus the rows above and below it; unused when
+    // the input is memory-mapped
+    vector<uint16_t> input;
+
+    // Demosaiced rows of one strip
+    vector<uint8_t> output;
+};
+
+// Bytes of strip buffers a worker needs for the given geometry
+size_t stripBufferSize(const RawGeometry& geometry, const ConversionOptions& options)
+{
+    const size_t rows = min<size_t>(options.rowsPerStrip, geometry.height);
+    const size_t inputRows = options.useMmap ? 0 : rows + 2;
+
+    return inputRows * geometry.width * sizeof(uint16_t) + rows * geometry.width * 3 * (options.streamTiffBits / 8);
+}
+
+//
+// Demosaic a BayerBG16 file strip by strip and stream the strips to a TIFF
+// file, so neither the whole input nor the whole output is held in memory
+//
+// *** NOTES ***
+// Each strip needs the input row above and below it. The input window keeps
+// the last two rows of the previous strip and reads only the new ones, so
+// every input byte is read once and in order.
+//
+bool streamRawFileToTiff(
+    const RawFile& file,
+    const ConversionOptions& options,
+    MappedFile& mappedFile,
+    StripBuffers& buffers,
+    WorkerStats& stats)
+{
+    const string filepath = input_dir + string("/") + file.name;
+    const string newFilepath = outputFilepath(file.name);
+    const size_t width = file.geometry.width;
+    const size_t height = file.geometry.height;
+
+    if (!DemosaicSupportsSize(width, height))
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: " << filepath << " is " << file.geometry.name() << "; streaming needs even dimensions" << endl;
+        return false;
+    }
+
+    const size_t rowsPerStrip = min<size_t>(options.rowsPerStrip, height);
+    const size_t outputRowSize = width * 3 * (options.streamTiffBits / 8);
+
+    // Whole frame when mapped, otherwise a window of rows read from the file
+    const uint16_t* frame = NULL;
+    FILE* inFile = NULL;
+
+    if (options.useMmap)
+    {
+        WorkerStats unusedStats;
+        ImagePtr mappedImage;
+        if (!mapRawFile(filepath, file.geometry, mappedFile, mappedImage, unusedStats))
+        {
+            return false;
+        }
+        frame = reinterpret_cast<const uint16_t*>(mappedFile.data() + file.geometry.dataOffset);
+    }
+    else
+    {
+        inFile = fopen(filepath.c_str(), "rb");
+        if (inFile == NULL || fseek(inFile, static_cast<long>(file.geometry.dataOffset), SEEK_SET) != 0)
+        {
+            if (inFile != NULL)
+            {
+                fclose(inFile);
+            }
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Error reading: " << filepath << endl;
+            return false;
+        }
+        buffers.input.resize((rowsPerStrip + 2) * width);
+    }
+    buffers.output.resize(rowsPerStrip * outputRowSize);
+
+    // TIFF stores R, G, B
+    DemosaicParams params = options.demosaicParams;
+    params.rgbOrder = true;
+
+    TiffStripWriter writer;
+    bool readFailed = false;
+    bool result = writer.open(
+        newFilepath.c_str(),
+        static_cast<uint32_t>(width),
+        static_cast<uint32_t>(height),
+        options.streamTiffBits,
+        static_cast<uint32_t>(rowsPerStrip));
+
+    // Rows [windowFirst, windowFirst + windowRows) are in the input window
+    size_t windowFirst = 0;
+    size_t windowRows = 0;
+
+    for (size_t firstRow = 0; result && firstRow < height; firstRow += rowsPerStrip)
+    {
+        const size_t numRows = min(rowsPerStrip, height - firstRow);
+        const uint16_t* window = frame;
+
+        if (inFile != NULL)
+        {
+            // Input rows needed by this strip, including its neighbours
+            const size_t first = firstRow == 0 ? 0 : firstRow - 1;
+            const size_t last = min(height, firstRow + numRows + 1);
+
+            // Keep the rows shared with the previous strip and read the rest
+            const size_t kept = windowFirst + windowRows - first;
+            memmove(&buffers.input[0], &buffers.input[(first - windowFirst) * width], kept * width * sizeof(uint16_t));
+
+            const size_t rowsToRead = last - first - kept;
+            if (fread(&buffers.input[kept * width], sizeof(uint16_t) * width, rowsToRead, inFile) != rowsToRead)
+            {
+                lock_guard<mutex> lock(console_mutex);
+                cout << "Error: " << filepath << " is shorter than " << file.geometry.imageSize() << " bytes" << endl;
+                readFailed = true;
+                break;
+            }
+
+            windowFirst = first;
+            windowRows = last - first;
+            window = &buffers.input[0];
+        }
+
+        const size_t base = inFile != NULL ? windowFirst : 0;
+        for (size_t y = firstRow; y < firstRow + numRows; y++)
+        {
+            const uint16_t* up = window + (DemosaicRowAbove(y) - base) * width;
+            const uint16_t* cur = window + (y - base) * width;
+            const uint16_t* down = window + (DemosaicRowBelow(y, height) - base) * width;
+            uint8_t* out = &buffers.output[(y - firstRow) * outputRowSize];
+
+            if (options.streamTiffBits == 16)
+            {
+                DemosaicBayerBG16Row16(up, cur, down, width, (y & 1) != 0, reinterpret_cast<uint16_t*>(out), params);
+            }
+            else
+            {
+                DemosaicBayerBG16Row(up, cur, down, width, (y & 1) != 0, out, params, options.demosaicPath);
+            }
+        }
+
+        result = writer.writeStrip(&buffers.output[0], numRows * outputRowSize);
+    }
+
+    result = writer.close() && result;
+
+    if (inFile != NULL)
+    {
+        fclose(inFile);
+    }
+    mappedFile.unmap();
+
+    if (!result || readFailed)
+    {
+        // Do not leave a truncated image behind
+        remove(newFilepath.c_str());
+
+        if (!readFailed)
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Error writing: " << newFilepath << endl;
+        }
+        return false;
+    }
+
+    stats.bytesRead += file.geometry.imageSize();
+    return true;
+}
+
+// Convert a single .raw image to the target pixel format and file type using
+// the worker's own buffers and image processor
+bool convertFile(
+    const RawFile& file,
+    const ConversionOptions& options,
+    GeometryBufferPool& buffers,
+    StripBuffers& stripBuffers,
+    MappedFile& mappedFile,
+    ImageProcessor& processor,
+    WorkerStats& stats)
+{
+    // Filepath for the current .raw image file
+    string filepath = input_dir + string("/") + file.name;
+
+    if (!file.geometry.isValid())
+    {
+        lock_guard<mutex> lock(console_mutex);
+        cout << "Error: no valid geometry for " << filepath << endl;
+        return false;
+    }
+
+    // The streaming writer only handles BayerBG16; other files are saved through the SDK
+    if (options.streamTiffBits != 0 && file.geometry.pixelFormat == PixelFormat_BayerBG16)
+    {
+        return streamRawFileToTiff(file, options, mappedFile, stripBuffers, stats);
+    }
+
+    GeometryBuffers& geometryBuffers = buffers.get(file.geometry);
+
+    if (!options.useMmap)
+    {
+        return readRawFile(filepath, file.geometry, geometryBuffers.rawImage, stats) &&
+               saveConvertedImage(file.name, geometryBuffers.rawImage, processor, geometryBuffers.nativeImage, options);
+    }
+
+    ImagePtr mappedImage;
+    if (!mapRawFile(filepath, file.geometry, mappedFile, mappedImage, stats))
+    {
+        return false;
+    }
+
+    bool result = saveConvertedImage(file.name, mappedImage, processor, geometryBuffers.nativeImage, options);
+
+    // Release the image before its pages are unmapped
+    mappedImage = nullptr;
+    mappedFile.unmap();
+    return result;
+}
+
+// Print which demosaic implementation a run uses
+void printDemosaicMethod(const ConversionOptions& options)
+{
+    if (options.nativeDemosaic || options.streamTiffBits != 0)
+    {
+        // 16-bit output only has a scalar path
+        cout << "Demosaic: in-tree "
+             << (options.demosaicParams.method == DEMOSAIC_EDGE_AWARE ? "edge-aware" : "bilinear") << " ("
+             << DemosaicPathName(options.streamTiffBits == 16 ? DEMOSAIC_PATH_SCALAR : options.demosaicPath) << ")"
+             << endl;
+    }
+    else
+    {
+        cout << "Demosaic: SDK HQ_LINEAR" << endl;
+    }
+}
+
+// Print the strip buffer size of each worker when streaming TIFF output,
+// next to what a full input and output frame of the largest geometry takes
+void printStripMemory(const ConversionOptions& options)
+{
+    size_t stripBytes = 0;
+    size_t frameBytes = 0;
+
+    const map<RawGeometry, uint64_t> geometries = input_geometries.counts();
+    for (map<RawGeometry, uint64_t>::const_iterator it = geometries.begin(); it != geometries.end(); ++it)
+    {
+        if (it->first.isValid() && it->first.pixelFormat == PixelFormat_BayerBG16)
+        {
+            stripBytes = max(stripBytes, stripBufferSize(it->first, options));
+            frameBytes = max(frameBytes, it->first.imageSize() + it->first.imageSize() / 2 * 3);
+        }
+    }
+
+    cout << "Output: " << options.streamTiffBits << "-bit TIFF streamed in strips of " << options.rowsPerStrip
+         << " rows, " << stripBytes / 1024 << " KB per worker (full frames: " << frameBytes / 1024 << " KB)"
+         << endl;
+}
+
+// Fill a buffer with a synthetic BayerBG16 scene: smooth colour gradients, a
+// checkerboard of hard edges and some noise, so that interpolation quality
+// and speed can be measured without real raw files
+void fillSyntheticBayer(uint16_t* data, size_t width, size_t height, uint32_t seed)
+{
+    uint32_t state = seed * 2654435761u + 1;
+
+    for (size_t y = 0; y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            const uint32_t red = static_cast<uint32_t>(x * 60000 / width);
+            const uint32_t blue = static_cast<uint32_t>(y * 60000 / height);
+            const uint32_t green = ((x / 32 + y / 32) & 1) != 0 ? 48000 : 16000;
+
+            // BayerBG: B G on even rows, G R on odd rows
+            uint32_t value;
+            if ((y & 1) == 0)
+            {
+                value = (x & 1) == 0 ? blue : green;
+            }
+            else
+            {
+                value = (x & 1) == 0 ? green : red;
+            }
+
+            state = state * 1664525u + 1013904223u;
+            value += state >> 22;
+
+            data[y * width + x] = static_cast<uint16_t>(value > 65535 ? 65535 : value);
+        }
+    }
+}
+
+// Peak signal-to-noise ratio in dB between two 8-bit buffers
+double computePsnr(const uint8_t* a, const uint8_t* b, size_t size)
+{
+    double squaredError = 0.0;
+    for (size_t i = 0; i < size; i++)
+    {
+        const double diff = static_cast<double>(a[i]) - b[i];
+        squaredError += diff * diff;
+    }
+
+    if (squaredError == 0.0)
+    {
+        return INFINITY;
+    }
+
+    return 10.0 * log10(255.0 * 255.0 * size / squaredError);
+}
+
+// Check that every SIMD path of the in-tree demosaic is bit-exact with the
+// scalar reference and report its PSNR against the SDK conversion. Uses the
+// queued BayerBG16 input files, or a synthetic frame if there are none.
+int verifyDemosaic(const ConversionOptions& options)
+{
+    int result = 0;
+    const DemosaicPath simdPaths[] = {DEMOSAIC_PATH_SSE42, DEMOSAIC_PATH_AVX2};
+    const DemosaicMethod methods[] = {DEMOSAIC_BILINEAR, DEMOSAIC_EDGE_AWARE};
+
+    cout << endl << "*** VERIFYING IN-TREE DEMOSAIC ***" << endl << endl;
+
+    ImagePtr rawImage = Image::Create();
+
+    ImageProcessor processor;
+    processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+
+    vector<uint8_t> reference;
+    vector<uint8_t> candidate;
+    WorkerStats unusedStats;
+
+    cout << fixed << setprecision(2);
+
+    RawFile file;
+    string unusedUpcoming;
+    for (unsigned int frame = 0; frame < VERIFY_DEMOSAIC_FILES; frame++)
+    {
+        if (raw_image_files.pop(file, 0, unusedUpcoming))
+        {
+            if (file.geometry.pixelFormat != PixelFormat_BayerBG16)
+            {
+                cout << file.name << ": skipped, " << file.geometry.name() << " is not BayerBG16" << endl;
+                continue;
+            }
+
+            rawImage->ResetImage(file.geometry.width, file.geometry.height, X_OFFSET, Y_OFFSET, PixelFormat_BayerBG16);
+            if (!readRawFile(input_dir + string("/") + file.name, file.geometry, rawImage, unusedStats))
+            {
+                result = -1;
+                continue;
+            }
+        }
+        else if (frame == 0)
+        {
+            file.name = "synthetic frame";
+            rawImage->ResetImage(WIDTH, HEIGHT, X_OFFSET, Y_OFFSET, PixelFormat_BayerBG16);
+            fillSyntheticBayer(static_cast<uint16_t*>(rawImage->GetData()), WIDTH, HEIGHT, 1);
+        }
+        else
+        {
+            break;
+        }
+
+        const uint16_t* rawData = static_cast<const uint16_t*>(rawImage->GetData());
+        const size_t width = rawImage->GetWidth();
+        const size_t height = rawImage->GetHeight();
+        const size_t outputSize = width * height * 3;
+        reference.resize(outputSize);
+        candidate.resize(outputSize);
+
+        ImagePtr sdkImage;
+        try
+        {
+            sdkImage = processor.Convert(rawImage, TARGET_IMAGE_FORMAT);
+        }
+        catch (Spinnaker::Exception& e)
+        {
+            cout << "Error: " << e.what() << endl;
+            return -1;
+        }
+        const uint8_t* sdkData = static_cast<const uint8_t*>(sdkImage->GetData());
+
+        cout << file.name << ":" << endl;
+
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+        {
+            DemosaicParams params = options.demosaicParams;
+            params.method = methods[m];
+
+            DemosaicBayerBG16(rawData, width, height, &reference[0], params, DEMOSAIC_PATH_SCALAR);
+
+            cout << "    " << (params.method == DEMOSAIC_EDGE_AWARE ? "edge-aware" : "bilinear  ")
+                 << ": PSNR vs SDK " << computePsnr(&reference[0], sdkData, outputSize) << " dB";
+
+            for (size_t p = 0; p < sizeof(simdPaths) / sizeof(simdPaths[0]); p++)
+            {
+                if (!DemosaicPathSupported(simdPaths[p]))
+                {
+                    cout << ", " << DemosaicPathName(simdPaths[p]) << " not supported";
+                    continue;
+                }
+
+                DemosaicBayerBG16(rawData, width, height, &candidate[0], params, simdPaths[p]);
+
+                const bool exact = memcmp(&reference[0], &candidate[0], outputSize) == 0;
+                cout << ", " << DemosaicPathName(simdPaths[p]) << (exact ? " bit-exact" : " MISMATCH");
+                if (!exact)
+                {
+                    result = -1;
+                }
+            }
+            cout << endl;
+        }
+    }
+
+    cout << endl << (result == 0 ? "Demosaic verification passed." : "Demosaic verification FAILED.") << endl;
+    return result;
+}
+
+// Measure single-threaded demosaic speed of every supported code path, and of
+// the SDK conversion for reference, on a synthetic frame
+void benchmarkDemosaic(const ConversionOptions& options)
+{
+    const double minSeconds = 1.0;
+    const double megapixels = WIDTH * HEIGHT / 1e6;
+    const DemosaicPath paths[] = {DEMOSAIC_PATH_SCALAR, DEMOSAIC_PATH_SSE42, DEMOSAIC_PATH_AVX2};
+    const DemosaicMethod methods[] = {DEMOSAIC_BILINEAR, DEMOSAIC_EDGE_AWARE};
+
+    cout << endl << "*** DEMOSAIC BENCHMARK (" << WIDTH << "x" << HEIGHT << ", one thread) ***" << endl << endl;
+    cout << fixed << setprecision(1);
+
+    ImagePtr rawImage = Image::Create();
+    rawImage->ResetImage(WIDTH, HEIGHT, X_OFFSET, Y_OFFSET, PixelFormat_BayerBG16);
+    uint16_t* rawData = static_cast<uint16_t*>(rawImage->GetData());
+    fillSyntheticBayer(rawData, WIDTH, HEIGHT, 1);
+
+    vector<uint8_t> output(WIDTH * HEIGHT * 3);
+
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+    {
+        for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++)
+        {
+            if (!DemosaicPathSupported(paths[p]))
+            {
+                continue;
+            }
+
+            DemosaicParams params = options.demosaicParams;
+            params.method = methods[m];
+
+            unsigned int iterations = 0;
+            double elapsed = 0.0;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            while (elapsed < minSeconds)
+            {
+                DemosaicBayerBG16(rawData, WIDTH, HEIGHT, &output[0], params, paths[p]);
+                iterations++;
+                elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            }
+
+            cout << (methods[m] == DEMOSAIC_EDGE_AWARE ? "edge-aware " : "bilinear   ") << setw(7)
+                 << DemosaicPathName(paths[p]) << ": " << iterations * megapixels / elapsed << " MP/s per core" << endl;
+        }
+    }
+
+    try
+    {
+        ImageProcessor processor;
+        processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+
+        unsigned int iterations = 0;
+        double elapsed = 0.0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (elapsed < minSeconds)
+        {
+            ImagePtr convertedImage = processor.Convert(rawImage, TARGET_IMAGE_FORMAT);
+            iterations++;
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        cout << "SDK HQ_LINEAR     : " << iterations * megapixels / elapsed << " MP/s per core" << endl;
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+// Body of each conversion worker; drains the shared queue until it is closed
+// and empty
+void conversionWorker(unsigned int workerId, const ConversionOptions* options, WorkerStats* stats)
+{
+    // Each worker owns its buffers so they are never shared between threads.
+    // They are allocated up front for every geometry found in the input,
+    // except when streaming: strip buffers are then sized on first use and
+    // frame buffers are only allocated for files the writer cannot stream.
+    GeometryBufferPool buffers;
+    StripBuffers stripBuffers;
+    buffers.configure(!options->useMmap, options->nativeDemosaic);
+    if (options->streamTiffBits == 0)
+    {
+        buffers.reserve(input_geometries.counts());
+    }
+
+    MappedFile mappedFile;
+
+    // With every worker reading ahead by the same distance, each file is
+    // prefetched once, a few files before it is taken off the queue
+    const size_t lookahead = options->useMmap ? MMAP_READAHEAD_FILES * options->numWorkers : 0;
+
+    //
+    // Create ImageProcessor instance for post processing images
+    //
+    // *** NOTES ***
+    // ImageProcessor is not shared between threads; each worker keeps its own
+    // instance configured with the same color processing algorithm.
+    //
+    ImageProcessor processor;
+    processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+
+    RawFile file;
+    string upcomingFileName;
+    while (raw_image_files.pop(file, lookahead, upcomingFileName))
+    {
+        const string& fileName = file.name;
+        if (!upcomingFileName.empty())
+        {
+            readaheadFile(input_dir + string("/") + upcomingFileName);
+        }
+
+        uint64_t fileNumber = ++files_started;
+        if (options->verbose)
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Files remaining: " << total_files - fileNumber << "/" << total_files
+                 << "\t[worker " << workerId << "] converting file: " << fileName << endl;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        // Take the stamp before reading so a file changed mid-conversion is redone next time
+        FileStamp stamp;
+        if (conversion_manifest.isEnabled())
+        {
+            statFile(input_dir + string("/") + fileName, stamp);
+        }
+
+        bool result = convertFile(file, *options, buffers, stripBuffers, mappedFile, processor, *stats);
+
+        conversion_manifest.record(fileName, stamp, result);
+
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        stats->busySeconds += seconds;
+
+        if (result)
+        {
+            stats->filesConverted++;
+            stats->latencies.push_back(seconds);
+        }
+        else
+        {
+            stats->filesFailed++;
+        }
+    }
+}
+
+// Print the aggregate files/sec and MB/s of a conversion run
+void printTotals(const WorkerStats& total, double elapsedSeconds)
+{
+    const double elapsed = elapsedSeconds > 0.0 ? elapsedSeconds : 1.0;
+
+    cout << endl
+         << "Total: " << total.filesConverted << " converted, " << total.filesFailed << " failed in "
+         << elapsedSeconds << " s (" << total.filesConverted / elapsed << " files/sec, "
+         << total.bytesRead / elapsed / (1024.0 * 1024.0) << " MB/s)" << endl;
+}
+
+// Print per-worker counters followed by the aggregate files/sec and MB/s, and
+// return the aggregate counters
+WorkerStats printThroughput(const vector<WorkerStats>& stats, double elapsedSeconds)
+{
+    WorkerStats total;
+
+    cout << endl << endl << "*** CONVERSION THROUGHPUT ***" << endl << endl;
+    cout << fixed << setprecision(2);
+
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        const double busy = stats[i].busySeconds > 0.0 ? stats[i].busySeconds : 1.0;
+
+        cout << "Worker " << i << ": " << stats[i].filesConverted << " converted, " << stats[i].filesFailed
+             << " failed, " << stats[i].filesConverted / busy << " files/sec, "
+             << stats[i].bytesRead / busy / (1024.0 * 1024.0) << " MB/s" << endl;
+
+        total.filesConverted += stats[i].filesConverted;
+        total.filesFailed += stats[i].filesFailed;
+        total.bytesRead += stats[i].bytesRead;
+        total.latencies.insert(total.latencies.end(), stats[i].latencies.begin(), stats[i].latencies.end());
+    }
+
+    printTotals(total, elapsedSeconds);
+    return total;
+}
+
+// Convert .raw images to the target pixel format and file type, and store them in the output directory
+WorkerStats processImages(const ConversionOptions& options, double& elapsedSeconds)
+{
+    const unsigned int numWorkers = options.numWorkers;
+    vector<WorkerStats> stats(numWorkers);
+    vector<thread> workers;
+
+    cout << endl
+         << "Converting " << total_files << " files with " << numWorkers << " worker(s)"
+         << (options.useMmap ? " from memory-mapped input" : "") << "..." << endl;
+    printDemosaicMethod(options);
+    if (options.streamTiffBits != 0)
+    {
+        printStripMemory(options);
+    }
+    cout << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Convert the .raw images in the specified directory, one file per worker at a time
+    for (unsigned int i = 0; i < numWorkers; i++)
+    {
+        workers.push_back(thread(conversionWorker, i, &options, &stats[i]));
+    }
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+
+    elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return printThroughput(stats, elapsedSeconds);
+}
+
+// A frame travelling through the read/convert/write pipeline. A fixed pool of
+// frames is allocated up front, which bounds the number of frames in flight.
+struct PipelineFrame
+{
+    string fileName;
+    FileStamp stamp;
+    RawGeometry geometry;
+
+    // When the reader took the frame, for end-to-end latency
+    chrono::steady_clock::time_point started;
+
+    // Pre-allocated input buffers (unless the input is memory-mapped) and
+    // in-tree demosaic outputs, one set per geometry
+    GeometryBufferPool buffers;
+
+    // Image handed to the converter; either a pooled buffer or a mapped image
+    ImagePtr rawImage;
+    MappedFile mappedFile;
+
+    ImagePtr convertedImage;
+};
+
+// Time accounting for one pipeline stage. Stall time is time spent blocked on
+// an empty input queue or on a full output queue (including waiting for a
+// free frame).
+struct StageStats
+{
+    unsigned int threads;
+    uint64_t frames;
+    uint64_t failures;
+    double busySeconds;
+    double inputStallSeconds;
+    double outputStallSeconds;
+
+    // Seconds from reading to the end of this stage, for each frame that
+    // completed it; only kept by the last stage
+    vector<double> latencies;
+
+    StageStats()
+        : threads(0), frames(0), failures(0), busySeconds(0.0), inputStallSeconds(0.0), outputStallSeconds(0.0)
+    {
+    }
+};
+
+// Queues joining the pipeline stages
+struct PipelineQueues
+{
+    BoundedQueue<PipelineFrame*> freeFrames;
+    BoundedQueue<PipelineFrame*> readFrames;
+    BoundedQueue<PipelineFrame*> convertedFrames;
+
+    // Number of converter threads still running; the last one to finish
+    // closes the writer's queue
+    atomic<unsigned int> activeConverters;
+
+    PipelineQueues(size_t numFrames, unsigned int numConverters)
+        : freeFrames(numFrames), readFrames(numFrames), convertedFrames(numFrames), activeConverters(numConverters)
+    {
+    }
+};
+
+// Release the raw image of a frame and unmap its input file, if any
+void releaseRawImage(PipelineFrame* frame)
+{
+    frame->rawImage = nullptr;
+    frame->mappedFile.unmap();
+}
+
+// Reader stage: reads (or maps) queued .raw files into free frames
+void pipelineReader(
+    const ConversionOptions* options,
+    PipelineQueues* queues,
+    StageStats* stats,
+    WorkerStats* ioStats)
+{
+    const size_t lookahead = options->useMmap ? MMAP_READAHEAD_FILES : 0;
+    double unusedStall = 0.0;
+
+    RawFile file;
+    string upcomingFileName;
+    while (raw_image_files.pop(file, lookahead, upcomingFileName))
+    {
+        if (!upcomingFileName.empty())
+        {
+            readaheadFile(input_dir + string("/") + upcomingFileName);
+        }
+
+        uint64_t fileNumber = ++files_started;
+        if (options->verbose)
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Files remaining: " << total_files - fileNumber << "/" << total_files
+                 << "\t[reader] reading file: " << file.name << endl;
+        }
+
+        // Wait for a frame to come back from the downstream stages
+        PipelineFrame* frame = NULL;
+        queues->freeFrames.pop(frame, stats->outputStallSeconds);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        frame->started = start;
+        frame->fileName = file.name;
+        frame->geometry = file.geometry;
+        string filepath = input_dir + string("/") + file.name;
+        if (conversion_manifest.isEnabled())
+        {
+            statFile(filepath, frame->stamp);
+        }
+
+        bool result = false;
+        if (!file.geometry.isValid())
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Error: no valid geometry for " << filepath << endl;
+        }
+        else if (options->useMmap)
+        {
+            result = mapRawFile(filepath, file.geometry, frame->mappedFile, frame->rawImage, *ioStats);
+        }
+        else
+        {
+            frame->rawImage = frame->buffers.get(file.geometry).rawImage;
+            result = readRawFile(filepath, file.geometry, frame->rawImage, *ioStats);
+        }
+
+        stats->busySeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (result)
+        {
+            stats->frames++;
+            queues->readFrames.push(frame, stats->outputStallSeconds);
+        }
+        else
+        {
+            stats->failures++;
+            conversion_manifest.record(frame->fileName, frame->stamp, false);
+            releaseRawImage(frame);
+            queues->freeFrames.push(frame, unusedStall);
+        }
+    }
+
+    queues->readFrames.close();
+}
+
+// Converter stage: demosaics read frames into the target pixel format
+void pipelineConverter(const ConversionOptions* options, PipelineQueues* queues, StageStats* stats)
+{
+    ImageProcessor processor;
+    processor.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+    double unusedStall = 0.0;
+
+    PipelineFrame* frame = NULL;
+    while (queues->readFrames.pop(frame, stats->inputStallSeconds))
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        bool result = true;
+        try
+        {
+            frame->convertedImage =
+                convertImage(frame->rawImage, processor, frame->buffers.get(frame->geometry).nativeImage, *options);
+        }
+        catch (Spinnaker::Exception& e)
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Error: " << e.what() << endl;
+            result = false;
+        }
+
+        // The input is no longer needed once it has been converted
+        releaseRawImage(frame);
+
+        stats->busySeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (result)
+        {
+            stats->frames++;
+            queues->convertedFrames.push(frame, stats->outputStallSeconds);
+        }
+        else
+        {
+            stats->failures++;
+            conversion_manifest.record(frame->fileName, frame->stamp, false);
+            queues->freeFrames.push(frame, unusedStall);
+        }
+    }
+
+    if (--queues->activeConverters == 0)
+    {
+        queues->convertedFrames.close();
+    }
+}
+
+// Writer stage: saves converted frames and returns them to the free pool
+void pipelineWriter(PipelineQueues* queues, StageStats* stats)
+{
+    PipelineFrame* frame = NULL;
+    while (queues->convertedFrames.pop(frame, stats->inputStallSeconds))
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        bool result = true;
+        try
+        {
+            frame->convertedImage->Save(outputFilepath(frame->fileName).c_str());
+            stats->frames++;
+        }
+        catch (Spinnaker::Exception& e)
+        {
+            lock_guard<mutex> lock(console_mutex);
+            cout << "Error: " << e.what() << endl;
+            stats->failures++;
+            result = false;
+        }
+
+        conversion_manifest.record(frame->fileName, frame->stamp, result);
+
+        frame->convertedImage = nullptr;
+
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        stats->busySeconds += chrono::duration<double>(end - start).count();
+        if (result)
+        {
+            stats->latencies.push_back(chrono::duration<double>(end - frame->started).count());
+        }
+
+        queues->freeFrames.push(frame, stats->outputStallSeconds);
+    }
+}
+
+// Print occupancy and stall time of each pipeline stage and name the busiest
+// stage as the bottleneck
+void printPipelineStages(const StageStats stages[], const char* const names[], size_t numStages, double elapsedSeconds)
+{
+    const double elapsed = elapsedSeconds > 0.0 ? elapsedSeconds : 1.0;
+    size_t bottleneck = 0;
+    double maxOccupancy = 0.0;
+
+    cout << endl << endl << "*** PIPELINE STAGES ***" << endl << endl;
+    cout << fixed << setprecision(2);
+
+    for (size_t i = 0; i < numStages; i++)
+    {
+        const double occupancy = 100.0 * stages[i].busySeconds / (elapsed * stages[i].threads);
+        if (occupancy > maxOccupancy)
+        {
+            maxOccupancy = occupancy;
+            bottleneck = i;
+        }
+
+        cout << names[i] << " (" << stages[i].threads << " thread(s)): " << stages[i].frames << " frames, occupancy "
+             << occupancy << "%, stalled on input " << stages[i].inputStallSeconds << " s, stalled on output "
+             << stages[i].outputStallSeconds << " s" << endl;
+    }
+
+    // The converter is the only compute stage; reader and writer are I/O
+    cout << endl
+         << "Bottleneck: " << names[bottleneck] << " stage ("
+         << (bottleneck == 1 ? "compute-bound" : "I/O-bound") << ")" << endl;
+}
+
+// Convert .raw images with separate reader, converter and writer stages so
+// that file I/O overlaps with demosaicing
+WorkerStats processImagesPipelined(const ConversionOptions& options, double& elapsedSeconds)
+{
+    const size_t numFrames = options.pipelineFrames;
+    const unsigned int numConverters = options.numWorkers;
+
+    cout << endl
+         << "Converting " << total_files << " files through a pipeline with " << numFrames << " frame(s) in flight and "
+         << numConverters << " converter(s)" << (options.useMmap ? " from memory-mapped input" : "") << "..." << endl;
+    printDemosaicMethod(options);
+    cout << endl;
+
+    PipelineQueues queues(numFrames, numConverters);
+
+    // Allocate the frame pool, with buffers for every geometry found in the input
+    vector<PipelineFrame> frames(numFrames);
+    const map<RawGeometry, uint64_t> geometries = input_geometries.counts();
+    double unusedStall = 0.0;
+    for (size_t i = 0; i < numFrames; i++)
+    {
+        frames[i].buffers.configure(!options.useMmap, options.nativeDemosaic);
+        frames[i].buffers.reserve(geometries);
+        queues.freeFrames.push(&frames[i], unusedStall);
+    }
+
+    StageStats reader;
+    vector<StageStats> converters(numConverters);
+    StageStats writer;
+    WorkerStats total;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    thread readerThread(pipelineReader, &options, &queues, &reader, &total);
+    vector<thread> converterThreads;
+    for (unsigned int i = 0; i < numConverters; i++)
+    {
+        converterThreads.push_back(thread(pipelineConverter, &options, &queues, &converters[i]));
+    }
+    thread writerThread(pipelineWriter, &queues, &writer);
+
+    readerThread.join();
+    for (size_t i = 0; i < converterThreads.size(); i++)
+    {
+        converterThreads[i].join();
+    }
+    writerThread.join();
+
+    elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Combine the converter threads into a single stage
+    StageStats stages[3];
+    stages[0] = reader;
+    stages[0].threads = 1;
+    for (size_t i = 0; i < converters.size(); i++)
+    {
+        stages[1].frames += converters[i].frames;
+        stages[1].failures += converters[i].failures;
+        stages[1].busySeconds += converters[i].busySeconds;
+        stages[1].inputStallSeconds += converters[i].inputStallSeconds;
+        stages[1].outputStallSeconds += converters[i].outputStallSeconds;
+    }
+    stages[1].threads = numConverters;
+    stages[2] = writer;
+    stages[2].threads = 1;
+
+    const char* const names[3] = {"Reader", "Converter", "Writer"};
+    printPipelineStages(stages, names, 3, elapsedSeconds);
+
+    total.filesConverted = writer.frames;
+    total.filesFailed = reader.failures + stages[1].failures + writer.failures;
+    total.latencies = writer.latencies;
+    printTotals(total, elapsedSeconds);
+    return total;
+}
+
+#ifdef __linux__
+// Set by SIGINT/SIGTERM to end watch mode
+volatile sig_atomic_t stop_requested = 0;
+
+void requestStop(int /*signal*/)
+{
+    stop_requested = 1;
+}
+
+// Queue .raw files as they are written into the input directory, until SIGINT
+// or SIGTERM. The queue is then closed so the workers drain it and exit.
+void watchInputDirectory(int inotifyFd)
+{
+    // Large enough for many events per read; aligned for inotify_event
+    const size_t bufferSize = 64 * 1024;
+    vector<uint64_t> buffer(bufferSize / sizeof(uint64_t));
+    char* events = reinterpret_cast<char*>(&buffer[0]);
+
+    struct pollfd pollFd;
+    pollFd.fd = inotifyFd;
+    pollFd.events = POLLIN;
+
+    while (!stop_requested)
+    {
+        // Wake up periodically to notice a stop request
+        pollFd.revents = 0;
+        if (poll(&pollFd, 1, 500) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t length = read(inotifyFd, events, bufferSize);
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        for (char* p = events; p < events + length;)
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were dropped; fall back to listing the directory
+                {
+                    lock_guard<mutex> lock(console_mutex);
+                    cout << "Watch event queue overflowed, rescanning " << input_dir
+                         << " (some files may be converted twice)" << endl;
+                }
+                getdir(input_dir + string("/"), raw_image_files);
+                continue;
+            }
+
+            if (event->len > 0 && !(event->mask & IN_ISDIR) && hasEnding(event->name, RAW_FILE_TYPE) &&
+                input_shard.contains(event->name))
+            {
+                queueRawFile(input_dir + string("/"), event->name, raw_image_files);
+            }
+        }
+    }
+
+    close(inotifyFd);
+    raw_image_files.close();
+
+    lock_guard<mutex> lock(console_mutex);
+    cout << endl << "Stopped watching " << input_dir << ", finishing queued files..." << endl;
+}
+#endif
+
+// Per-shard statistics written next to the output so the shards of a run,
+// possibly on different hosts, can be combined afterwards with --merge-stats
+struct ShardStats
+{
+    string shard;
+    string host;
+    uint64_t filesConverted;
+    uint64_t filesFailed;
+    uint64_t filesSkipped;
+    uint64_t bytesRead;
+    double startTime;
+    double endTime;
+
+    ShardStats()
+        : filesConverted(0), filesFailed(0), filesSkipped(0), bytesRead(0), startTime(0.0), endTime(0.0)
+    {
+    }
+};
+
+// Wall-clock time in seconds since the epoch, comparable across hosts
+double wallClockSeconds()
+{
+    return chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+string hostName()
+{
+#ifdef _WIN32
+    const char* name = getenv("COMPUTERNAME");
+    return name != NULL ? string(name) : string("unknown");
+#else
+    char name[256];
+    if (gethostname(name, sizeof(name)) != 0)
+    {
+        return "unknown";
+    }
+    name[sizeof(name) - 1] = '\0';
+    return string(name);
 #endif
+}
+
+// Write the statistics of this shard, replacing any earlier file atomically
+bool writeShardStats(const ShardStats& stats)
+{
+    const string path = output_dir + string("/stats-") + stats.shard + string(".txt");
+    const string tempPath = path + ".tmp";
+
+    ofstream out(tempPath.c_str());
+    out << fixed << setprecision(3);
+    out << "shard " << stats.shard << endl;
+    out << "host " << stats.host << endl;
+    out << "files_converted " << stats.filesConverted << endl;
+    out << "files_failed " << stats.filesFailed << endl;
+    out << "files_skipped " << stats.filesSkipped << endl;
+    out << "bytes_read " << stats.bytesRead << endl;
+    out << "start_time " << stats.startTime << endl;
+    out << "end_time " << stats.endTime << endl;
+    out.close();
+
+    if (!out)
+    {
+        cout << "Error writing " << tempPath << endl;
+        return false;
+    }
+
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+bool readShardStats(const string& path, ShardStats& stats)
+{
+    ifstream in(path.c_str());
+    string key;
+    while (in >> key)
+    {
+        if (key == "shard")
+        {
+            in >> stats.shard;
+        }
+        else if (key == "host")
+        {
+            in >> stats.host;
+        }
+        else if (key == "files_converted")
+        {
+            in >> stats.filesConverted;
+        }
+        else if (key == "files_failed")
+        {
+            in >> stats.filesFailed;
+        }
+        else if (key == "files_skipped")
+        {
+            in >> stats.filesSkipped;
+        }
+        else if (key == "bytes_read")
+        {
+            in >> stats.bytesRead;
+        }
+        else if (key == "start_time")
+        {
+            in >> stats.startTime;
+        }
+        else if (key == "end_time")
+        {
+            in >> stats.endTime;
+        }
+    }
+    return !stats.shard.empty();
+}
+
+// Combine the per-shard statistics found in the output directory into totals
+// for the whole run. The aggregate rate is taken over the wall-clock span from
+// the first shard starting to the last one finishing.
+int mergeShardStats()
+{
+    DIR* dp = opendir(output_dir.c_str());
+    if (dp == NULL)
+    {
+        cout << "Error(" << errno << ") opening " << output_dir << endl;
+        return -1;
+    }
+
+    // Group shard statistics by shard count, so runs split differently are not mixed
+    map<unsigned int, vector<ShardStats> > runs;
+    struct dirent* dirp;
+    while ((dirp = readdir(dp)) != NULL)
+    {
+        const string name = dirp->d_name;
+        if (name.compare(0, 12, "stats-shard-") != 0 || !hasEnding(name, ".txt"))
+        {
+            continue;
+        }
+
+        ShardStats stats;
+        unsigned int index = 0;
+        unsigned int count = 0;
+        if (readShardStats(output_dir + string("/") + name, stats) &&
+            sscanf(stats.shard.c_str(), "shard-%u-of-%u", &index, &count) == 2)
+        {
+            runs[count].push_back(stats);
+        }
+    }
+    closedir(dp);
 
-#include <errno.h>
-#include <thread>
-#include <vector>
-#include <queue>
-#include <string>
-#include <cstring>
-#include "dirent.h"
+    if (runs.empty())
+    {
+        cout << "No shard statistics found in " << output_dir << endl;
+        return -1;
+    }
 
-using namespace Spinnaker;
-using namespace Spinnaker::GenApi;
-using namespace Spinnaker::GenICam;
-using namespace std;
+    cout << endl << "*** MERGED SHARD STATISTICS ***" << endl;
+    cout << fixed << setprecision(2);
 
-// Define image settings and directories.
-#define HEIGHT                  480
-#define WIDTH                   640
-#define BYTE_DEPTH              2
-#define X_OFFSET                0
-#define Y_OFFSET                0
-#define RAW_FILE_TYPE           "Raw"
-#define TARGET_FILE_TYPE        "Tiff"
-#define RAW_IMAGE_PIXEL_TYPE    PixelFormat_BayerBG16
-#define TARGET_IMAGE_FORMAT     PixelFormat_BGR8
-#define RAW_INPUT_DIR           "./input"
-#define PROCESSED_OUTPUT_DIR    "output"
+    int result = 0;
+    for (map<unsigned int, vector<ShardStats> >::const_iterator run = runs.begin(); run != runs.end(); ++run)
+    {
+        ShardStats total;
+        total.startTime = run->second[0].startTime;
+        total.endTime = run->second[0].endTime;
 
-// Create a queue to store raw image filenames
-queue<string> raw_image_files;
+        cout << endl;
+        for (size_t i = 0; i < run->second.size(); i++)
+        {
+            const ShardStats& stats = run->second[i];
+            const double elapsed = stats.endTime > stats.startTime ? stats.endTime - stats.startTime : 1.0;
 
-// Number of raw image files to be processed in the current queue initialized to 0
-uint64_t total_files = 0;
+            cout << stats.shard << " on " << stats.host << ": " << stats.filesConverted << " converted, "
+                 << stats.filesFailed << " failed, " << stats.filesSkipped << " skipped, "
+                 << stats.filesConverted / elapsed << " files/sec" << endl;
 
-// Case-insenstive comparison of two characters
-inline bool caseInsCharCompareN(char a, char b)
-{
-    return(toupper(a) == toupper(b));
+            total.filesConverted += stats.filesConverted;
+            total.filesFailed += stats.filesFailed;
+            total.filesSkipped += stats.filesSkipped;
+            total.bytesRead += stats.bytesRead;
+            total.startTime = min(total.startTime, stats.startTime);
+            total.endTime = max(total.endTime, stats.endTime);
+        }
+
+        if (run->second.size() != run->first)
+        {
+            cout << "Warning: found " << run->second.size() << " of " << run->first << " shards" << endl;
+            result = -1;
+        }
+
+        const double span = total.endTime > total.startTime ? total.endTime - total.startTime : 1.0;
+        cout << "Total over " << run->first << " shards: " << total.filesConverted << " converted, "
+             << total.filesFailed << " failed, " << total.filesSkipped << " skipped in " << span << " s ("
+             << total.filesConverted / span << " files/sec, " << total.bytesRead / span / (1024.0 * 1024.0)
+             << " MB/s)" << endl;
+    }
+
+    return result;
 }
 
-// Case-insensitive comparison of two strings
-bool caseInsCompare(const string & s1, const string & s2)
+// Settings of the throughput benchmark
+struct ThroughputBenchmarkOptions
 {
-    return((s1.size() == s2.size()) &&
-        equal(s1.begin(), s1.end(), s2.begin(), caseInsCharCompareN));
-}
+    unsigned int numFiles;
+    unsigned int width;
+    unsigned int height;
+    string directory;
 
-// Check whether a string has a specified ending
-bool hasEnding(string const & fullString, string const & ending)
+    ThroughputBenchmarkOptions() : numFiles(BENCHMARK_FILES), width(WIDTH), height(HEIGHT), directory(BENCHMARK_DIR)
+    {
+    }
+};
+
+// Result of one conversion path in the throughput benchmark
+struct ThroughputResult
 {
-    if (fullString.length() >= ending.length())
+    string name;
+    unsigned int workers;
+    WorkerStats total;
+    double elapsedSeconds;
+    double cpuSeconds;
+};
+
+// User plus system CPU time consumed by the process so far
+double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creationTime;
+    FILETIME exitTime;
+    FILETIME kernelTime;
+    FILETIME userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
     {
-        string ext = fullString.substr(fullString.length() - ending.length(), ending.length());
-        return (caseInsCompare(ext, ending));
+        return 0.0;
     }
-    else
+
+    ULARGE_INTEGER kernel;
+    ULARGE_INTEGER user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+
+    // FILETIME counts 100 ns intervals
+    return (kernel.QuadPart + user.QuadPart) / 1e7;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
     {
-        return false;
+        return 0.0;
     }
+
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
 }
 
-// Replace a filename extension with a new extension
-void replaceExt(string & s, const string & newExt)
+// Create a directory unless it already exists
+bool makeDirectory(const string& path)
 {
-    string::size_type i = s.rfind('.', s.length());
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR))
+    {
+        return true;
+    }
 
-    if (i != string::npos)
+#if defined(_WIN32)
+    return _mkdir(path.c_str()) == 0;
+#else
+    return mkdir(path.c_str(), 0755) == 0;
+#endif
+}
+
+// Latency percentile in milliseconds, by nearest rank; sorts the samples
+double latencyPercentile(vector<double>& latencies, double percentile)
+{
+    if (latencies.empty())
     {
-        s.replace(i + 1, newExt.length(), newExt);
+        return 0.0;
     }
+
+    sort(latencies.begin(), latencies.end());
+    size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * latencies.size()));
+    rank = min(max<size_t>(rank, 1), latencies.size());
+    return 1000.0 * latencies[rank - 1];
 }
 
-// Get .raw files under the specified directory
-int getdir(string dir, queue<string> & files)
+// Write a synthetic BayerBG16 corpus and a directory geometry file describing it
+bool generateBenchmarkCorpus(const ThroughputBenchmarkOptions& benchOptions)
 {
-    DIR *dp;
-    struct dirent *dirp;
-    if ((dp = opendir(dir.c_str())) == NULL)
+    if (!makeDirectory(benchOptions.directory) || !makeDirectory(input_dir) || !makeDirectory(output_dir))
     {
-        cout << "Error(" << errno << ") opening " << dir << endl;
-        return errno;
+        cout << "Unable to create " << benchOptions.directory << endl;
+        return false;
     }
 
-    while ((dirp = readdir(dp)) != NULL)
+    ofstream geometryFile((input_dir + string("/") + DIRECTORY_GEOMETRY_FILE).c_str());
+    geometryFile << "width " << benchOptions.width << endl;
+    geometryFile << "height " << benchOptions.height << endl;
+    geometryFile << "pixel_format BayerBG16" << endl;
+    geometryFile.close();
+
+    // Content does not affect conversion speed, so a few frames are cycled
+    const size_t frameSize = static_cast<size_t>(benchOptions.width) * benchOptions.height;
+    vector<vector<uint16_t> > frames(min<unsigned int>(BENCHMARK_DISTINCT_FRAMES, benchOptions.numFiles));
+    for (size_t i = 0; i < frames.size(); i++)
     {
-        if (hasEnding(dirp->d_name, RAW_FILE_TYPE))
+        frames[i].resize(frameSize);
+        fillSyntheticBayer(&frames[i][0], benchOptions.width, benchOptions.height, static_cast<uint32_t>(i + 1));
+    }
+
+    cout << "Generating " << benchOptions.numFiles << " files of " << benchOptions.width << "x" << benchOptions.height
+         << " BayerBG16 in " << input_dir << "..." << endl;
+
+    for (unsigned int i = 0; i < benchOptions.numFiles; i++)
+    {
+        ostringstream fileName;
+        fileName << input_dir << "/bench_" << setfill('0') << setw(6) << i << ".raw";
+
+        FILE* outFile = fopen(fileName.str().c_str(), "wb");
+        const vector<uint16_t>& frame = frames[i % frames.size()];
+        if (outFile == NULL || fwrite(&frame[0], sizeof(uint16_t), frameSize, outFile) != frameSize)
         {
-            files.push(string(dirp->d_name));
+            cout << "Error writing " << fileName.str() << endl;
+            if (outFile != NULL)
+            {
+                fclose(outFile);
+            }
+            return false;
         }
+        fclose(outFile);
     }
-    closedir(dp);
-    return 0;
+
+    return true;
 }
 
-// Convert .raw images to the target pixel format and file type, and store them in the output directory
-void processImages()
+// Convert the whole benchmark corpus once with the given options
+ThroughputResult runThroughputCase(const string& name, const ConversionOptions& options)
 {
-    // Create an ImagePtr object to get the image data
-    ImagePtr tempImage = Image::Create();
-    tempImage->ResetImage(WIDTH, HEIGHT, X_OFFSET, Y_OFFSET, RAW_IMAGE_PIXEL_TYPE);
-    unsigned char *buffer = static_cast<unsigned char*>(tempImage->GetData());
-    FILE* inFile;
+    ThroughputResult result;
+    result.name = name;
+    result.workers = options.numWorkers;
+
+    cout << endl << "*** BENCHMARK: " << name << " (" << options.numWorkers << " worker(s)) ***" << endl;
+
+    raw_image_files.reopen();
+    total_files = 0;
+    files_started = 0;
+    getdir(input_dir + string("/"), raw_image_files);
+    raw_image_files.close();
+
+    const double cpuStart = processCpuSeconds();
+    result.total = options.pipelineFrames > 0 ? processImagesPipelined(options, result.elapsedSeconds)
+                                              : processImages(options, result.elapsedSeconds);
+    result.cpuSeconds = processCpuSeconds() - cpuStart;
+
+    return result;
+}
+
+// Format the benchmark results as JSON
+string throughputJson(
+    const ThroughputBenchmarkOptions& benchOptions,
+    const ConversionOptions& options,
+    vector<ThroughputResult>& results)
+{
+    const unsigned int hardwareThreads = max(1u, thread::hardware_concurrency());
+    const RawGeometry geometry = input_defaults;
+
+    ostringstream json;
+    json << fixed << setprecision(3);
+    json << "{" << endl;
+    json << "  \"files\": " << benchOptions.numFiles << "," << endl;
+    json << "  \"width\": " << benchOptions.width << "," << endl;
+    json << "  \"height\": " << benchOptions.height << "," << endl;
+    json << "  \"file_bytes\": " << geometry.imageSize() << "," << endl;
+    json << "  \"directory\": \"" << benchOptions.directory << "\"," << endl;
+    json << "  \"hardware_threads\": " << hardwareThreads << "," << endl;
+    json << "  \"demosaic\": \""
+         << (!options.nativeDemosaic && options.streamTiffBits == 0
+                 ? "sdk"
+                 : (options.demosaicParams.method == DEMOSAIC_EDGE_AWARE ? "edge" : "bilinear"))
+         << "\"," << endl;
+    json << "  \"stream_tiff_bits\": " << options.streamTiffBits << "," << endl;
+    json << "  \"runs\": [" << endl;
 
-    // Convert the .raw images one by one in the specified directory
-    while (!raw_image_files.empty())
+    for (size_t i = 0; i < results.size(); i++)
     {
-        string fileName;
-        cout << "\nFiles remaining: " << raw_image_files.size() - 1 << "/" << total_files;
-        fileName = raw_image_files.front();
-        raw_image_files.pop();
-        cout << "\t" << " converting file: " << fileName;
+        ThroughputResult& result = results[i];
+        const double elapsed = result.elapsedSeconds > 0.0 ? result.elapsedSeconds : 1.0;
 
-        // Filepath for the current .raw image file
-        string filepath = string(RAW_INPUT_DIR) + string("/") + fileName;
+        json << "    {\"name\": \"" << result.name << "\", \"workers\": " << result.workers
+             << ", \"files_converted\": " << result.total.filesConverted
+             << ", \"files_failed\": " << result.total.filesFailed << ", \"seconds\": " << result.elapsedSeconds
+             << ", \"files_per_sec\": " << result.total.filesConverted / elapsed
+             << ", \"mb_per_sec\": " << result.total.bytesRead / elapsed / (1024.0 * 1024.0)
+             << ", \"latency_p50_ms\": " << latencyPercentile(result.total.latencies, 50.0)
+             << ", \"latency_p99_ms\": " << latencyPercentile(result.total.latencies, 99.0)
+             << ", \"cpu_seconds\": " << result.cpuSeconds
+             << ", \"cpu_utilization\": " << result.cpuSeconds / (elapsed * hardwareThreads) << "}"
+             << (i + 1 < results.size() ? "," : "") << endl;
+    }
 
-        // Open the current .raw image
-        inFile = fopen(filepath.c_str(), "rb");
+    json << "  ]" << endl;
+    json << "}" << endl;
+    return json.str();
+}
 
-        if (inFile == NULL)
-        {
-            cout << "Error reading: " << filepath;
-            continue;
-        }
+//
+// Measure conversion throughput on a generated corpus
+//
+// *** NOTES ***
+// The same corpus is converted by a single worker, by the worker pool, by the
+// pool with memory-mapped input and by the pipeline, with the demosaic and
+// output options given on the command line. Files/sec and MB/s are over the
+// wall time of each run; latency is per file (from read to write, including
+// queueing, in the pipeline); CPU utilization is the process CPU time over
+// the wall time of all hardware threads. The results are printed and written
+// to benchmark.json in the benchmark directory.
+//
+int benchmarkThroughput(ConversionOptions options, const ThroughputBenchmarkOptions& benchOptions)
+{
+    input_dir = benchOptions.directory + string("/input");
+    output_dir = benchOptions.directory + string("/output");
 
-        // Read the current .raw image data in the specified format and store them in the buffer
-        fread(buffer, sizeof(unsigned char), HEIGHT * WIDTH * BYTE_DEPTH, inFile);
+    if (!generateBenchmarkCorpus(benchOptions) ||
+        !loadGeometryFile(input_dir + string("/") + DIRECTORY_GEOMETRY_FILE, input_defaults))
+    {
+        return -1;
+    }
 
-        fclose(inFile);
+    options.verbose = false;
+    options.watch = false;
+    options.pipelineFrames = 0;
 
-        // Create the new filename and path with the target file type extension
-        string newFilename = fileName;
-        replaceExt(newFilename, TARGET_FILE_TYPE);
-        string newFilepath = string(PROCESSED_OUTPUT_DIR) + string("/") + newFilename;
+    vector<ThroughputResult> results;
 
-        // Save the image to the target pixel format and file type
-        try
-        {
-            ImagePtr convertedImage = tempImage->Convert(TARGET_IMAGE_FORMAT, HQ_LINEAR);
-            convertedImage->Save(newFilepath.c_str());
-        }
-        catch (Spinnaker::Exception& e)
-        {
-            cout << "Error: " << e.what() << endl;
-        }
+    ConversionOptions single = options;
+    single.numWorkers = 1;
+    single.useMmap = false;
+    results.push_back(runThroughputCase("single", single));
+
+    ConversionOptions pooled = options;
+    pooled.useMmap = false;
+    results.push_back(runThroughputCase("pool", pooled));
+
+    ConversionOptions mapped = options;
+    mapped.useMmap = true;
+    results.push_back(runThroughputCase("pool_mmap", mapped));
+
+    // Streaming already overlaps I/O with demosaicing inside each worker
+    if (options.streamTiffBits == 0)
+    {
+        ConversionOptions pipelined = options;
+        pipelined.useMmap = false;
+        pipelined.pipelineFrames = 2 * options.numWorkers + 2;
+        results.push_back(runThroughputCase("pipeline", pipelined));
     }
+
+    const string json = throughputJson(benchOptions, options, results);
+    const string jsonPath = benchOptions.directory + string("/benchmark.json");
+
+    ofstream jsonFile(jsonPath.c_str());
+    jsonFile << json;
+    jsonFile.close();
+
+    cout << endl << "*** THROUGHPUT BENCHMARK ***" << endl << endl << json << endl;
+    cout << "Results written to " << jsonPath << endl;
+
+    return jsonFile ? 0 : -1;
+}
+
+// Print out usage of the application
+void PrintUsage()
+{
+    cout << "Usage: RawToProcessed [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "--threads <n>          : Number of conversion workers (0 = one per hardware thread, default "
+         << DEFAULT_NUM_WORKERS << ")." << endl;
+    cout << "--mmap                 : Map input files into memory instead of reading them into a buffer." << endl;
+    cout << "--pipeline <n>         : Read, convert and write in separate stages with n frames in flight;" << endl;
+    cout << "                         --threads sets the number of converter threads." << endl;
+    cout << "--watch                : Keep converting files as they are written to the input folder (Linux)." << endl;
+    cout << "--resume               : Skip files converted by an earlier run, tracked in " << output_dir
+         << "/" << MANIFEST_FILE_NAME << "." << endl;
+    cout << "--shard <i/N>          : Convert only shard i (0 to N-1) of the input, by filename hash." << endl;
+    cout << "--merge-stats          : Combine the statistics written by the shards of a run and exit." << endl;
+    cout << "--demosaic <method>    : sdk (default), or the in-tree bilinear or edge kernel." << endl;
+    cout << "--demosaic-path <path> : Force the in-tree kernel to use scalar, sse4.2 or avx2 code." << endl;
+    cout << "--wb <r,g,b>           : White balance gains applied by the in-tree kernel." << endl;
+    cout << "--stream-tiff <bits>   : Demosaic with the in-tree kernel and stream 8 or 16-bit TIFF strips" << endl;
+    cout << "                         to disk; cannot be combined with --pipeline." << endl;
+    cout << "--strip-rows <n>       : Rows per streamed TIFF strip (default " << TIFF_ROWS_PER_STRIP << ")." << endl;
+    cout << "--verify-demosaic      : Compare the in-tree kernel against the SDK and check SIMD bit-exactness." << endl;
+    cout << "--benchmark-demosaic   : Measure demosaic speed in megapixels/sec per core." << endl;
+    cout << "--benchmark-throughput : Generate a synthetic corpus and report the throughput of each conversion" << endl;
+    cout << "                         path as JSON; uses --threads, --demosaic and --stream-tiff." << endl;
+    cout << "--bench-files <n>      : Number of files in the benchmark corpus (default " << BENCHMARK_FILES << ")." << endl;
+    cout << "--bench-size <WxH>     : Geometry of the benchmark corpus (default " << WIDTH << "x" << HEIGHT << ")." << endl;
+    cout << "--bench-dir <dir>      : Where the benchmark corpus is generated (default " << BENCHMARK_DIR << ")." << endl;
+    cout << "--help                 : Print usage information." << endl;
+    cout << endl;
 }
 
 // Example entry point; please see Enumeration example for more in-depth
 // comments on preparing and cleaning up the system.
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
-    int result = 0;
+    // Change arguments to string for easy read
+    vector<string> args(argv, argv + argc);
+
+    ConversionOptions options;
+    bool mergeStats = false;
+    bool verify = false;
+    bool benchmark = false;
+    bool throughputBenchmark = false;
+    bool threadsGiven = false;
+    ThroughputBenchmarkOptions benchOptions;
+
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        if (args[i] == "--threads" && i + 1 < args.size())
+        {
+            options.numWorkers = static_cast<unsigned int>(strtoul(args[++i].c_str(), NULL, 10));
+            threadsGiven = true;
+        }
+        else if (args[i] == "--mmap")
+        {
+            options.useMmap = true;
+        }
+        else if (args[i] == "--pipeline" && i + 1 < args.size())
+        {
+            options.pipelineFrames = static_cast<unsigned int>(strtoul(args[++i].c_str(), NULL, 10));
+        }
+        else if (args[i] == "--watch")
+        {
+#ifdef __linux__
+            options.watch = true;
+#else
+            cout << "Watch mode is only supported on Linux." << endl;
+            return -1;
+#endif
+        }
+        else if (args[i] == "--resume")
+        {
+            options.resume = true;
+        }
+        else if (args[i] == "--shard" && i + 1 < args.size())
+        {
+            if (sscanf(args[++i].c_str(), "%u/%u", &input_shard.index, &input_shard.count) != 2 ||
+                input_shard.count == 0 || input_shard.index >= input_shard.count)
+            {
+                cout << "Invalid shard " << args[i] << "; expected i/N with 0 <= i < N." << endl;
+                return -1;
+            }
+        }
+        else if (args[i] == "--merge-stats")
+        {
+            mergeStats = true;
+        }
+        else if (args[i] == "--stream-tiff" && i + 1 < args.size())
+        {
+            options.streamTiffBits = static_cast<unsigned int>(strtoul(args[++i].c_str(), NULL, 10));
+            if (options.streamTiffBits != 8 && options.streamTiffBits != 16)
+            {
+                cout << "Invalid TIFF bit depth " << args[i] << "; expected 8 or 16." << endl;
+                return -1;
+            }
+        }
+        else if (args[i] == "--strip-rows" && i + 1 < args.size())
+        {
+            options.rowsPerStrip = max(1u, static_cast<unsigned int>(strtoul(args[++i].c_str(), NULL, 10)));
+        }
+        else if (args[i] == "--demosaic" && i + 1 < args.size())
+        {
+            const string method = args[++i];
+            options.nativeDemosaic = method != "sdk";
+            options.demosaicParams.method = method == "edge" ? DEMOSAIC_EDGE_AWARE : DEMOSAIC_BILINEAR;
+        }
+        else if (args[i] == "--demosaic-path" && i + 1 < args.size())
+        {
+            const string path = args[++i];
+            options.demosaicPath = path == "avx2" ? DEMOSAIC_PATH_AVX2
+                                                  : (path == "sse4.2" ? DEMOSAIC_PATH_SSE42 : DEMOSAIC_PATH_SCALAR);
+            if (!DemosaicPathSupported(options.demosaicPath))
+            {
+                cout << "Demosaic path " << path << " is not supported on this CPU." << endl;
+                return -1;
+            }
+        }
+        else if (args[i] == "--wb" && i + 1 < args.size())
+        {
+            float gains[3];
+            if (sscanf(args[++i].c_str(), "%f,%f,%f", &gains[2], &gains[1], &gains[0]) != 3)
+            {
+                PrintUsage();
+                return -1;
+            }
+
+            // Gains are stored blue, green, red in 8.8 fixed point
+            for (int c = 0; c < 3; c++)
+            {
+                options.demosaicParams.gains[c] =
+                    static_cast<uint16_t>(min(65535.0f, max(0.0f, gains[c] * 256.0f + 0.5f)));
+            }
+        }
+        else if (args[i] == "--verify-demosaic")
+        {
+            verify = true;
+        }
+        else if (args[i] == "--benchmark-demosaic")
+        {
+            benchmark = true;
+        }
+        else if (args[i] == "--benchmark-throughput")
+        {
+            throughputBenchmark = true;
+        }
+        else if (args[i] == "--bench-files" && i + 1 < args.size())
+        {
+            benchOptions.numFiles = max(1u, static_cast<unsigned int>(strtoul(args[++i].c_str(), NULL, 10)));
+        }
+        else if (args[i] == "--bench-size" && i + 1 < args.size())
+        {
+            if (sscanf(args[++i].c_str(), "%ux%u", &benchOptions.width, &benchOptions.height) != 2 ||
+                benchOptions.width < 2 || benchOptions.height < 2 || (benchOptions.width & 1) != 0 ||
+                (benchOptions.height & 1) != 0)
+            {
+                cout << "Invalid benchmark size " << args[i] << "; expected even WxH, e.g. 2448x2048." << endl;
+                return -1;
+            }
+        }
+        else if (args[i] == "--bench-dir" && i + 1 < args.size())
+        {
+            benchOptions.directory = args[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return args[i] == "--help" ? 0 : -1;
+        }
+    }
+
+    // The benchmark's pool runs one worker per hardware thread unless told
+    // otherwise, so that it differs from the single worker
+    if (throughputBenchmark && !threadsGiven)
+    {
+        options.numWorkers = 0;
+    }
+
+    if (options.numWorkers == 0)
+    {
+        options.numWorkers = max(1u, thread::hardware_concurrency());
+    }
+
+    // The in-tree kernel only produces 8-bit BGR/RGB; files other than
+    // BayerBG16 fall back to the SDK conversion
+    if ((options.nativeDemosaic || verify || benchmark) &&
+        TARGET_IMAGE_FORMAT != PixelFormat_BGR8 && TARGET_IMAGE_FORMAT != PixelFormat_RGB8)
+    {
+        cout << "The in-tree demosaic requires BGR8 or RGB8 output." << endl;
+        return -1;
+    }
+
+    // Streaming fuses reading, demosaicing and writing in each worker, and
+    // writes TIFF regardless of the SDK output format
+    if (options.streamTiffBits != 0 && options.pipelineFrames > 0)
+    {
+        cout << "--stream-tiff cannot be combined with --pipeline." << endl;
+        return -1;
+    }
+
+    if (options.streamTiffBits != 0 &&
+        !caseInsCompare(TARGET_FILE_TYPE, "Tiff") && !caseInsCompare(TARGET_FILE_TYPE, "Tif"))
+    {
+        cout << "--stream-tiff requires TARGET_FILE_TYPE to be Tiff." << endl;
+        return -1;
+    }
+
+    if (benchmark)
+    {
+        benchmarkDemosaic(options);
+        return 0;
+    }
+
+    if (mergeStats)
+    {
+        return mergeShardStats();
+    }
+
+    if (throughputBenchmark)
+    {
+        return benchmarkThroughput(options, benchOptions);
+    }
+
     // Since this application saves images in the current folder
     // we must ensure that we have permission to write to this folder.
     // If we do not have permission, fail right away.
@@ -208,23 +3077,23 @@ int main(int /*argc*/, char** /*argv*/)
     cout << "Application build date: " << __DATE__ << " " << __TIME__ << endl << endl;
 
     struct stat info;
-    stat(PROCESSED_OUTPUT_DIR, &info);
+    stat(output_dir.c_str(), &info);
 
     // Create an output folder if it does not exit
     if (info.st_mode & S_IFDIR)
     {
-        cout << "Output directory exists:  " << PROCESSED_OUTPUT_DIR << endl;
+        cout << "Output directory exists:  " << output_dir << endl;
     }
     else
     {
-        cout << "Creating output directory: " << PROCESSED_OUTPUT_DIR << endl;
+        cout << "Creating output directory: " << output_dir << endl;
 
         int nError = 0;
 #if defined(_WIN32)
-        nError = _mkdir(PROCESSED_OUTPUT_DIR); // can be used on Windows
+        nError = _mkdir(output_dir.c_str()); // can be used on Windows
 #else
         mode_t nMode = 0733; // UNIX style permissions
-        nError = mkdir(PROCESSED_OUTPUT_DIR, nMode); // can be used on non-Windows
+        nError = mkdir(output_dir.c_str(), nMode); // can be used on non-Windows
 #endif
         if (nError != 0)
         {
@@ -237,16 +3106,124 @@ int main(int /*argc*/, char** /*argv*/)
     }
 
     // Directory for the .raw files
-    string dir = string(RAW_INPUT_DIR) + string("/");
+    string dir = input_dir + string("/");
+
+#ifdef __linux__
+    //
+    // Start watching the input directory before it is listed
+    //
+    // *** NOTES ***
+    // Files closed after writing, or moved into the directory, are reported
+    // by inotify. Watching before the initial listing means no file can slip
+    // in between the two; a file caught by both is simply converted twice.
+    //
+    int inotifyFd = -1;
+    if (options.watch)
+    {
+        inotifyFd = inotify_init1(IN_CLOEXEC);
+        if (inotifyFd < 0 || inotify_add_watch(inotifyFd, input_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            cout << "Error(" << errno << ") watching " << input_dir << endl;
+            return -1;
+        }
+
+        signal(SIGINT, requestStop);
+        signal(SIGTERM, requestStop);
+
+        cout << "Watching " << input_dir << " for new files. Press Ctrl+C to stop." << endl;
+    }
+#endif
+
+    // Load the results of earlier runs
+    if (options.resume)
+    {
+        // Shards running at the same time keep separate journals
+        string manifestPath = output_dir + string("/") + string(MANIFEST_FILE_NAME);
+        if (input_shard.isSharded())
+        {
+            replaceExt(manifestPath, input_shard.suffix() + ".txt");
+        }
+        if (!conversion_manifest.open(manifestPath))
+        {
+            cout << "Unable to open manifest " << manifestPath << endl;
+            return -1;
+        }
+        cout << "Manifest lists " << conversion_manifest.completedCount() << " converted files" << endl;
+    }
+
+    // Geometry shared by the files of the input directory, if given
+    if (loadGeometryFile(dir + DIRECTORY_GEOMETRY_FILE, input_defaults))
+    {
+        cout << "Default geometry from " << DIRECTORY_GEOMETRY_FILE << ": " << input_defaults.name() << endl;
+    }
 
     // Get .raw files under the specified directory
     getdir(dir, raw_image_files);
 
-    // Total number of .raw images to be processed
-    total_files = raw_image_files.size();
+    if (skipped_files > 0)
+    {
+        cout << "Skipping " << skipped_files << " files already converted" << endl;
+    }
+
+    const map<RawGeometry, uint64_t> geometries = input_geometries.counts();
+    for (map<RawGeometry, uint64_t>::const_iterator it = geometries.begin(); it != geometries.end(); ++it)
+    {
+        cout << "Found " << it->second << " file(s) of geometry " << it->first.name() << endl;
+    }
+
+    // Verification only looks at the files that are already there
+    if (verify)
+    {
+        raw_image_files.close();
+        return verifyDemosaic(options);
+    }
+
+#ifdef __linux__
+    // In watch mode, new files are queued by the watcher until it is stopped
+    thread watcherThread;
+    if (options.watch)
+    {
+        watcherThread = thread(watchInputDirectory, inotifyFd);
+    }
+    else
+#endif
+    {
+        // No more files will be added, so workers exit once the queue is drained
+        raw_image_files.close();
+    }
+
+    if (input_shard.isSharded())
+    {
+        cout << "Converting shard " << input_shard.index << " of " << input_shard.count << endl;
+    }
 
     // Convert images
-    processImages();
+    ShardStats shardStats;
+    shardStats.startTime = wallClockSeconds();
+
+    double elapsedSeconds = 0.0;
+    WorkerStats total = options.pipelineFrames > 0 ? processImagesPipelined(options, elapsedSeconds)
+                                                   : processImages(options, elapsedSeconds);
+
+    // Leave this shard's statistics for --merge-stats
+    if (input_shard.isSharded())
+    {
+        shardStats.shard = input_shard.suffix();
+        shardStats.host = hostName();
+        shardStats.filesConverted = total.filesConverted;
+        shardStats.filesFailed = total.filesFailed;
+        shardStats.filesSkipped = skipped_files;
+        shardStats.bytesRead = total.bytesRead;
+        shardStats.endTime = wallClockSeconds();
+        writeShardStats(shardStats);
+    }
+
+#ifdef __linux__
+    if (watcherThread.joinable())
+    {
+        watcherThread.join();
+    }
+#endif
 
     cout << endl << endl << "Done! Press Enter to exit..." << endl;
     getchar();
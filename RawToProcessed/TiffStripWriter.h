@@ -0,0 +1,235 @@
+//=============================================================================
+// Copyright (c) 2001-2020 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+/**
+ *  @brief TiffStripWriter.h is a minimal streaming writer for uncompressed
+ *  RGB TIFF files, used by the RawToProcessed example.
+ *
+ *  The size of every strip is known up front, so the header, the image file
+ *  directory and the strip tables are all written when the file is opened.
+ *  Strips are then appended in order as they are produced and never need to
+ *  be held in memory together. The full file size is reserved on disk when
+ *  the file is opened, so a full disk is reported before any pixels are
+ *  written and the file is laid out in as few extents as possible.
+ */
+
+#ifndef TIFF_STRIP_WRITER_H
+#define TIFF_STRIP_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#endif
+
+class TiffStripWriter
+{
+  public:
+    TiffStripWriter()
+        : m_file(NULL), m_stripSize(0), m_lastStripSize(0), m_numStrips(0), m_stripsWritten(0), m_failed(false)
+    {
+    }
+
+    ~TiffStripWriter()
+    {
+        close();
+    }
+
+    //
+    // Create the file and write everything but the pixel data
+    //
+    // *** NOTES ***
+    // The image has three samples (R, G, B) of 8 or 16 bits per pixel and is
+    // stored in strips of rowsPerStrip rows; the last strip may be shorter.
+    // Samples are little-endian.
+    //
+    bool open(const char* path, uint32_t width, uint32_t height, unsigned int bitsPerSample, uint32_t rowsPerStrip)
+    {
+        close();
+
+        if (width == 0 || height == 0 || rowsPerStrip == 0 || (bitsPerSample != 8 && bitsPerSample != 16))
+        {
+            return false;
+        }
+
+        const uint64_t rowSize = static_cast<uint64_t>(width) * 3 * (bitsPerSample / 8);
+        m_numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+        m_stripSize = static_cast<size_t>(rowSize * rowsPerStrip);
+        m_lastStripSize = static_cast<size_t>(rowSize * (height - (m_numStrips - 1) * rowsPerStrip));
+        m_stripsWritten = 0;
+        m_failed = false;
+
+        // Header, then the directory, then its out-of-line values, then the strips
+        const uint32_t numEntries = 10;
+        const uint32_t directoryOffset = 8;
+        const uint32_t bitsOffset = directoryOffset + 2 + numEntries * 12 + 4;
+        const uint32_t stripOffsetsOffset = bitsOffset + 3 * 2;
+        const uint32_t stripSizesOffset = stripOffsetsOffset + 4 * m_numStrips;
+        const uint32_t dataOffset = (stripSizesOffset + 4 * m_numStrips + 15) & ~15u;
+
+        const uint64_t fileSize = dataOffset + rowSize * height;
+        if (fileSize > 0xFFFFFFFFull)
+        {
+            // Classic TIFF offsets are 32-bit
+            return false;
+        }
+
+        std::vector<uint8_t> header(dataOffset, 0);
+        uint8_t* p = &header[0];
+
+        p[0] = 'I';
+        p[1] = 'I';
+        put16(p + 2, 42);
+        put32(p + 4, directoryOffset);
+
+        uint8_t* entry = p + directoryOffset;
+        put16(entry, static_cast<uint16_t>(numEntries));
+        entry += 2;
+
+        // Entries must be sorted by tag
+        entry = putEntry(entry, 256, 4, 1, width);                              // ImageWidth
+        entry = putEntry(entry, 257, 4, 1, height);                             // ImageLength
+        entry = putEntry(entry, 258, 3, 3, bitsOffset);                         // BitsPerSample
+        entry = putEntry(entry, 259, 3, 1, 1);                                  // Compression: none
+        entry = putEntry(entry, 262, 3, 1, 2);                                  // PhotometricInterpretation: RGB
+        entry = putEntry(entry, 273, 4, m_numStrips,                            // StripOffsets
+                         m_numStrips == 1 ? dataOffset : stripOffsetsOffset);
+        entry = putEntry(entry, 277, 3, 1, 3);                                  // SamplesPerPixel
+        entry = putEntry(entry, 278, 4, 1, rowsPerStrip);                       // RowsPerStrip
+        entry = putEntry(entry, 279, 4, m_numStrips,                            // StripByteCounts
+                         m_numStrips == 1 ? static_cast<uint32_t>(m_lastStripSize) : stripSizesOffset);
+        entry = putEntry(entry, 284, 3, 1, 1);                                  // PlanarConfiguration: chunky
+        put32(entry, 0);                                                        // No further directories
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            put16(p + bitsOffset + 2 * i, static_cast<uint16_t>(bitsPerSample));
+        }
+
+        for (uint32_t i = 0; i < m_numStrips; i++)
+        {
+            put32(p + stripOffsetsOffset + 4 * i, static_cast<uint32_t>(dataOffset + i * m_stripSize));
+            put32(
+                p + stripSizesOffset + 4 * i,
+                static_cast<uint32_t>(i + 1 == m_numStrips ? m_lastStripSize : m_stripSize));
+        }
+
+        m_file = fopen(path, "wb");
+        if (m_file == NULL)
+        {
+            return false;
+        }
+
+        if (!reserve(fileSize) || fwrite(p, 1, header.size(), m_file) != header.size())
+        {
+            m_failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    // Append the next strip; size must be that of a full strip, except for
+    // the last one
+    bool writeStrip(const void* data, size_t size)
+    {
+        if (m_file == NULL || m_failed || m_stripsWritten == m_numStrips ||
+            size != (m_stripsWritten + 1 == m_numStrips ? m_lastStripSize : m_stripSize) ||
+            fwrite(data, 1, size, m_file) != size)
+        {
+            m_failed = true;
+            return false;
+        }
+
+        m_stripsWritten++;
+        return true;
+    }
+
+    // Close the file; returns false if a write failed or strips are missing
+    bool close()
+    {
+        if (m_file == NULL)
+        {
+            return false;
+        }
+
+        const bool result = fclose(m_file) == 0 && !m_failed && m_stripsWritten == m_numStrips;
+        m_file = NULL;
+        return result;
+    }
+
+  private:
+    static void put16(uint8_t* p, uint16_t value)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void put32(uint8_t* p, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            p[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    // Write a 12-byte directory entry. A single SHORT value is stored in the
+    // first two bytes of the value field; anything else is a LONG or an offset.
+    static uint8_t* putEntry(uint8_t* p, uint16_t tag, uint16_t type, uint32_t count, uint32_t value)
+    {
+        put16(p, tag);
+        put16(p + 2, type);
+        put32(p + 4, count);
+        if (type == 3 && count == 1)
+        {
+            put16(p + 8, static_cast<uint16_t>(value));
+            put16(p + 10, 0);
+        }
+        else
+        {
+            put32(p + 8, value);
+        }
+        return p + 12;
+    }
+
+    // Allocate the whole file up front. Only a full disk is an error; file
+    // systems without preallocation support simply grow the file as it is
+    // written.
+    bool reserve(uint64_t fileSize)
+    {
+#if defined(__linux__)
+        const int result = posix_fallocate(fileno(m_file), 0, static_cast<off_t>(fileSize));
+        return result != ENOSPC && result != EFBIG;
+#else
+        (void)fileSize;
+        return true;
+#endif
+    }
+
+    FILE* m_file;
+    size_t m_stripSize;
+    size_t m_lastStripSize;
+    uint32_t m_numStrips;
+    uint32_t m_stripsWritten;
+    bool m_failed;
+};
+
+#endif // TIFF_STRIP_WRITER_H
@@ -17,14 +17,26 @@
 
 #include "Spinnaker.h"
 #include "SpinGenApi/SpinnakerGenApi.h"
+#include "AsyncLog.h"
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace Spinnaker;
 using namespace Spinnaker::GenApi;
 using namespace Spinnaker::GenICam;
 using namespace std;
 
+// Configure all cameras at once rather than one after another
+const bool k_configureInParallel = true;
+
+// How long each configuration step took on each camera, in milliseconds
+vector<string> configurationSteps;
+vector<vector<double>> configurationTimes;
+
 // This helper function allows the example to sleep in both Windows and Linux
 // systems. Note that Windows sleep takes milliseconds as a parameter while
 // Linux systems take microseconds as a parameter.
@@ -146,162 +158,326 @@ int ConfigureInterface(const InterfaceList& interfaceList)
     return result;
 }
 
-// This function configures IEEE 1588 settings on each camera
-// It enables IEEE 1588
-int ConfigureIEEE1588(const CameraList& camList)
+// Signature of one configuration step of one camera. Messages go to out and
+// a negative result aborts the example.
+typedef int (*ConfigureCameraStep)(const CameraPtr& pCam, unsigned int i, ostream& out);
+
+// Body of the thread that runs a step on one camera
+void RunCameraStep(
+    ConfigureCameraStep step,
+    const CameraPtr& pCam,
+    unsigned int i,
+    ostringstream& out,
+    int& result,
+    double& milliseconds)
 {
-    int result = 0;
-    CameraPtr pCam = nullptr;
-
-    cout << endl << endl << "*** CONFIGURING IEEE 1588 ***" << endl << endl;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
     try
     {
-        // Enable IEEE 1588 settings for each camera
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
+        result = step(pCam, i, out);
+    }
+    catch (Spinnaker::Exception& e)
+    {
+        out << "Error: " << e.what() << endl;
+        result = -1;
+    }
+
+    milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+//
+// Run one configuration step on every camera and record how long it took on
+// each of them
+//
+// *** NOTES ***
+// Every node access is a round trip to the camera, so with many cameras
+// configuring them one after another makes up most of the startup time.
+// Each camera runs the step on its own thread instead; the step then takes
+// about as long as on the slowest camera. Messages are held back until all
+// cameras are done and printed in camera order.
+//
+int ConfigureEachCamera(const CameraList& camList, const string& stepName, ConfigureCameraStep step)
+{
+    const unsigned int numCameras = camList.GetSize();
+
+    vector<ostringstream> out(numCameras);
+    vector<int> results(numCameras, 0);
+    vector<double> milliseconds(numCameras, 0.0);
+
+    if (k_configureInParallel)
+    {
+        vector<std::thread> threads;
+        for (unsigned int i = 0; i < numCameras; i++)
         {
-            // Select camera
-            pCam = camList.GetByIndex(i);
+            threads.push_back(std::thread(
+                RunCameraStep,
+                step,
+                camList.GetByIndex(i),
+                i,
+                std::ref(out[i]),
+                std::ref(results[i]),
+                std::ref(milliseconds[i])));
+        }
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            threads[i].join();
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < numCameras; i++)
+        {
+            RunCameraStep(step, camList.GetByIndex(i), i, out[i], results[i], milliseconds[i]);
+        }
+    }
 
-            // Enable IEEE 1588 settings
-            CBooleanPtr ptrIEEE1588 = pCam->GetNodeMap().GetNode("GevIEEE1588");
-            if (!IsAvailable(ptrIEEE1588) || !IsWritable(ptrIEEE1588))
-            {
-                cout << "Camera " << i << " Unable to enable IEEE 1588 (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    configurationSteps.push_back(stepName);
+    configurationTimes.resize(numCameras);
 
-            // Enable IEEE 1588
-            ptrIEEE1588->SetValue(true);
-            cout << "Camera " << i << " IEEE 1588 is enabled." << endl;
+    int result = 0;
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        cout << out[i].str();
+        configurationTimes[i].push_back(milliseconds[i]);
+        if (results[i] < 0)
+        {
+            result = -1;
         }
+    }
+    return result;
+}
 
-        // Requires delay for at least 6 seconds to enable 1588 settings
+// This function prints how long each configuration step took on each camera
+void PrintConfigurationTimes(double totalMilliseconds)
+{
+    cout << endl << endl << "*** CONFIGURATION TIMES (ms) ***" << endl << endl;
 
-        cout << "Waiting for 10 seconds " << endl;
-        SleepyWrapper(10000);
+    cout << fixed << setprecision(1);
+    for (unsigned int i = 0; i < configurationTimes.size(); i++)
+    {
+        double cameraMilliseconds = 0.0;
 
-        // Check if IEEE 1588 settings is enabled for each camera
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
+        cout << "Camera " << i << ":";
+        for (unsigned int step = 0; step < configurationTimes[i].size(); step++)
         {
-            // Select camera
-            pCam = camList.GetByIndex(i);
-            CCommandPtr ptrGevIEEE1588DataSetLatch = pCam->GetNodeMap().GetNode("GevIEEE1588DataSetLatch");
-            if (!IsAvailable(ptrGevIEEE1588DataSetLatch))
-            {
-                cout << "Camera " << i << " Unable to execute IEEE 1588 data set latch (node retrieval). Aborting..."
-                    << endl;
-                return -1;
-            }
-            ptrGevIEEE1588DataSetLatch->Execute();
+            cout << " " << configurationSteps[step] << " " << configurationTimes[i][step] << ",";
+            cameraMilliseconds += configurationTimes[i][step];
+        }
+        cout << " total " << cameraMilliseconds << endl;
+    }
+    cout << "Configuration took " << totalMilliseconds << " ms" << endl;
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
 
-            // Check if 1588 status is not in intialization
-            CEnumerationPtr ptrGevIEEE1588StatusLatched = pCam->GetNodeMap().GetNode("GevIEEE1588StatusLatched");
-            if (!IsAvailable(ptrGevIEEE1588StatusLatched) || !IsReadable(ptrGevIEEE1588StatusLatched))
-            {
-                cout << "Camera " << i << " Unable to read IEEE1588 status (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+// This function initializes a camera
+int InitializeCamera(const CameraPtr& pCam, unsigned int /*i*/, ostream& /*out*/)
+{
+    pCam->Init();
+    return 0;
+}
 
-            CEnumEntryPtr ptrGevIEEE1588StatusLatchedInitializing =
-                ptrGevIEEE1588StatusLatched->GetEntryByName("Initializing");
-            if (!IsAvailable(ptrGevIEEE1588StatusLatchedInitializing) ||
-                !IsReadable(ptrGevIEEE1588StatusLatchedInitializing))
-            {
-                cout << "Camera " << i << " Unable to get IEEE1588 status (enum entry retrieval). Aborting..." << endl;
-                return -1;
-            }
+// This function enables IEEE 1588 on a camera
+int EnableIEEE1588(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    // Enable IEEE 1588 settings
+    CBooleanPtr ptrIEEE1588 = pCam->GetNodeMap().GetNode("GevIEEE1588");
+    if (!IsAvailable(ptrIEEE1588) || !IsWritable(ptrIEEE1588))
+    {
+        out << "Camera " << i << " Unable to enable IEEE 1588 (node retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            if (ptrGevIEEE1588StatusLatched->GetIntValue() == ptrGevIEEE1588StatusLatchedInitializing->GetValue())
-            {
-                cout << "Camera" << i << " is in Initializing mode.." << endl;
-                return -1;
-            }
+    // Enable IEEE 1588
+    ptrIEEE1588->SetValue(true);
+    out << "Camera " << i << " IEEE 1588 is enabled." << endl;
+    return 0;
+}
 
-            // Check if camera(s) is(are) synchronized to master camera
-            // Verify if camera offset from master is larger than 1000ns which means camera(s) is(are) not synchronized
-            CIntegerPtr ptrGevIEEE1588OffsetFromMasterLatched =
-                pCam->GetNodeMap().GetNode("GevIEEE1588OffsetFromMasterLatched");
-            if (!IsAvailable(ptrGevIEEE1588OffsetFromMasterLatched) ||
-                !IsReadable(ptrGevIEEE1588OffsetFromMasterLatched))
-            {
-                cout << "Camera " << i << " Unable to read IEEE1588 offset (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+// This function checks that a camera is synchronized to the master clock
+int CheckIEEE1588(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    CCommandPtr ptrGevIEEE1588DataSetLatch = pCam->GetNodeMap().GetNode("GevIEEE1588DataSetLatch");
+    if (!IsAvailable(ptrGevIEEE1588DataSetLatch))
+    {
+        out << "Camera " << i << " Unable to execute IEEE 1588 data set latch (node retrieval). Aborting..." << endl;
+        return -1;
+    }
+    ptrGevIEEE1588DataSetLatch->Execute();
 
-            if (ptrGevIEEE1588OffsetFromMasterLatched->GetValue() > 1000)
-            {
-                cout << "Camera " << i << " has offset higher than 1000ns. Camera(s) is(are) not synchronized" << endl;
-                return -1;
-            }
-        }
+    // Check if 1588 status is not in intialization
+    CEnumerationPtr ptrGevIEEE1588StatusLatched = pCam->GetNodeMap().GetNode("GevIEEE1588StatusLatched");
+    if (!IsAvailable(ptrGevIEEE1588StatusLatched) || !IsReadable(ptrGevIEEE1588StatusLatched))
+    {
+        out << "Camera " << i << " Unable to read IEEE1588 status (node retrieval). Aborting..." << endl;
+        return -1;
     }
-    catch (Spinnaker::Exception& e)
+
+    CEnumEntryPtr ptrGevIEEE1588StatusLatchedInitializing =
+        ptrGevIEEE1588StatusLatched->GetEntryByName("Initializing");
+    if (!IsAvailable(ptrGevIEEE1588StatusLatchedInitializing) || !IsReadable(ptrGevIEEE1588StatusLatchedInitializing))
     {
-        cout << "Error: " << e.what() << endl;
-        result = -1;
+        out << "Camera " << i << " Unable to get IEEE1588 status (enum entry retrieval). Aborting..." << endl;
+        return -1;
     }
-    return result;
+
+    if (ptrGevIEEE1588StatusLatched->GetIntValue() == ptrGevIEEE1588StatusLatchedInitializing->GetValue())
+    {
+        out << "Camera" << i << " is in Initializing mode.." << endl;
+        return -1;
+    }
+
+    // Check if camera(s) is(are) synchronized to master camera
+    // Verify if camera offset from master is larger than 1000ns which means camera(s) is(are) not synchronized
+    CIntegerPtr ptrGevIEEE1588OffsetFromMasterLatched =
+        pCam->GetNodeMap().GetNode("GevIEEE1588OffsetFromMasterLatched");
+    if (!IsAvailable(ptrGevIEEE1588OffsetFromMasterLatched) || !IsReadable(ptrGevIEEE1588OffsetFromMasterLatched))
+    {
+        out << "Camera " << i << " Unable to read IEEE1588 offset (node retrieval). Aborting..." << endl;
+        return -1;
+    }
+
+    if (ptrGevIEEE1588OffsetFromMasterLatched->GetValue() > 1000)
+    {
+        out << "Camera " << i << " has offset higher than 1000ns. Camera(s) is(are) not synchronized" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// This function configures IEEE 1588 settings on each camera
+// It enables IEEE 1588
+int ConfigureIEEE1588(const CameraList& camList)
+{
+    int result = 0;
+
+    cout << endl << endl << "*** CONFIGURING IEEE 1588 ***" << endl << endl;
+
+    // Enable IEEE 1588 settings for each camera
+    result = ConfigureEachCamera(camList, "IEEE 1588", EnableIEEE1588);
+    if (result < 0)
+    {
+        return result;
+    }
+
+    // Requires delay for at least 6 seconds to enable 1588 settings; this is
+    // needed once for all cameras
+
+    cout << "Waiting for 10 seconds " << endl;
+    SleepyWrapper(10000);
+
+    // Check if IEEE 1588 settings is enabled for each camera
+    return ConfigureEachCamera(camList, "IEEE 1588 check", CheckIEEE1588);
+}
+
+// This function sets the action device key, group key and group mask of a
+// camera
+int ConfigureCameraActionControl(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    // Apply action group setting
+    CIntegerPtr ptrActionDeviceKey = pCam->GetNodeMap().GetNode("ActionDeviceKey");
+    if (!IsAvailable(ptrActionDeviceKey) || !IsWritable(ptrActionDeviceKey))
+    {
+        out << "Camera " << i << " Unable to set Action Device Key (node retrieval). Aborting..." << endl;
+        return -1;
+    }
+
+    // Set action device key to 0
+    ptrActionDeviceKey->SetValue(0);
+    out << "Camera " << i << " action device key is set" << endl;
+
+    CIntegerPtr ptrActionGroupKey = pCam->GetNodeMap().GetNode("ActionGroupKey");
+    if (!IsAvailable(ptrActionGroupKey) || !IsWritable(ptrActionGroupKey))
+    {
+        out << "Camera " << i << " Unable to set Action Group Key (node retrieval). Aborting..." << endl;
+        return -1;
+    }
+
+    // Set action group key to 1
+    ptrActionGroupKey->SetValue(1);
+    out << "Camera " << i << " action group key is set" << endl;
+
+    CIntegerPtr ptrActionGroupMask = pCam->GetNodeMap().GetNode("ActionGroupMask");
+    if (!IsAvailable(ptrActionGroupMask) || !IsWritable(ptrActionGroupMask))
+    {
+        out << "Camera " << i << " Unable to retrieve Action Group Mask (node retrieval). Aborting...e" << endl;
+        return -1;
+    }
+
+    // Set action group mask to 1
+    ptrActionGroupMask->SetValue(1);
+    out << "Camera " << i << " action group mask is set" << endl;
+    return 0;
 }
 
 // This function configures action control settings
 // For each camera, it sets action device key, group key and group mask.
 int ConfigureActionControl(const CameraList& camList)
 {
-    int result = 0;
-    CameraPtr pCam = nullptr;
-
     cout << endl << endl << "*** CONFIGURING ACTION CONTROL ***" << endl << endl;
 
-    try
+    return ConfigureEachCamera(camList, "action control", ConfigureCameraActionControl);
+}
+
+// This function sets the frame rate and exposure of a camera
+int ConfigureCameraOtherNodes(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    // Frame rate setting
+    // Turn on frame rate control
+    CBooleanPtr ptrFrameRateEnable = pCam->GetNodeMap().GetNode("AcquisitionFrameRateEnable");
+    if (!IsAvailable(ptrFrameRateEnable) || !IsWritable(ptrFrameRateEnable))
     {
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
-        {
-            // Select camera
-            pCam = camList.GetByIndex(i);
+        out << "Camera " << i << " Unable to enable Acquisition Frame Rate (node retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            // Apply action group setting
-            CIntegerPtr ptrActionDeviceKey = pCam->GetNodeMap().GetNode("ActionDeviceKey");
-            if (!IsAvailable(ptrActionDeviceKey) || !IsWritable(ptrActionDeviceKey))
-            {
-                cout << "Camera " << i << " Unable to set Action Device Key (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    // Enable  Acquisition Frame Rate Enable
+    ptrFrameRateEnable->SetValue(true);
 
-            // Set action device key to 0
-            ptrActionDeviceKey->SetValue(0);
-            cout << "Camera " << i << " action device key is set" << endl;
+    CFloatPtr ptrFrameRate = pCam->GetNodeMap().GetNode("AcquisitionFrameRate");
+    if (!IsAvailable(ptrFrameRate) || !IsWritable(ptrFrameRate))
+    {
+        out << "Camera " << i << " Unable to set Acquisition Frame Rate (node retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            CIntegerPtr ptrActionGroupKey = pCam->GetNodeMap().GetNode("ActionGroupKey");
-            if (!IsAvailable(ptrActionGroupKey) || !IsWritable(ptrActionGroupKey))
-            {
-                cout << "Camera " << i << " Unable to set Action Group Key (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    // Set 10fps for this example
+    const float frameRate = 10.0f;
+    ptrFrameRate->SetValue(frameRate);
+    out << "Camera " << i << " Frame rate is set to " << frameRate << endl;
 
-            // Set action group key to 1
-            ptrActionGroupKey->SetValue(1);
-            cout << "Camera " << i << " action group key is set" << endl;
+    // Turn off exposure auto.
+    CEnumerationPtr ptrExposureAuto = pCam->GetNodeMap().GetNode("ExposureAuto");
+    if (!IsAvailable(ptrExposureAuto) || !IsWritable(ptrExposureAuto))
+    {
+        out << "Camera " << i << " Unable to disable Exposure Auto (node retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            CIntegerPtr ptrActionGroupMask = pCam->GetNodeMap().GetNode("ActionGroupMask");
-            if (!IsAvailable(ptrActionGroupMask) || !IsWritable(ptrActionGroupMask))
-            {
-                cout << "Camera " << i << " Unable to retrieve Action Group Mask (node retrieval). Aborting...e"
-                    << endl;
-                return -1;
-            }
+    CEnumEntryPtr ptrExposureAutoOff = ptrExposureAuto->GetEntryByName("Off");
+    if (!IsAvailable(ptrExposureAutoOff) || !IsReadable(ptrExposureAutoOff))
+    {
+        out << "Camera " << i << " Unable to set Exposure Auto (enum entry retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            // Set action group mask to 1
-            ptrActionGroupMask->SetValue(1);
-            cout << "Camera " << i << " action group mask is set" << endl;
-        }
+    // Turn off Exposure Auto
+    ptrExposureAuto->SetIntValue(ptrExposureAutoOff->GetValue());
+
+    CFloatPtr ptrExposureTime = pCam->GetNodeMap().GetNode("ExposureTime");
+    if (IsAvailable(ptrExposureTime) && IsWritable(ptrExposureTime))
+    {
+        // Set exposure time to 1000 for this example
+        const float exposureTime = 1000.0f;
+        ptrExposureTime->SetValue(exposureTime);
+        out << "Camera " << i << " Exposure time is set to " << exposureTime << endl;
     }
-    catch (Spinnaker::Exception& e)
+    else
     {
-        cout << "Error: " << e.what() << endl;
-        result = -1;
+        out << "Camera " << i << " Unable to set Exposure Time (node retrieval). Aborting..." << endl;
     }
-    return result;
+    return 0;
 }
 
 // This function configures other nodes for frame synchronization.
@@ -309,166 +485,157 @@ int ConfigureActionControl(const CameraList& camList)
 // acquisition Timing and image timestamp
 int ConfigureOtherNodes(const CameraList& camList)
 {
-    int result = 0;
-    CameraPtr pCam = nullptr;
-
     cout << endl << endl << "*** CONFIGURING OTHER NODES ***" << endl << endl;
 
-    try
-    {
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
-        {
-            // Select camera
-            pCam = camList.GetByIndex(i);
+    return ConfigureEachCamera(camList, "other nodes", ConfigureCameraOtherNodes);
+}
 
-            // Frame rate setting
-            // Turn on frame rate control
-            CBooleanPtr ptrFrameRateEnable = pCam->GetNodeMap().GetNode("AcquisitionFrameRateEnable");
-            if (!IsAvailable(ptrFrameRateEnable) || !IsWritable(ptrFrameRateEnable))
-            {
-                cout << "Camera " << i << " Unable to enable Acquisition Frame Rate (node retrieval). Aborting..."
-                    << endl;
-                return -1;
-            }
+// This function enables the timestamp chunk on a camera
+int ConfigureCameraChunkData(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    //
+    // Activate chunk mode
+    //
+    // *** NOTES ***
+    // Once enabled, chunk data will be available at the end of the payload
+    // of every image captured until it is disabled. Chunk data can also be
+    // retrieved from the nodemap.
+    //
+
+    CBooleanPtr ptrChunkModeActive = pCam->GetNodeMap().GetNode("ChunkModeActive");
+    if (!IsAvailable(ptrChunkModeActive) || !IsWritable(ptrChunkModeActive))
+    {
+        out << "Camera " << i << " Unable to activate chunk mode. Aborting..." << endl << endl;
+        return -1;
+    }
 
-            // Enable  Acquisition Frame Rate Enable
-            ptrFrameRateEnable->SetValue(true);
+    ptrChunkModeActive->SetValue(true);
 
-            CFloatPtr ptrFrameRate = pCam->GetNodeMap().GetNode("AcquisitionFrameRate");
-            if (!IsAvailable(ptrFrameRate) || !IsWritable(ptrFrameRate))
-            {
-                cout << "Camera " << i << " Unable to set Acquisition Frame Rate (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    out << "Camera " << i << " Chunk mode activated..." << endl;
 
-            // Set 10fps for this example
-            const float frameRate = 10.0f;
-            ptrFrameRate->SetValue(frameRate);
-            cout << "Camera " << i << " Frame rate is set to " << frameRate << endl;
+    CEnumerationPtr ptrChunkSelector = pCam->GetNodeMap().GetNode("ChunkSelector");
+    if (!IsAvailable(ptrChunkSelector) || !IsWritable(ptrChunkSelector))
+    {
+        out << "Camera " << i << " Chunk Selector is not writable" << endl;
+        return -1;
+    }
 
-            // Turn off exposure auto.
-            CEnumerationPtr ptrExposureAuto = pCam->GetNodeMap().GetNode("ExposureAuto");
-            if (!IsAvailable(ptrExposureAuto) || !IsWritable(ptrExposureAuto))
-            {
-                cout << "Camera " << i << " Unable to disable Exposure Auto (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    // Select Timestamp for Chunk data
+    CEnumEntryPtr ptrChunkSelectorTimestamp = ptrChunkSelector->GetEntryByName("Timestamp");
+    if (!IsAvailable(ptrChunkSelectorTimestamp) || !IsReadable(ptrChunkSelectorTimestamp))
+    {
+        out << "Camera " << i << " Unable to set Chunk Selector (node retrieval). Aborting..." << endl;
+        return -1;
+    }
 
-            CEnumEntryPtr ptrExposureAutoOff = ptrExposureAuto->GetEntryByName("Off");
-            if (!IsAvailable(ptrExposureAutoOff) || !IsReadable(ptrExposureAutoOff))
-            {
-                cout << "Camera " << i << " Unable to set Exposure Auto (enum entry retrieval). Aborting..." << endl;
-                return -1;
-            }
+    ptrChunkSelector->SetIntValue(ptrChunkSelectorTimestamp->GetValue());
 
-            // Turn off Exposure Auto
-            ptrExposureAuto->SetIntValue(ptrExposureAutoOff->GetValue());
+    // Retrieve corresponding boolean
+    CBooleanPtr ptrChunkEnable = pCam->GetNodeMap().GetNode("ChunkEnable");
 
-            CFloatPtr ptrExposureTime = pCam->GetNodeMap().GetNode("ExposureTime");
-            if (IsAvailable(ptrExposureTime) && IsWritable(ptrExposureTime))
-            {
-                // Set exposure time to 1000 for this example
-                const float exposureTime = 1000.0f;
-                ptrExposureTime->SetValue(exposureTime);
-                cout << "Camera " << i << " Exposure time is set to " << exposureTime << endl;
-            }
-            else
-            {
-                cout << "Camera " << i << " Unable to set Exposure Time (node retrieval). Aborting..." << endl;
-            }
-        }
+    // Enable the boolean, thus enabling the corresponding chunk data
+    if (!IsAvailable(ptrChunkEnable))
+    {
+        out << "Camera " << i << " not available" << endl;
+        return -1;
     }
-    catch (Spinnaker::Exception& e)
+    else if (ptrChunkEnable->GetValue())
     {
-        cout << "Error: " << e.what() << endl;
-        result = -1;
+        out << "Camera " << i << " enabled" << endl;
     }
-    return result;
+    else if (IsWritable(ptrChunkEnable))
+    {
+        ptrChunkEnable->SetValue(true);
+        out << "Camera " << i << " enabled" << endl;
+    }
+    else
+    {
+        out << "Camera " << i << " not writable" << endl;
+        return -1;
+    }
+    return 0;
 }
 
 // This function configures chunk data settings
 int ConfigureChunkData(const CameraList& camList)
 {
-    int result = 0;
-    CameraPtr pCam = nullptr;
-
     cout << endl << endl << "*** CONFIGURING CHUNK DATA ***" << endl << endl;
 
-    try
-    {
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
-        {
-            // Select camera
-            pCam = camList.GetByIndex(i);
-
-            //
-            // Activate chunk mode
-            //
-            // *** NOTES ***
-            // Once enabled, chunk data will be available at the end of the payload
-            // of every image captured until it is disabled. Chunk data can also be
-            // retrieved from the nodemap.
-            //
-
-            CBooleanPtr ptrChunkModeActive = pCam->GetNodeMap().GetNode("ChunkModeActive");
-            if (!IsAvailable(ptrChunkModeActive) || !IsWritable(ptrChunkModeActive))
-            {
-                cout << "Camera " << i << " Unable to activate chunk mode. Aborting..." << endl << endl;
-                return -1;
-            }
+    return ConfigureEachCamera(camList, "chunk data", ConfigureCameraChunkData);
+}
 
-            ptrChunkModeActive->SetValue(true);
+// This function sets the acquisition mode, throughput limit, packet size and
+// packet delay of a camera
+int ConfigureCameraStream(const CameraPtr& pCam, unsigned int i, ostream& out)
+{
+    // Set acquisition mode to continuous
+    CEnumerationPtr ptrAcquisitionMode = pCam->GetNodeMap().GetNode("AcquisitionMode");
+    if (!IsAvailable(ptrAcquisitionMode) || !IsWritable(ptrAcquisitionMode))
+    {
+        out << "Unable to set acquisition mode to continuous (node retrieval; camera " << i << "). Aborting..." << endl
+            << endl;
+        return -1;
+    }
 
-            cout << "Camera " << i << " Chunk mode activated..." << endl;
+    CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
+    if (!IsAvailable(ptrAcquisitionModeContinuous) || !IsReadable(ptrAcquisitionModeContinuous))
+    {
+        out << "Unable to set acquisition mode to continuous (entry 'continuous' retrieval " << i << "). Aborting..."
+            << endl
+            << endl;
+        return -1;
+    }
 
-            CEnumerationPtr ptrChunkSelector = pCam->GetNodeMap().GetNode("ChunkSelector");
-            if (!IsAvailable(ptrChunkSelector) || !IsWritable(ptrChunkSelector))
-            {
-                cout << "Camera " << i << " Chunk Selector is not writable" << endl;
-                return -1;
-            }
+    const int64_t acquisitionModeContinuous = ptrAcquisitionModeContinuous->GetValue();
 
-            // Select Timestamp for Chunk data
-            CEnumEntryPtr ptrChunkSelectorTimestamp = ptrChunkSelector->GetEntryByName("Timestamp");
-            if (!IsAvailable(ptrChunkSelectorTimestamp) || !IsReadable(ptrChunkSelectorTimestamp))
-            {
-                cout << "Camera " << i << " Unable to set Chunk Selector (node retrieval). Aborting..." << endl;
-                return -1;
-            }
+    ptrAcquisitionMode->SetIntValue(acquisitionModeContinuous);
 
-            ptrChunkSelector->SetIntValue(ptrChunkSelectorTimestamp->GetValue());
+    out << "Camera " << i << " acquisition mode set to continuous..." << endl;
 
-            // Retrieve corresponding boolean
-            CBooleanPtr ptrChunkEnable = pCam->GetNodeMap().GetNode("ChunkEnable");
+    // Device Link Throughput Limit setting
+    CIntegerPtr ptrDeviceLinkThroughputLimit = pCam->GetNodeMap().GetNode("DeviceLinkThroughputLimit");
+    if (!IsAvailable(ptrDeviceLinkThroughputLimit) || !IsWritable(ptrDeviceLinkThroughputLimit))
+    {
+        out << "Unable to set device link throughput limit (node retrieval; camera " << i << "). Aborting..." << endl
+            << endl;
+        return -1;
+    }
+    // Set throughput close to the maximum limit 125000000
+    const int64_t deviceLinkThroughputLimit = 100000000;
+    ptrDeviceLinkThroughputLimit->SetValue(deviceLinkThroughputLimit);
 
-            // Enable the boolean, thus enabling the corresponding chunk data
-            if (!IsAvailable(ptrChunkEnable))
-            {
-                cout << "Camera " << i << " not available" << endl;
-                result = -1;
-            }
-            else if (ptrChunkEnable->GetValue())
-            {
-                cout << "Camera " << i << " enabled" << endl;
-            }
-            else if (IsWritable(ptrChunkEnable))
-            {
-                ptrChunkEnable->SetValue(true);
-                cout << "Camera " << i << " enabled" << endl;
-            }
-            else
-            {
-                cout << "Camera " << i << " not writable" << endl;
-                result = -1;
-            }
-        }
+    // Packet size, Packet delay setting
+    CIntegerPtr ptrPacketSize = pCam->GetNodeMap().GetNode("GevSCPSPacketSize");
+    if (!IsAvailable(ptrPacketSize) || !IsWritable(ptrPacketSize))
+    {
+        out << "Unable to set packet size (node retrieval; camera " << i << "). Aborting..." << endl << endl;
+        return -1;
     }
-    catch (Spinnaker::Exception& e)
+    // Set packet size to maximum value
+    const int64_t packetSize = 9000;
+    ptrPacketSize->SetValue(packetSize);
+
+    CIntegerPtr ptrPacketDelay = pCam->GetNodeMap().GetNode("GevSCPD");
+    if (!IsAvailable(ptrPacketDelay) || !IsWritable(ptrPacketDelay))
     {
-        cout << "Error: " << e.what() << endl;
-        result = -1;
+        out << "Unable to set packet delay (node retrieval; camera " << i << "). Aborting..." << endl << endl;
+        return -1;
     }
-    return result;
+
+    // Set packet delay 9000 by using formula packet delay x 8
+    // for BFS only, there is 8 bit internal tick
+    // for Gen 2 cameras , just use packet delay 9000
+    const int64_t packetDelay = 72000;
+    ptrPacketDelay->SetValue(packetDelay);
+    return 0;
+}
+
+// This function configures the stream settings of each camera
+int ConfigureStreams(const CameraList& camList)
+{
+    cout << endl << endl << "*** CONFIGURING STREAMS ***" << endl << endl;
+
+    return ConfigureEachCamera(camList, "stream", ConfigureCameraStream);
 }
 
 int AcquireImages(const SystemPtr& system, const InterfaceList& interfaceList, CameraList camList)
@@ -501,67 +668,7 @@ int AcquireImages(const SystemPtr& system, const InterfaceList& interfaceList, C
             // Select camera
             pCam = camList.GetByIndex(i);
 
-            // Set acquisition mode to continuous
-            CEnumerationPtr ptrAcquisitionMode = pCam->GetNodeMap().GetNode("AcquisitionMode");
-            if (!IsAvailable(ptrAcquisitionMode) || !IsWritable(ptrAcquisitionMode))
-            {
-                cout << "Unable to set acquisition mode to continuous (node retrieval; camera " << i << "). Aborting..."
-                    << endl
-                    << endl;
-                return -1;
-            }
-
-            CEnumEntryPtr ptrAcquisitionModeContinuous = ptrAcquisitionMode->GetEntryByName("Continuous");
-            if (!IsAvailable(ptrAcquisitionModeContinuous) || !IsReadable(ptrAcquisitionModeContinuous))
-            {
-                cout << "Unable to set acquisition mode to continuous (entry 'continuous' retrieval " << i
-                    << "). Aborting..." << endl
-                    << endl;
-                return -1;
-            }
-
-            const int64_t acquisitionModeContinuous = ptrAcquisitionModeContinuous->GetValue();
-
-            ptrAcquisitionMode->SetIntValue(acquisitionModeContinuous);
-
-            cout << "Camera " << i << " acquisition mode set to continuous..." << endl;
-
-            // Device Link Throughput Limit setting
-            CIntegerPtr ptrDeviceLinkThroughputLimit = pCam->GetNodeMap().GetNode("DeviceLinkThroughputLimit");
-            if (!IsAvailable(ptrDeviceLinkThroughputLimit) || !IsWritable(ptrDeviceLinkThroughputLimit))
-            {
-                cout << "Unable to set device link throughput limit (node retrieval; camera " << i << "). Aborting..."
-                    << endl
-                    << endl;
-                return -1;
-            }
-            // Set throughput close to the maximum limit 125000000
-            const int64_t deviceLinkThroughputLimit = 100000000;
-            ptrDeviceLinkThroughputLimit->SetValue(deviceLinkThroughputLimit);
-
-            // Packet size, Packet delay setting
-            CIntegerPtr ptrPacketSize = pCam->GetNodeMap().GetNode("GevSCPSPacketSize");
-            if (!IsAvailable(ptrPacketSize) || !IsWritable(ptrPacketSize))
-            {
-                cout << "Unable to set packet size (node retrieval; camera " << i << "). Aborting..." << endl << endl;
-                return -1;
-            }
-            // Set packet size to maximum value
-            const int64_t packetSize = 9000;
-            ptrPacketSize->SetValue(packetSize);
-
-            CIntegerPtr ptrPacketDelay = pCam->GetNodeMap().GetNode("GevSCPD");
-            if (!IsAvailable(ptrPacketDelay) || !IsWritable(ptrPacketDelay))
-            {
-                cout << "Unable to set packet delay (node retrieval; camera " << i << "). Aborting..." << endl << endl;
-                return -1;
-            }
-
-            // Set packet delay 9000 by using formula packet delay x 8
-            // for BFS only, there is 8 bit internal tick
-            // for Gen 2 cameras , just use packet delay 9000
-            const int64_t packetDelay = 72000;
-            ptrPacketDelay->SetValue(packetDelay);
+            // The stream settings were applied to every camera by ConfigureStreams()
 
             // Begin acquiring images
             pCam->BeginAcquisition();
@@ -597,6 +704,9 @@ int AcquireImages(const SystemPtr& system, const InterfaceList& interfaceList, C
             // through the cameras; otherwise, all images will be grabbed from a
             // single camera before grabbing any images from another.
             //
+            // The timestamps are printed through the asynchronous log (see
+            // AsyncLog.h), so printing them does not delay the next image.
+            //
             const unsigned int k_numImages = 10;
             for (unsigned int imageCnt = 0; imageCnt < k_numImages; imageCnt++)
             {
@@ -612,14 +722,14 @@ int AcquireImages(const SystemPtr& system, const InterfaceList& interfaceList, C
 
                         if (pResultImage->IsIncomplete())
                         {
-                            cout << "Image incomplete with image status " << pResultImage->GetImageStatus() << "..."
-                                << endl
-                                << endl;
+                            ASYNC_LOG(ASYNC_LOG_WARNING,
+                                      "Image incomplete with image status " << pResultImage->GetImageStatus() << "...");
+                            ASYNC_LOG(ASYNC_LOG_WARNING, "");
                         }
                         else
                         {
                             // Print image information
-                            cout << "Camera " << index << " grabbed image " << imageCnt << endl;
+                            ASYNC_LOG(ASYNC_LOG_DEBUG, "Camera " << index << " grabbed image " << imageCnt);
                         }
 
                         // Get timestamp
@@ -627,16 +737,16 @@ int AcquireImages(const SystemPtr& system, const InterfaceList& interfaceList, C
 
                         // Retrieve timestamp
                         const int64_t timestamp = chunkData.GetTimestamp();
-                        cout << "\tTimestamp: " << timestamp << endl;
+                        ASYNC_LOG(ASYNC_LOG_INFO, "\tTimestamp: " << timestamp);
 
                         // Release image
                         pResultImage->Release();
 
-                        cout << endl;
+                        ASYNC_LOG(ASYNC_LOG_INFO, "");
                     }
                     catch (Spinnaker::Exception& e)
                     {
-                        cout << "Error: " << e.what() << endl;
+                        ASYNC_LOG(ASYNC_LOG_ERROR, "Error: " << e.what());
                         result = -1;
                     }
                 }
@@ -707,22 +817,22 @@ int RunMultipleCameras(const SystemPtr& system, const InterfaceList& interfaceLi
         // Initialize each camera
         //
         // *** NOTES ***
-        // You may notice that the steps in this function have more loops with
-        // less steps per loop; this contrasts the AcquireImages() function
-        // which has less loops but more steps per loop. This is done for
-        // demonstrative purposes as both work equally well.
+        // Every configuration step, initialization included, runs on all
+        // cameras at once (see ConfigureEachCamera()), and the time each step
+        // took on each camera is printed once they are configured.
         //
         // *** LATER ***
         // Each camera needs to be deinitialized once all images have been
         // acquired.
         //
-        for (unsigned int i = 0; i < camList.GetSize(); i++)
-        {
-            // Select camera
-            pCam = camList.GetByIndex(i);
+        cout << endl << endl << "*** INITIALIZING CAMERAS ***" << endl << endl;
+
+        const chrono::steady_clock::time_point configurationStart = chrono::steady_clock::now();
 
-            // Initialize camera
-            pCam->Init();
+        result = ConfigureEachCamera(camList, "init", InitializeCamera);
+        if (result < 0)
+        {
+            return result;
         }
 
         // Configure Interface Settings
@@ -760,8 +870,21 @@ int RunMultipleCameras(const SystemPtr& system, const InterfaceList& interfaceLi
             return result;
         }
 
+        // Configure acquisition mode, packet size and the other stream settings
+        result = ConfigureStreams(camList);
+        if (result < 0)
+        {
+            return result;
+        }
+
+        PrintConfigurationTimes(
+            chrono::duration<double, milli>(chrono::steady_clock::now() - configurationStart).count());
+
         // Acquire images on all cameras
+        // Print the messages of the acquisition loop in the background
+        AsyncLog::start();
         result = AcquireImages(system, interfaceList, camList);
+        AsyncLog::stop();
         if (result < 0)
         {
             return result;